@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include <cpp_buffer/buffer.h>
+
+#include <numeric>
+
+using namespace CPPBuffer;
+
+// Summing through Buffer::operator[], which checks every index
+static void BM_SumChecked(benchmark::State &state) {
+    Buffer<int> buffer(static_cast<size_t>(state.range(0)));
+    std::iota(buffer.begin(), buffer.end(), 0);
+    for(auto _ : state) {
+        long total = 0;
+        for(int i = 0; i < static_cast<int>(buffer.size()); ++i)
+            total += buffer[i];
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_SumChecked)->Arg(64)->Arg(4096);
+
+// The same through a CheckedView, which checked the range once
+static void BM_SumCheckedView(benchmark::State &state) {
+    Buffer<int> buffer(static_cast<size_t>(state.range(0)));
+    std::iota(buffer.begin(), buffer.end(), 0);
+    for(auto _ : state) {
+        auto window = buffer.checked(0, buffer.size());
+        long total = 0;
+        for(size_t i = 0; i < window.size(); ++i)
+            total += window[i];
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_SumCheckedView)->Arg(64)->Arg(4096);
+
+// And through a bare pointer, which is the floor for the two above
+static void BM_SumRawPointer(benchmark::State &state) {
+    Buffer<int> buffer(static_cast<size_t>(state.range(0)));
+    std::iota(buffer.begin(), buffer.end(), 0);
+    for(auto _ : state) {
+        const int *p = buffer.begin();
+        long total = 0;
+        for(size_t i = 0; i < buffer.size(); ++i)
+            total += p[i];
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_SumRawPointer)->Arg(64)->Arg(4096);
+
+// Random reads, where the check can't be hoisted out of the loop and has to be nearly free on its own
+static void BM_GatherChecked(benchmark::State &state) {
+    Buffer<int> buffer(4096);
+    Buffer<int> indices(1024);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    for(size_t i = 0; i < indices.size(); ++i)
+        indices[int(i)] = static_cast<int>((i * 2654435761u) % buffer.size());
+    for(auto _ : state) {
+        long total = 0;
+        for(int index : indices)
+            total += buffer[index];
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_GatherChecked);
+
+static void BM_GatherRawPointer(benchmark::State &state) {
+    Buffer<int> buffer(4096);
+    Buffer<int> indices(1024);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    for(size_t i = 0; i < indices.size(); ++i)
+        indices[int(i)] = static_cast<int>((i * 2654435761u) % buffer.size());
+    for(auto _ : state) {
+        const int *p = buffer.begin();
+        long total = 0;
+        for(int index : indices)
+            total += p[index];
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_GatherRawPointer);
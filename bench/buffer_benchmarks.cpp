@@ -0,0 +1,302 @@
+#include <benchmark/benchmark.h>
+#include <cpp_buffer/algorithms.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/expressions.h>
+
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+#include <span>
+#define CPPBUFFER_BENCH_SPAN 1
+#else
+#define CPPBUFFER_BENCH_SPAN 0
+#endif
+
+using namespace CPPBuffer;
+
+// Construction: Buffer against the containers it usually replaces
+static void BM_ConstructBuffer(benchmark::State &state) {
+    for(auto _ : state) {
+        Buffer<float> buffer(static_cast<size_t>(state.range(0)));
+        benchmark::DoNotOptimize(buffer.begin());
+    }
+}
+BENCHMARK(BM_ConstructBuffer)->Range(16, 1 << 16);
+
+static void BM_ConstructUninitializedBuffer(benchmark::State &state) {
+    for(auto _ : state) {
+        Buffer<float> buffer(static_cast<size_t>(state.range(0)), uninitialized);
+        benchmark::DoNotOptimize(buffer.begin());
+    }
+}
+BENCHMARK(BM_ConstructUninitializedBuffer)->Range(16, 1 << 16);
+
+static void BM_ConstructVector(benchmark::State &state) {
+    for(auto _ : state) {
+        std::vector<float> vector(static_cast<size_t>(state.range(0)));
+        benchmark::DoNotOptimize(vector.data());
+    }
+}
+BENCHMARK(BM_ConstructVector)->Range(16, 1 << 16);
+
+static void BM_ConstructUniqueArray(benchmark::State &state) {
+    for(auto _ : state) {
+        std::unique_ptr<float[]> array(new float[static_cast<size_t>(state.range(0))]());
+        benchmark::DoNotOptimize(array.get());
+    }
+}
+BENCHMARK(BM_ConstructUniqueArray)->Range(16, 1 << 16);
+
+
+// Copies: a Buffer copy shares its elements, a vector copy duplicates them
+static void BM_CopyBuffer(benchmark::State &state) {
+    Buffer<float> buffer(static_cast<size_t>(state.range(0)));
+    for(auto _ : state) {
+        Buffer<float> copy(buffer);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK(BM_CopyBuffer)->Range(16, 1 << 16);
+
+static void BM_CopyVector(benchmark::State &state) {
+    std::vector<float> vector(static_cast<size_t>(state.range(0)));
+    for(auto _ : state) {
+        std::vector<float> copy(vector);
+        benchmark::DoNotOptimize(copy.data());
+    }
+}
+BENCHMARK(BM_CopyVector)->Range(16, 1 << 16);
+
+static void BM_MoveBuffer(benchmark::State &state) {
+    Buffer<float> a(64), b;
+    for(auto _ : state) {
+        b = std::move(a);
+        a = std::move(b);
+        benchmark::DoNotOptimize(a);
+    }
+}
+BENCHMARK(BM_MoveBuffer);
+
+static void BM_MoveVector(benchmark::State &state) {
+    std::vector<float> a(64), b;
+    for(auto _ : state) {
+        b = std::move(a);
+        a = std::move(b);
+        benchmark::DoNotOptimize(a.data());
+    }
+}
+BENCHMARK(BM_MoveVector);
+
+// Passing a Buffer by value to a call that can't be inlined costs a reference count round trip, a view doesn't
+__attribute__((noinline)) static float first_by_value(Buffer<float> buffer) { return buffer[0]; }
+__attribute__((noinline)) static float first_by_view(BufferView<const float> view) { return view[0]; }
+
+static void BM_PassBufferByValue(benchmark::State &state) {
+    Buffer<float> buffer(64);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(first_by_value(buffer));
+}
+BENCHMARK(BM_PassBufferByValue);
+
+static void BM_PassBufferView(benchmark::State &state) {
+    Buffer<float> buffer(64);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(first_by_view(buffer));
+}
+BENCHMARK(BM_PassBufferView);
+
+
+// Iterating a Slice<float, s> against the same strided loop over a bare pointer. Each pass visits the same number of
+// elements, so the numbers are comparable across strides.
+template< uint8_t s >
+static void BM_IterateSlice(benchmark::State &state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Buffer<float> buffer(n * s);
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+    auto slice = buffer.slice<s>();
+    for(auto _ : state) {
+        float total = 0.0f;
+        for(float f : slice)
+            total += f;
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK_TEMPLATE(BM_IterateSlice, 1)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateSlice, 2)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateSlice, 3)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateSlice, 4)->Arg(1 << 10)->Arg(1 << 16);
+
+template< size_t s >
+static void BM_IterateRawPointer(benchmark::State &state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    std::unique_ptr<float[]> memory(new float[n * s]);
+    std::iota(memory.get(), memory.get() + n * s, 0.0f);
+    for(auto _ : state) {
+        const float *p = memory.get();
+        float total = 0.0f;
+        for(size_t i = 0; i < n; ++i)
+            total += p[i * s];
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * n));
+}
+BENCHMARK_TEMPLATE(BM_IterateRawPointer, 1)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateRawPointer, 2)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateRawPointer, 3)->Arg(1 << 10)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateRawPointer, 4)->Arg(1 << 10)->Arg(1 << 16);
+
+
+// Reductions: std::accumulate over a Buffer and over a bare pointer, against the lane-parallel kernels of algorithms.h
+static void BM_AccumulateBuffer(benchmark::State &state) {
+    Buffer<float> buffer(static_cast<size_t>(state.range(0)));
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::accumulate(buffer.begin(), buffer.end(), 0.0f));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_of(buffer)));
+}
+BENCHMARK(BM_AccumulateBuffer)->Range(64, 1 << 20);
+
+static void BM_AccumulateRawPointer(benchmark::State &state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    std::unique_ptr<float[]> memory(new float[n]);
+    std::iota(memory.get(), memory.get() + n, 0.0f);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::accumulate(memory.get(), memory.get() + n, 0.0f));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * n * sizeof(float)));
+}
+BENCHMARK(BM_AccumulateRawPointer)->Range(64, 1 << 20);
+
+static void BM_SumBuffer(benchmark::State &state) {
+    Buffer<float> buffer(static_cast<size_t>(state.range(0)));
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(buffer));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_of(buffer)));
+}
+BENCHMARK(BM_SumBuffer)->Range(64, 1 << 20);
+
+static void BM_InnerProductBuffer(benchmark::State &state) {
+    Buffer<float> x(static_cast<size_t>(state.range(0))), y(static_cast<size_t>(state.range(0)));
+    std::iota(x.begin(), x.end(), 0.0f);
+    std::iota(y.begin(), y.end(), 1.0f);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::inner_product(x.begin(), x.end(), y.begin(), 0.0f));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 2 * size_of(x)));
+}
+BENCHMARK(BM_InnerProductBuffer)->Range(64, 1 << 20);
+
+static void BM_DotBuffer(benchmark::State &state) {
+    Buffer<float> x(static_cast<size_t>(state.range(0))), y(static_cast<size_t>(state.range(0)));
+    std::iota(x.begin(), x.end(), 0.0f);
+    std::iota(y.begin(), y.end(), 1.0f);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(dot(x, y));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 2 * size_of(x)));
+}
+BENCHMARK(BM_DotBuffer)->Range(64, 1 << 20);
+
+static void BM_DotStridedSlice(benchmark::State &state) {
+    Buffer<float> interleaved(2 * static_cast<size_t>(state.range(0)));
+    std::iota(interleaved.begin(), interleaved.end(), 0.0f);
+    auto left = interleaved.slice<2>();
+    auto right = interleaved.slice<2>(1, interleaved.size());
+    for(auto _ : state)
+        benchmark::DoNotOptimize(dot(left, right));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_of(interleaved)));
+}
+BENCHMARK(BM_DotStridedSlice)->Range(64, 1 << 20);
+
+// runtime strides: small ones go through the compile-time kernels, wide ones through the prefetching loop, which the
+// iterator loop below is the baseline for
+static void BM_SumDynamicSlice(benchmark::State &state) {
+    const size_t stride = static_cast<size_t>(state.range(0));
+    Buffer<float> buffer(16u << 20);
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+    auto view = buffer.slice(0, buffer.size(), stride);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(sum(view));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_of(view)));
+}
+BENCHMARK(BM_SumDynamicSlice)->Arg(2)->Arg(4)->Arg(16)->Arg(64)->Arg(1000);
+
+static void BM_AccumulateDynamicSlice(benchmark::State &state) {
+    const size_t stride = static_cast<size_t>(state.range(0));
+    Buffer<float> buffer(16u << 20);
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+    auto view = buffer.slice(0, buffer.size(), stride);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::accumulate(view.begin(), view.end(), 0.0f));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_of(view)));
+}
+BENCHMARK(BM_AccumulateDynamicSlice)->Arg(2)->Arg(4)->Arg(16)->Arg(64)->Arg(1000);
+
+// out = a * gain + b * (1 - gain): one temporary Buffer per operation, against one fused expression
+static void BM_MixWithTemporaries(benchmark::State &state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Buffer<float> a(n), b(n), out(n);
+    const float gain = 0.25f;
+    for(auto _ : state) {
+        Buffer<float> scaledA(n, uninitialized), scaledB(n, uninitialized);
+        for(size_t i = 0; i < n; ++i)
+            scaledA.begin()[i] = a.begin()[i] * gain;
+        for(size_t i = 0; i < n; ++i)
+            scaledB.begin()[i] = b.begin()[i] * (1.0f - gain);
+        for(size_t i = 0; i < n; ++i)
+            out.begin()[i] = scaledA.begin()[i] + scaledB.begin()[i];
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 3 * size_of(out)));
+}
+BENCHMARK(BM_MixWithTemporaries)->Range(1 << 10, 1 << 22);
+
+static void BM_MixExpression(benchmark::State &state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    Buffer<float> a(n), b(n), out(n);
+    const float gain = 0.25f;
+    for(auto _ : state) {
+        out = a * gain + b * (1.0f - gain);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 3 * size_of(out)));
+}
+BENCHMARK(BM_MixExpression)->Range(1 << 10, 1 << 22);
+
+#if CPPBUFFER_BENCH_SPAN
+static void BM_AccumulateSpan(benchmark::State &state) {
+    std::vector<float> vector(static_cast<size_t>(state.range(0)));
+    std::iota(vector.begin(), vector.end(), 0.0f);
+    std::span<const float> span(vector);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::accumulate(span.begin(), span.end(), 0.0f));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * span.size_bytes()));
+}
+BENCHMARK(BM_AccumulateSpan)->Range(64, 1 << 20);
+
+static void BM_InnerProductSpan(benchmark::State &state) {
+    std::vector<float> a(static_cast<size_t>(state.range(0))), b(static_cast<size_t>(state.range(0)));
+    std::iota(a.begin(), a.end(), 0.0f);
+    std::iota(b.begin(), b.end(), 1.0f);
+    std::span<const float> x(a), y(b);
+    for(auto _ : state)
+        benchmark::DoNotOptimize(std::inner_product(x.begin(), x.end(), y.begin(), 0.0f));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * 2 * x.size_bytes()));
+}
+BENCHMARK(BM_InnerProductSpan)->Range(64, 1 << 20);
+
+static void BM_IndexSpan(benchmark::State &state) {
+    std::vector<int> vector(static_cast<size_t>(state.range(0)));
+    std::iota(vector.begin(), vector.end(), 0);
+    std::span<const int> span(vector);
+    for(auto _ : state) {
+        long total = 0;
+        for(size_t i = 0; i < span.size(); ++i)
+            total += span[i];
+        benchmark::DoNotOptimize(total);
+    }
+}
+BENCHMARK(BM_IndexSpan)->Arg(64)->Arg(4096);
+#endif
@@ -0,0 +1,44 @@
+#include <benchmark/benchmark.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/local_shared_ptr.h>
+
+using namespace CPPBuffer;
+
+// The cost of what passing a Buffer by value does: one copy and one destruction of its ptr_t
+template< typename buffer_t >
+static void BM_CopyHandle(benchmark::State &state) {
+    buffer_t buffer(64);
+    for(auto _ : state) {
+        buffer_t copy(buffer);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_CopyHandle, Buffer<float>);
+BENCHMARK_TEMPLATE(BM_CopyHandle, Buffer<float, 1u, local_shared_ptr<float>>);
+BENCHMARK_TEMPLATE(BM_CopyHandle, Buffer<float, 1u, intrusive_array_ptr<float>>);
+
+// The same, for a Slice, which carries a copy of its Buffer
+template< typename buffer_t >
+static void BM_CopySlice(benchmark::State &state) {
+    buffer_t buffer(64);
+    auto slice = buffer.template slice<2>();
+    for(auto _ : state) {
+        auto copy = slice;
+        benchmark::DoNotOptimize(copy);
+    }
+}
+BENCHMARK_TEMPLATE(BM_CopySlice, Buffer<float>);
+BENCHMARK_TEMPLATE(BM_CopySlice, Buffer<float, 1u, local_shared_ptr<float>>);
+BENCHMARK_TEMPLATE(BM_CopySlice, Buffer<float, 1u, intrusive_array_ptr<float>>);
+
+// And the allocation itself, which is a single block for all three
+template< typename buffer_t >
+static void BM_Allocate(benchmark::State &state) {
+    for(auto _ : state) {
+        buffer_t buffer(static_cast<size_t>(state.range(0)), uninitialized);
+        benchmark::DoNotOptimize(buffer.begin());
+    }
+}
+BENCHMARK_TEMPLATE(BM_Allocate, Buffer<float>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_Allocate, Buffer<float, 1u, local_shared_ptr<float>>)->Arg(64)->Arg(4096);
+BENCHMARK_TEMPLATE(BM_Allocate, Buffer<float, 1u, intrusive_array_ptr<float>>)->Arg(64)->Arg(4096);
@@ -0,0 +1,22 @@
+#include <benchmark/benchmark.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/small_buffer.h>
+
+#include <numeric>
+
+using namespace CPPBuffer;
+
+// Making a small buffer and touching every element, which is what a header or a coefficient set costs
+template< typename buffer_t >
+static void BM_MakeSmall(benchmark::State &state) {
+    const size_t n = static_cast<size_t>(state.range(0));
+    for(auto _ : state) {
+        buffer_t buffer(n);
+        std::iota(buffer.begin(), buffer.end(), 0.0f);
+        benchmark::DoNotOptimize(buffer.begin());
+        benchmark::ClobberMemory();
+    }
+}
+BENCHMARK_TEMPLATE(BM_MakeSmall, Buffer<float>)->Arg(16)->Arg(64);
+BENCHMARK_TEMPLATE(BM_MakeSmall, SmallBuffer<float, 64>)->Arg(16)->Arg(64);
+BENCHMARK_TEMPLATE(BM_MakeSmall, StaticBuffer<float, 64>)->Arg(16)->Arg(64);
@@ -0,0 +1,45 @@
+#include <benchmark/benchmark.h>
+#include <cpp_buffer/algorithms.h>
+#include <cpp_buffer/tiling.h>
+
+#include <numeric>
+
+using namespace CPPBuffer;
+
+// Three passes over a buffer well beyond L2: scale, offset, sum. Each pass streams the whole buffer from memory.
+// Halving and adding one settles every sample towards 2, so repeated iterations work on the same finite values.
+static void BM_ThreePasses(benchmark::State &state) {
+    Buffer<float> samples(static_cast<size_t>(state.range(0)));
+    std::iota(samples.begin(), samples.end(), 0.0f);
+    Buffer<float> ones(samples.size());
+    fill(ones, 1.0f);
+    for(auto _ : state) {
+        axpy(-0.5f, samples, samples);
+        axpy(1.0f, ones, samples);
+        benchmark::DoNotOptimize(sum(samples));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_of(samples)));
+}
+BENCHMARK(BM_ThreePasses)->Arg(1 << 22);
+
+// The same passes fused per L2-sized tile, so only the first one goes to memory
+static void BM_ThreePassesTiled(benchmark::State &state) {
+    Buffer<float> samples(static_cast<size_t>(state.range(0)));
+    std::iota(samples.begin(), samples.end(), 0.0f);
+    Buffer<float> ones(samples.size());
+    fill(ones, 1.0f);
+    auto sampleTiles = cache_tiles(samples, CacheLevel::l2, 2u);
+    auto oneTiles = tiles(ones, sampleTiles.tile_size());
+    for(auto _ : state) {
+        float total = 0.0f;
+        for(size_t i = 0; i < sampleTiles.size(); ++i) {
+            auto tile = sampleTiles[i];
+            axpy(-0.5f, tile, tile);
+            axpy(1.0f, oneTiles[i], tile);
+            total += sum(tile);
+        }
+        benchmark::DoNotOptimize(total);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size_of(samples)));
+}
+BENCHMARK(BM_ThreePassesTiled)->Arg(1 << 22);
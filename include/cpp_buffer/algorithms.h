@@ -0,0 +1,382 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<type_traits>
+
+#include "buffer.h"
+
+
+/**
+ *  Bulk operations on Buffers and Slices: fill, copy, axpy, dot, sum, min and max.
+ *
+ *  Every operation works on the raw memory behind the view, with the stride as a compile-time constant, so a
+ *  Slice<float,2u> is processed with de-interleaving loads rather than one element at a time. Reductions keep one
+ *  accumulator per SIMD lane (a cache line's worth) instead of the single serial dependency chain of std::accumulate,
+ *  which is what lets them vectorize without -ffast-math. The flip side is that floating point results can differ from
+ *  a front-to-back sum in the last bits.
+ *
+ *  On x86 with GCC or Clang each kernel is also compiled for AVX2 and AVX-512, and picked at runtime from what the CPU
+ *  supports. Everywhere else the kernels are compiled for the target the library is built for, which on AArch64 means
+ *  NEON. Define CPPBUFFER_NO_SIMD_DISPATCH to always use the latter.
+ *
+ *  Slices with a dynamic_stride go through the same kernels: runtime strides from 1 to 4 are handed to the ones compiled
+ *  for that stride, and wider ones to a kernel that reads the stride from a register. That one also prefetches in
+ *  software once consecutive elements are a cache line or more apart, which is where hardware prefetchers stop
+ *  following the access pattern.
+ *
+ *  Contiguous kernels vectorize from -O2 on. The de-interleaving loads for strided Slices need the loop vectorizer,
+ *  which GCC only runs at its full cost model from -O3.
+ */
+
+#if !defined(CPPBUFFER_NO_SIMD_DISPATCH) && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__GNUC__) || defined(__clang__))
+  #define CPPBUFFER_SIMD_DISPATCH 1
+#else
+  #define CPPBUFFER_SIMD_DISPATCH 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+  #define CPPBUFFER_FORCE_INLINE inline __attribute__((always_inline))
+  #define CPPBUFFER_PREFETCH(address) __builtin_prefetch(address)
+#else
+  #define CPPBUFFER_FORCE_INLINE inline
+  #define CPPBUFFER_PREFETCH(address) ((void)(address))
+#endif
+
+
+namespace CPPBuffer
+{
+
+enum class SimdLevel
+{
+    generic,
+    avx2,
+    avx512,
+};
+
+/** The instruction set the bulk operations are dispatched to on this machine */
+inline SimdLevel simd_level() {
+#if CPPBUFFER_SIMD_DISPATCH
+    static const SimdLevel level = []() {
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")
+            && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))
+            return SimdLevel::avx512;
+        if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+            return SimdLevel::avx2;
+        return SimdLevel::generic;
+    }();
+    return level;
+#else
+    return SimdLevel::generic;
+#endif
+}
+
+
+namespace detail
+{
+
+// calls f(std::integral_constant<size_t, s>()) with the stride the kernels are to be compiled for: the view's own
+// compile-time stride, a small runtime stride as a constant, and the dynamic_stride for everything else
+template< size_t stride, typename function_t >
+decltype(auto) with_stride(size_t runtimeStride, function_t &&f) {
+    if constexpr(stride != dynamic_stride) {
+        return f(std::integral_constant<size_t, stride>());
+    } else {
+        switch(runtimeStride) {
+            case 1u: return f(std::integral_constant<size_t, 1u>());
+            case 2u: return f(std::integral_constant<size_t, 2u>());
+            case 3u: return f(std::integral_constant<size_t, 3u>());
+            case 4u: return f(std::integral_constant<size_t, 4u>());
+            default: return f(std::integral_constant<size_t, dynamic_stride>());
+        }
+    }
+}
+
+// how far ahead, in elements, prefetch() reaches
+constexpr size_t prefetch_distance = 16u;
+
+// Software prefetch of element i + prefetch_distance, for runtime strides that put every element on a cache line of
+// its own. Compile-time strides are left to the hardware prefetcher, which also keeps the loop vectorizable.
+template< size_t stride, typename T >
+CPPBUFFER_FORCE_INLINE void prefetch(const T *p, size_t i, size_t step, size_t n) {
+    if constexpr(stride == dynamic_stride) {
+        if(step * sizeof(T) >= 64u && i + prefetch_distance < n)
+            CPPBUFFER_PREFETCH(p + (i + prefetch_distance) * step);
+    } else {
+        (void)p; (void)i; (void)step; (void)n;
+    }
+}
+
+// one accumulator per lane of a cache-line-wide register
+template< typename T >
+constexpr size_t lanes() {
+    return sizeof(T) < 64u ? 64u / sizeof(T) : 1u;
+}
+
+template< typename T >
+using accumulator_t = decltype(T() + T());
+
+
+/**
+ *  The kernels. Each one is a plain loop that the compiler vectorizes for whatever target it ends up being compiled
+ *  for, which is why they are forced inline into the dispatch wrappers below.
+ */
+template< size_t stride, typename T >
+struct FillKernel
+{
+    static CPPBUFFER_FORCE_INLINE void run(T *p, size_t n, T value, size_t runtimeStride) {
+        const size_t step = stride != dynamic_stride ? stride : runtimeStride;
+        for(size_t i = 0; i < n; ++i) {
+            prefetch<stride>(p, i, step, n);
+            p[i * step] = value;
+        }
+    }
+};
+
+template< size_t dstStride, size_t srcStride, typename T >
+struct CopyKernel
+{
+    static CPPBUFFER_FORCE_INLINE void run(T *dst, const T *src, size_t n, size_t dstRuntime, size_t srcRuntime) {
+        if(dstStride == 1u && srcStride == 1u && std::is_trivially_copyable<T>::value) {
+            if(n > 0u)
+                std::memmove(static_cast<void *>(dst), static_cast<const void *>(src), n * sizeof(T));
+            return;
+        }
+        const size_t dstStep = dstStride != dynamic_stride ? dstStride : dstRuntime;
+        const size_t srcStep = srcStride != dynamic_stride ? srcStride : srcRuntime;
+        for(size_t i = 0; i < n; ++i) {
+            prefetch<dstStride>(dst, i, dstStep, n);
+            prefetch<srcStride>(src, i, srcStep, n);
+            dst[i * dstStep] = src[i * srcStep];
+        }
+    }
+};
+
+template< size_t yStride, size_t xStride, typename T >
+struct AxpyKernel
+{
+    static CPPBUFFER_FORCE_INLINE void run(T a, const T *x, T *y, size_t n, size_t xRuntime, size_t yRuntime) {
+        const size_t xStep = xStride != dynamic_stride ? xStride : xRuntime;
+        const size_t yStep = yStride != dynamic_stride ? yStride : yRuntime;
+        for(size_t i = 0; i < n; ++i) {
+            prefetch<xStride>(x, i, xStep, n);
+            prefetch<yStride>(y, i, yStep, n);
+            y[i * yStep] += a * x[i * xStep];
+        }
+    }
+};
+
+template< size_t xStride, size_t yStride, typename T >
+struct DotKernel
+{
+    typedef accumulator_t<T> result_t;
+
+    static CPPBUFFER_FORCE_INLINE result_t run(const T *x, const T *y, size_t n, size_t xRuntime, size_t yRuntime) {
+        const size_t xStep = xStride != dynamic_stride ? xStride : xRuntime;
+        const size_t yStep = yStride != dynamic_stride ? yStride : yRuntime;
+        constexpr size_t L = lanes<T>();
+        result_t acc[L] = {};
+        size_t i = 0;
+        for(; i + L <= n; i += L) {
+            for(size_t j = 0; j < L; ++j) {
+                prefetch<xStride>(x, i + j, xStep, n);
+                prefetch<yStride>(y, i + j, yStep, n);
+                acc[j] += result_t(x[(i + j) * xStep]) * result_t(y[(i + j) * yStep]);
+            }
+        }
+        // fewer than L are left. Bounding the tail by L as well lets the compiler see that, and not warn about the
+        // iterations past n it otherwise can't rule out.
+        for(size_t j = 0; j < L && i < n; ++j, ++i)
+            acc[0] += result_t(x[i * xStep]) * result_t(y[i * yStep]);
+
+        result_t total = result_t();
+        for(size_t j = 0; j < L; ++j)
+            total += acc[j];
+        return total;
+    }
+};
+
+template< size_t stride, typename T >
+struct SumKernel
+{
+    typedef accumulator_t<T> result_t;
+
+    static CPPBUFFER_FORCE_INLINE result_t run(const T *p, size_t n, size_t runtimeStride) {
+        const size_t step = stride != dynamic_stride ? stride : runtimeStride;
+        constexpr size_t L = lanes<T>();
+        result_t acc[L] = {};
+        size_t i = 0;
+        for(; i + L <= n; i += L) {
+            for(size_t j = 0; j < L; ++j) {
+                prefetch<stride>(p, i + j, step, n);
+                acc[j] += p[(i + j) * step];
+            }
+        }
+        for(size_t j = 0; j < L && i < n; ++j, ++i)
+            acc[0] += p[i * step];
+
+        result_t total = result_t();
+        for(size_t j = 0; j < L; ++j)
+            total += acc[j];
+        return total;
+    }
+};
+
+// min and max share a kernel, both need at least one element
+template< size_t stride, typename T, bool greater >
+struct ExtremumKernel
+{
+    static CPPBUFFER_FORCE_INLINE T pick(T a, T b) { return greater ? (b > a ? b : a) : (b < a ? b : a); }
+
+    static CPPBUFFER_FORCE_INLINE T run(const T *p, size_t n, size_t runtimeStride) {
+        const size_t step = stride != dynamic_stride ? stride : runtimeStride;
+        constexpr size_t L = lanes<T>();
+        T acc[L];
+        for(size_t j = 0; j < L; ++j)
+            acc[j] = p[0];
+
+        size_t i = 0;
+        for(; i + L <= n; i += L) {
+            for(size_t j = 0; j < L; ++j) {
+                prefetch<stride>(p, i + j, step, n);
+                acc[j] = pick(acc[j], p[(i + j) * step]);
+            }
+        }
+        for(size_t j = 0; j < L && i < n; ++j, ++i)
+            acc[0] = pick(acc[0], p[i * step]);
+
+        T result = acc[0];
+        for(size_t j = 1; j < L; ++j)
+            result = pick(result, acc[j]);
+        return result;
+    }
+};
+
+
+#if CPPBUFFER_SIMD_DISPATCH
+template< typename kernel_t, typename ... args_t >
+__attribute__((target("avx2,fma"))) auto run_avx2(args_t ... args) {
+    return kernel_t::run(args...);
+}
+
+template< typename kernel_t, typename ... args_t >
+__attribute__((target("avx512f,avx512dq,avx512bw,avx512vl,avx2,fma"))) auto run_avx512(args_t ... args) {
+    return kernel_t::run(args...);
+}
+#endif
+
+template< typename kernel_t, typename ... args_t >
+auto run_generic(args_t ... args) {
+    return kernel_t::run(args...);
+}
+
+template< typename kernel_t, typename ... args_t >
+auto dispatch(args_t ... args) {
+#if CPPBUFFER_SIMD_DISPATCH
+    switch(simd_level()) {
+        case SimdLevel::avx512: return run_avx512<kernel_t>(args...);
+        case SimdLevel::avx2: return run_avx2<kernel_t>(args...);
+        case SimdLevel::generic: break;
+    }
+#endif
+    return run_generic<kernel_t>(args...);
+}
+
+template< typename view_t >
+using element_t = typename std::remove_reference<decltype(*std::declval<view_t &>().begin())>::type;
+
+}// namespace detail
+
+
+
+/** Sets every element of a Buffer or Slice to value */
+template< typename view_t >
+void fill(view_t &&view, const detail::element_t<view_t> &value) {
+    typedef typename std::remove_const<detail::element_t<view_t>>::type T;
+    const size_t s = detail::stride_at(view);
+    detail::with_stride<detail::stride_of<view_t>()>(s, [&](auto stride) {
+        detail::dispatch<detail::FillKernel<decltype(stride)::value, T>>(
+            detail::memory_of(view), view.size(), value, s);
+    });
+}
+
+/** Copies src into dst, which must be the same size. The two may overlap only if both are unit-strided */
+template< typename src_t, typename dst_t >
+void copy(const src_t &src, dst_t &&dst) {
+    cpp_buffer_assert(src.size() == dst.size());
+    typedef typename std::remove_const<detail::element_t<dst_t>>::type T;
+    const size_t ds = detail::stride_at(dst), ss = detail::stride_at(src);
+    detail::with_stride<detail::stride_of<dst_t>()>(ds, [&](auto dstStride) {
+        detail::with_stride<detail::stride_of<const src_t>()>(ss, [&](auto srcStride) {
+            detail::dispatch<detail::CopyKernel<decltype(dstStride)::value, decltype(srcStride)::value, T>>(
+                detail::memory_of(dst), detail::memory_of(src), dst.size(), ds, ss);
+        });
+    });
+}
+
+/** y += a * x, for x and y of the same size */
+template< typename x_t, typename y_t >
+void axpy(const detail::element_t<y_t> &a, const x_t &x, y_t &&y) {
+    cpp_buffer_assert(x.size() == y.size());
+    typedef typename std::remove_const<detail::element_t<y_t>>::type T;
+    const size_t xs = detail::stride_at(x), ys = detail::stride_at(y);
+    detail::with_stride<detail::stride_of<y_t>()>(ys, [&](auto yStride) {
+        detail::with_stride<detail::stride_of<const x_t>()>(xs, [&](auto xStride) {
+            detail::dispatch<detail::AxpyKernel<decltype(yStride)::value, decltype(xStride)::value, T>>(
+                a, detail::memory_of(x), detail::memory_of(y), y.size(), xs, ys);
+        });
+    });
+}
+
+/** The inner product of x and y, which must be the same size. Small integer types are accumulated as int */
+template< typename x_t, typename y_t >
+auto dot(const x_t &x, const y_t &y) {
+    cpp_buffer_assert(x.size() == y.size());
+    typedef typename std::remove_const<detail::element_t<const x_t>>::type T;
+    const size_t xs = detail::stride_at(x), ys = detail::stride_at(y);
+    return detail::with_stride<detail::stride_of<const x_t>()>(xs, [&](auto xStride) {
+        return detail::with_stride<detail::stride_of<const y_t>()>(ys, [&](auto yStride) {
+            return detail::dispatch<detail::DotKernel<decltype(xStride)::value, decltype(yStride)::value, T>>(
+                detail::memory_of(x), detail::memory_of(y), x.size(), xs, ys);
+        });
+    });
+}
+
+/** The sum of all elements. Small integer types are accumulated as int */
+template< typename view_t >
+auto sum(const view_t &view) {
+    typedef typename std::remove_const<detail::element_t<const view_t>>::type T;
+    const size_t s = detail::stride_at(view);
+    return detail::with_stride<detail::stride_of<const view_t>()>(s, [&](auto stride) {
+        return detail::dispatch<detail::SumKernel<decltype(stride)::value, T>>(detail::memory_of(view), view.size(), s);
+    });
+}
+
+/** The smallest element of a non-empty Buffer or Slice */
+template< typename view_t >
+auto min(const view_t &view) {
+    cpp_buffer_assert(view.size() > 0u);
+    typedef typename std::remove_const<detail::element_t<const view_t>>::type T;
+    const size_t s = detail::stride_at(view);
+    return detail::with_stride<detail::stride_of<const view_t>()>(s, [&](auto stride) {
+        return detail::dispatch<detail::ExtremumKernel<decltype(stride)::value, T, false>>(
+            detail::memory_of(view), view.size(), s);
+    });
+}
+
+/** The largest element of a non-empty Buffer or Slice */
+template< typename view_t >
+auto max(const view_t &view) {
+    cpp_buffer_assert(view.size() > 0u);
+    typedef typename std::remove_const<detail::element_t<const view_t>>::type T;
+    const size_t s = detail::stride_at(view);
+    return detail::with_stride<detail::stride_of<const view_t>()>(s, [&](auto stride) {
+        return detail::dispatch<detail::ExtremumKernel<decltype(stride)::value, T, true>>(
+            detail::memory_of(view), view.size(), s);
+    });
+}
+
+}// namespace CPPBuffer
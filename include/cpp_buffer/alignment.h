@@ -0,0 +1,37 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<new>
+
+
+namespace CPPBuffer
+{
+
+/** The largest power of two that p is aligned to. A null pointer is aligned to nothing, and returns 0 */
+inline size_t alignment_of(const void *p) {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    return static_cast<size_t>(address & (~address + 1u));
+}
+
+template< size_t a >
+inline bool is_aligned(const void *p) {
+    static_assert(a != 0u && (a & (a - 1u)) == 0u, "alignments are powers of two");
+    return (reinterpret_cast<uintptr_t>(p) & (a - 1u)) == 0u;
+}
+
+/**
+ *  Returns p, and tells the compiler it may assume p is aligned to a, like the C++20 std::assume_aligned. It is
+ *  undefined behaviour if it isn't, so only call it on memory that is known to be aligned.
+ */
+template< size_t a, typename T >
+inline T *assume_aligned(T *p) {
+    static_assert(a != 0u && (a & (a - 1u)) == 0u, "alignments are powers of two");
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<T *>(__builtin_assume_aligned(p, a));
+#else
+    return p;
+#endif
+}
+
+}// namespace CPPBuffer
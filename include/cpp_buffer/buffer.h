@@ -2,6 +2,15 @@
 
 #include<cassert>
 #include<memory>
+#include<type_traits>
+
+#include "alignment.h"
+#include "buffer_assert.h"
+#include "buffer_iterator.h"
+#include "buffer_view.h"
+#include "checked_view.h"
+#include "local_shared_ptr.h"
+#include "shared_array.h"
 
 
 namespace CPPBuffer
@@ -20,11 +29,14 @@ namespace CPPBuffer
  *      auto slice = buffer.slice(2,4);// slices the half-open interval from the 2nd to 4th element
  *      auto slice2 = buffer.slice<2>();// slices the full range, but iterates over every other element.
  *      auto slice3 = buffer.slice<3>(2, 10); // the two strategies can be combined.
+ *      auto slice4 = buffer.slice(0, 10, columns); // a stride only known at runtime, see Slice<T, dynamic_stride>
  * 
  *  Buffer is a good candidate to use with standard library math functions. For example you could implement a mean thusly:
- *      float mean(Buffer<float> buffer) {
- *          return std::accumulate(buffer.begin(), buffer.end(), 0.0f) / buffer.size();
+ *      float mean(BufferView<const float> samples) {
+ *          return std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size();
  *      }
+ *  Every Buffer and Slice converts to a BufferView or SliceView, which passes the elements without copying the ptr_t,
+ *  see buffer_view.h. Take a Buffer by value where the function keeps hold of the elements.
  * 
  *  The ptr_t allows you to provide a custom pointer class, but the Buffer class does not do any memory bookkeeping. It
  *  very much assumes that you provide a smart pointer type.
@@ -45,6 +57,23 @@ class Slice;
 template< typename T, const uint8_t stride=1u >
 class BufferIterator;
 
+// the element-wise expressions of expressions.h, which Buffers and Slices can be assigned from
+template< typename expr_t >
+struct Expression;
+
+
+// Buffer only ever needs the raw address out of its pointer type. Smart pointers hand it out through get(), and a bare
+// pointer already is the address, which is what lets Buffer<T,1u,T*> work as a non-owning handle.
+template< typename ptr_t >
+constexpr auto get_pointer(const ptr_t &p) -> decltype(p.get()) {
+    return p.get();
+}
+
+template< typename T >
+constexpr T *get_pointer(T *p) {
+    return p;
+}
+
 
 /**
  *  This non-strided version of the buffer class provides the cleanest looking interface to the buffer class overall.
@@ -58,7 +87,12 @@ class BufferIterator;
  *      buffer[1] = 0;
  *      std::cout << buffer[1] << buffer[2];
  *      // this will fail under certain conditions:
- *      // buffer[10]; // calls a removable assert macro that fails (usually used for unit testing)
+ *      // buffer[10]; // fails cpp_buffer_assert, which throws an OutOfRangeError by default
+ *
+ *  Every operator[] checks its index. Loops that want to check once should index into checked(begin, end) instead.
+ * 
+ *  The class is deliberately not polymorphic: it holds exactly one ptr_t and a size, and is trivially copyable whenever
+ *  ptr_t is. Don't delete buffers through a base pointer, there isn't one.
  */
 template< typename T, typename pointer_t >
 class Buffer<T, 1u, pointer_t>
@@ -71,42 +105,96 @@ class Buffer<T, 1u, pointer_t>
 
     // constructors and destructors are all default for the trivial case
     Buffer() = default;
-    virtual ~Buffer() = default;
+    ~Buffer() = default;
     Buffer(const Buffer &) = default;
     Buffer(Buffer &&) = default;
     // assignment operators are also default
     Buffer &operator=(const Buffer &) = default;
     Buffer &operator=(Buffer &&) = default;
+    // evaluates an expression from expressions.h into the elements, instead of sharing other memory
+    template< typename expr_t >
+    Buffer &operator=(const Expression<expr_t> &);
 
     // The actual constructors:
-    Buffer(const ptr_t &, size_t);
-    Buffer(ptr_t &&, size_t);
-
+    constexpr Buffer(const ptr_t &, size_t);
+    constexpr Buffer(ptr_t &&, size_t);
+    // a read-only Buffer sharing the memory of a writable one, like the ones const StridedViews slice
+    template< typename U, typename = std::enable_if_t<std::is_same<const U, T>::value> >
+    constexpr Buffer(const Buffer<U, 1u, ptr_t> &);
+
+    // allocator_t is either a resource like NewDeleteResource or BufferPool, which places the control block and the
+    // elements in a single allocation, or a standard allocator. Either way it gets the memory back when the last copy
+    // of the buffer goes away, so it has to outlive every copy. See PointerAllocation for the ptr_t types that can
+    // allocate.
     template< typename allocator_t >
     Buffer(size_t, allocator_t &);
-    Buffer(size_t); // new-allocated
+    template< typename allocator_t >
+    Buffer(size_t, allocator_t &, uninitialized_t); // resources only
+    template< typename allocator_t >
+    Buffer(size_t, allocator_t &, std::align_val_t); // resources only
+    Buffer(size_t); // new-allocated, value-initialized, and sharing one allocation with its control block
+    Buffer(size_t, uninitialized_t); // as above, but the elements are left uninitialized
+    Buffer(size_t, std::align_val_t); // as above, with the first element aligned to at least the given power of two
+    Buffer(size_t, std::align_val_t, uninitialized_t);
 
     // accessors
-    T &operator[](int);
-    const T &operator[](int) const;
+    constexpr T &operator[](int);
+    constexpr const T &operator[](int) const;
 
     // iterators
-    Iterator begin();
-    Iterator end();
-    ConstIterator begin() const;
-    ConstIterator end() const;
-
-    size_t size() const; // size is the same convention used by other stl containers
+    constexpr Iterator begin();
+    constexpr Iterator end();
+    constexpr ConstIterator begin() const;
+    constexpr ConstIterator end() const;
+
+    // begin(), with a promise to the compiler that it is aligned to a. This lets loops over the buffer use aligned
+    // vector loads without a peeling prologue. Fails cpp_buffer_assert if it isn't.
+    template< size_t a >
+    Iterator aligned_begin();
+    template< size_t a >
+    ConstIterator aligned_begin() const;
+
+    constexpr size_t size() const; // size is the same convention used by other stl containers
+    size_t alignment() const; // the largest power of two the first element is aligned to
+    long use_count() const; // the owners of the memory as ptr_t counts them, which includes Slices of the buffer
+    const ptr_t &pointer() const; // the owner of the memory, for pointers into it that want to share the ownership
+
+    // checks [begin, end) once, and returns a view of it with unchecked access
+    CheckedView<T> checked(size_t begin, size_t end);
+    CheckedView<const T> checked(size_t begin, size_t end) const;
+    CheckedView<T> checked();
+    CheckedView<const T> checked() const;
 
     // finally slice operations
-    template< uint8_t s >
-    Slice<T, s, ptr_t> slice(size_t begin, size_t end);
+    template< uint8_t s = 1u >
+    constexpr Slice<T, s, ptr_t> slice(size_t begin, size_t end);
+    template< uint8_t s = 1u >
+    constexpr Slice<T, s, ptr_t> slice(); // the full range
+    constexpr Slice<T, dynamic_stride, ptr_t> slice(size_t begin, size_t end, size_t stride); // a runtime stride
 
     private:
+    template< typename, const uint8_t, typename >
+    friend class Buffer;
+
     ptr_t mMemory = nullptr;
     size_t mSize = 0ul;
 };
 
+// The layout promises above. These hold for any T, so check them once for a representative type.
+static_assert(sizeof(Buffer<float, 1u, float *>) == sizeof(float *) + sizeof(size_t), 
+    "Buffer must be exactly one pointer plus a size");
+static_assert(std::is_trivially_copyable<Buffer<float, 1u, float *>>::value, 
+    "Buffer over a bare pointer must be trivially copyable");
+static_assert(!std::is_polymorphic<Buffer<float>>::value, "Buffer must not carry a vtable");
+// containers only move their elements if that can't throw, and copy them, reference counts and all, otherwise
+static_assert(std::is_nothrow_move_constructible<Buffer<float>>::value
+    && std::is_nothrow_move_constructible<Buffer<float, 1u, local_shared_ptr<float>>>::value
+    && std::is_nothrow_move_constructible<Buffer<float, 1u, intrusive_array_ptr<float>>>::value,
+    "Buffer must be nothrow move constructible");
+static_assert(std::is_nothrow_move_assignable<Buffer<float, 1u, local_shared_ptr<float>>>::value
+    && std::is_nothrow_move_assignable<Buffer<float, 1u, intrusive_array_ptr<float>>>::value,
+    "Buffer must be nothrow move assignable");
+
 /** Return the number of bytes stored in a Buffer */
 template< typename T, uint8_t s, typename ptr_t >
 inline size_t size_of(const Buffer<T,s,ptr_t> &buffer) {
@@ -118,74 +206,542 @@ inline size_t size_of(const Buffer<T,s,ptr_t> &buffer) {
 
 // The actual constructors:
 template< typename T, typename ptr_t >
-Buffer<T, 1u, ptr_t>::Buffer(const ptr_t &p, size_t s) 
+constexpr Buffer<T, 1u, ptr_t>::Buffer(const ptr_t &p, size_t s) 
     : mMemory(p)
     , mSize(s) 
 {}
 
 template< typename T, typename ptr_t >
-Buffer<T, 1u, ptr_t>::Buffer(ptr_t &&other, size_t s) 
+constexpr Buffer<T, 1u, ptr_t>::Buffer(ptr_t &&other, size_t s) 
     : mMemory(std::move(other))
     , mSize(s) 
 {}
 
+template< typename T, typename ptr_t >
+template< typename U, typename >
+constexpr Buffer<T, 1u, ptr_t>::Buffer(const Buffer<U, 1u, ptr_t> &other)
+    : mMemory(other.mMemory)
+    , mSize(other.mSize)
+{}
+
 template< typename T, typename ptr_t >
 template< typename allocator_t >
 Buffer<T, 1u, ptr_t>::Buffer(size_t n, allocator_t &a) 
-    : mMemory(a.allocate(n))
+    : mSize(n) 
+{
+    if constexpr(detail::is_resource<allocator_t>::value)
+        mMemory = PointerAllocation<ptr_t>::make(n, alignof(T), a);
+    else
+        mMemory = make_allocated_array<T>(n, a); // standard allocators only work with std::shared_ptr
+}
+
+template< typename T, typename ptr_t >
+template< typename allocator_t >
+Buffer<T, 1u, ptr_t>::Buffer(size_t n, allocator_t &a, uninitialized_t tag) 
+    : mMemory(PointerAllocation<ptr_t>::make(n, alignof(T), a, tag))
     , mSize(n) 
-{}
+{
+    static_assert(detail::is_resource<allocator_t>::value, "only resources can hand out uninitialized buffers");
+}
 
 template< typename T, typename ptr_t >
 Buffer<T, 1u, ptr_t>::Buffer(size_t n) 
-    : mMemory(std::shared_ptr<T>(new T[n], [](T* p){ delete[] p; }))
+    : mMemory(PointerAllocation<ptr_t>::make(n, alignof(T), NewDeleteResource::instance()))
     , mSize(n) 
 {}
 
 template< typename T, typename ptr_t >
-T &Buffer<T, 1u, ptr_t>::operator[](int i) {
-    assert(i >= 0 && static_cast<size_t>(i) < mSize);
-    return mMemory.get()[i];
+Buffer<T, 1u, ptr_t>::Buffer(size_t n, uninitialized_t tag) 
+    : mMemory(PointerAllocation<ptr_t>::make(n, alignof(T), NewDeleteResource::instance(), tag))
+    , mSize(n) 
+{}
+
+template< typename T, typename ptr_t >
+template< typename allocator_t >
+Buffer<T, 1u, ptr_t>::Buffer(size_t n, allocator_t &a, std::align_val_t alignment) 
+    : mMemory(PointerAllocation<ptr_t>::make(n, static_cast<size_t>(alignment), a))
+    , mSize(n) 
+{
+    static_assert(detail::is_resource<allocator_t>::value, "only resources can hand out aligned buffers");
+}
+
+template< typename T, typename ptr_t >
+Buffer<T, 1u, ptr_t>::Buffer(size_t n, std::align_val_t alignment) 
+    : mMemory(PointerAllocation<ptr_t>::make(n, static_cast<size_t>(alignment), NewDeleteResource::instance()))
+    , mSize(n) 
+{}
+
+template< typename T, typename ptr_t >
+Buffer<T, 1u, ptr_t>::Buffer(size_t n, std::align_val_t alignment, uninitialized_t tag) 
+    : mMemory(PointerAllocation<ptr_t>::make(n, static_cast<size_t>(alignment), NewDeleteResource::instance(), tag))
+    , mSize(n) 
+{}
+
+template< typename T, typename ptr_t >
+constexpr T &Buffer<T, 1u, ptr_t>::operator[](int i) {
+    // a single compare: negative indices wrap around to huge ones
+    cpp_buffer_assert(static_cast<size_t>(i) < mSize);
+    return get_pointer(mMemory)[i];
 }
 
 template< typename T, typename ptr_t >
-const T &Buffer<T, 1u, ptr_t>::operator[](int i) const 
+constexpr const T &Buffer<T, 1u, ptr_t>::operator[](int i) const 
 {
-    assert(i >= 0 && static_cast<size_t>(i) < mSize);
-    return mMemory.get()[i];
+    cpp_buffer_assert(static_cast<size_t>(i) < mSize);
+    return get_pointer(mMemory)[i];
 }
 
 // iterators
 template< typename T, typename ptr_t >
-typename Buffer<T, 1u, ptr_t>::Iterator Buffer<T, 1u, ptr_t>::begin() { 
-    return mMemory.get(); 
+constexpr typename Buffer<T, 1u, ptr_t>::Iterator Buffer<T, 1u, ptr_t>::begin() { 
+    return get_pointer(mMemory); 
 }
 
 template< typename T, typename ptr_t >
-typename Buffer<T, 1u, ptr_t>::Iterator Buffer<T, 1u, ptr_t>::end() {
-    return mMemory.get() + mSize; 
+constexpr typename Buffer<T, 1u, ptr_t>::Iterator Buffer<T, 1u, ptr_t>::end() {
+    return get_pointer(mMemory) + mSize; 
 }
 
 template< typename T, typename ptr_t >
-typename Buffer<T, 1u, ptr_t>::ConstIterator Buffer<T, 1u, ptr_t>::begin() const { 
-    return mMemory.get(); 
+constexpr typename Buffer<T, 1u, ptr_t>::ConstIterator Buffer<T, 1u, ptr_t>::begin() const { 
+    return get_pointer(mMemory); 
 }
 
 template< typename T, typename ptr_t >
-typename Buffer<T, 1u, ptr_t>::ConstIterator Buffer<T, 1u, ptr_t>::end() const { 
-    return mMemory.get() + mSize; 
+constexpr typename Buffer<T, 1u, ptr_t>::ConstIterator Buffer<T, 1u, ptr_t>::end() const { 
+    return get_pointer(mMemory) + mSize; 
 }
 
 template< typename T, typename ptr_t >
-size_t Buffer<T, 1u, ptr_t>::size() const { 
+template< size_t a >
+typename Buffer<T, 1u, ptr_t>::Iterator Buffer<T, 1u, ptr_t>::aligned_begin() { 
+    cpp_buffer_assert(is_aligned<a>(get_pointer(mMemory)));
+    return assume_aligned<a>(get_pointer(mMemory)); 
+}
+
+template< typename T, typename ptr_t >
+template< size_t a >
+typename Buffer<T, 1u, ptr_t>::ConstIterator Buffer<T, 1u, ptr_t>::aligned_begin() const { 
+    cpp_buffer_assert(is_aligned<a>(get_pointer(mMemory)));
+    return assume_aligned<a>(static_cast<const T *>(get_pointer(mMemory))); 
+}
+
+template< typename T, typename ptr_t >
+constexpr size_t Buffer<T, 1u, ptr_t>::size() const { 
     return mSize; 
 }
 
+template< typename T, typename ptr_t >
+size_t Buffer<T, 1u, ptr_t>::alignment() const { 
+    return alignment_of(get_pointer(mMemory)); 
+}
+
+template< typename T, typename ptr_t >
+long Buffer<T, 1u, ptr_t>::use_count() const {
+    return static_cast<long>(mMemory.use_count());
+}
+
+template< typename T, typename ptr_t >
+const ptr_t &Buffer<T, 1u, ptr_t>::pointer() const {
+    return mMemory;
+}
+
+template< typename T, typename ptr_t >
+CheckedView<T> Buffer<T, 1u, ptr_t>::checked(size_t begin, size_t end) {
+    cpp_buffer_assert(begin <= end && end <= mSize);
+    return CheckedView<T>(get_pointer(mMemory) + begin, end - begin);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<const T> Buffer<T, 1u, ptr_t>::checked(size_t begin, size_t end) const {
+    cpp_buffer_assert(begin <= end && end <= mSize);
+    return CheckedView<const T>(get_pointer(mMemory) + begin, end - begin);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<T> Buffer<T, 1u, ptr_t>::checked() {
+    return CheckedView<T>(get_pointer(mMemory), mSize);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<const T> Buffer<T, 1u, ptr_t>::checked() const {
+    return CheckedView<const T>(get_pointer(mMemory), mSize);
+}
+
 // finally slice operations
 template< typename T, typename ptr_t >
 template< uint8_t s >
-Slice<T, s, ptr_t> Buffer<T, 1u, ptr_t>::slice(size_t begin, size_t end) { 
-    return Slice<T, s, ptr_t>(mMemory, mSize, begin, end, s); 
+constexpr Slice<T, s, ptr_t> Buffer<T, 1u, ptr_t>::slice(size_t begin, size_t end) { 
+    return Slice<T, s, ptr_t>(*this, begin, end); 
+}
+
+template< typename T, typename ptr_t >
+constexpr Slice<T, dynamic_stride, ptr_t> Buffer<T, 1u, ptr_t>::slice(size_t begin, size_t end, size_t stride) {
+    return Slice<T, dynamic_stride, ptr_t>(*this, begin, end, stride);
+}
+
+template< typename T, typename ptr_t >
+template< uint8_t s >
+constexpr Slice<T, s, ptr_t> Buffer<T, 1u, ptr_t>::slice() { 
+    return Slice<T, s, ptr_t>(*this, 0ul, mSize); 
+}
+
+
+
+/**
+ *  A Slice is a view into a half-open interval of a Buffer that iterates with a compile-time stride. It shares
+ *  ownership of the memory with the Buffer it came from, so it stays valid after the Buffer goes away.
+ * 
+ *  Element i of a Slice lives at begin + i * stride in the underlying buffer, so a Slice<T,2u> over the full range of
+ *  an interleaved stereo buffer views only the left channel:
+ *      Buffer<float> interleaved(2 * frames);
+ *      auto left = interleaved.slice<2>();
+ *      auto right = interleaved.slice<2>(1, interleaved.size());
+ *      float leftSum = std::accumulate(left.begin(), left.end(), 0.0f);
+ * 
+ *  Unit-strided slices iterate with bare pointers, other strides use a BufferIterator. Like Buffer, a Slice has no
+ *  vtable, so it is trivially copyable whenever ptr_t is.
+ */
+template< typename T, const uint8_t stride, typename pointer_t >
+class Slice : private Buffer<T, 1u, pointer_t>
+{
+    static_assert(stride > 0u, "Slice requires a non-zero stride");
+    typedef Buffer<T, 1u, pointer_t> Base;
+
+    public:
+    //typedefs
+    typedef pointer_t                                       ptr_t;
+    typedef typename StridedIterator<T, stride>::type       Iterator;
+    typedef typename StridedIterator<const T, stride>::type ConstIterator;
+
+    Slice() = default;
+    Slice(const Slice &) = default;
+    Slice(Slice &&) = default;
+    Slice &operator=(const Slice &) = default;
+    Slice &operator=(Slice &&) = default;
+    // evaluates an expression from expressions.h into the elements of the slice
+    template< typename expr_t >
+    Slice &operator=(const Expression<expr_t> &);
+
+    // the half-open interval [begin, end) of the buffer, stepping by stride
+    constexpr Slice(const Base &buffer, size_t begin, size_t end);
+
+    // accessors
+    constexpr T &operator[](int);
+    constexpr const T &operator[](int) const;
+
+    // iterators
+    constexpr Iterator begin();
+    constexpr Iterator end();
+    constexpr ConstIterator begin() const;
+    constexpr ConstIterator end() const;
+
+    constexpr size_t size() const; // the number of elements visited by the slice, not the size of the underlying buffer
+    using Base::pointer; // the owner of the whole buffer, not just the slice
+
+    // checks [begin, end) of the slice once, and returns a view of it with unchecked access
+    CheckedView<T, stride> checked(size_t begin, size_t end);
+    CheckedView<const T, stride> checked(size_t begin, size_t end) const;
+    CheckedView<T, stride> checked();
+    CheckedView<const T, stride> checked() const;
+
+    // slices of slices are relative to this slice, and their strides compound
+    template< uint8_t s = 1u >
+    constexpr Slice<T, stride * s, ptr_t> slice(size_t begin, size_t end);
+    template< uint8_t s = 1u >
+    constexpr Slice<T, stride * s, ptr_t> slice();
+    constexpr Slice<T, dynamic_stride, ptr_t> slice(size_t begin, size_t end, size_t s);
+
+    private:
+    template< typename, const uint8_t, typename >
+    friend class Slice;
+
+    size_t mOffset = 0ul;
+    size_t mCount = 0ul;
+};
+
+
+/**
+ *  A Slice whose stride is a runtime value, for strides that only turn up at runtime or don't fit into a uint8_t, like
+ *  a column of a matrix whose width comes from a file header:
+ *      Buffer<float> matrix(rows * columns);
+ *      auto column = matrix.slice(c, matrix.size(), columns); // a Slice<float, dynamic_stride>
+ *
+ *  Otherwise it is a Slice like any other: it shares ownership, slices and iterates the same way, and the algorithms
+ *  take it too. They run runtime strides from 1 to 4 through the compile-time kernels, so those lose nothing, and
+ *  prefetch in software once the elements are a cache line or more apart. Every Slice converts to one, for functions
+ *  that want to be written once for any stride.
+ */
+template< typename T, typename pointer_t >
+class Slice<T, dynamic_stride, pointer_t> : private Buffer<T, 1u, pointer_t>
+{
+    typedef Buffer<T, 1u, pointer_t> Base;
+
+    public:
+    //typedefs
+    typedef pointer_t                                               ptr_t;
+    typedef typename StridedIterator<T, dynamic_stride>::type       Iterator;
+    typedef typename StridedIterator<const T, dynamic_stride>::type ConstIterator;
+
+    Slice() = default;
+    Slice(const Slice &) = default;
+    Slice(Slice &&) = default;
+    Slice &operator=(const Slice &) = default;
+    Slice &operator=(Slice &&) = default;
+    // evaluates an expression from expressions.h into the elements of the slice
+    template< typename expr_t >
+    Slice &operator=(const Expression<expr_t> &);
+
+    // the half-open interval [begin, end) of the buffer, stepping by stride
+    constexpr Slice(const Base &buffer, size_t begin, size_t end, size_t stride);
+    template< uint8_t s >
+    constexpr Slice(const Slice<T, s, ptr_t> &);
+
+    // accessors
+    constexpr T &operator[](int);
+    constexpr const T &operator[](int) const;
+
+    // iterators
+    constexpr Iterator begin();
+    constexpr Iterator end();
+    constexpr ConstIterator begin() const;
+    constexpr ConstIterator end() const;
+
+    constexpr size_t size() const; // the number of elements visited by the slice, not the size of the underlying buffer
+    using Base::pointer; // the owner of the whole buffer, not just the slice
+    constexpr size_t stride() const { return mStride; }
+
+    // checks [begin, end) of the slice once, and returns a view of it with unchecked access
+    CheckedView<T, dynamic_stride> checked(size_t begin, size_t end);
+    CheckedView<const T, dynamic_stride> checked(size_t begin, size_t end) const;
+    CheckedView<T, dynamic_stride> checked();
+    CheckedView<const T, dynamic_stride> checked() const;
+
+    // slices of slices are relative to this slice, and their strides compound
+    template< uint8_t s = 1u >
+    constexpr Slice slice(size_t begin, size_t end);
+    template< uint8_t s = 1u >
+    constexpr Slice slice();
+    constexpr Slice slice(size_t begin, size_t end, size_t s);
+
+    private:
+    template< typename, const uint8_t, typename >
+    friend class Slice;
+
+    size_t mOffset = 0ul;
+    size_t mCount = 0ul;
+    size_t mStride = 1ul;
+};
+
+// Slice only adds its own bookkeeping on top of the Buffer it is privately derived from
+static_assert(sizeof(Slice<float, 2u, float *>) == sizeof(Buffer<float, 1u, float *>) + 2 * sizeof(size_t), 
+    "Slice must be a Buffer plus an offset and a count");
+static_assert(std::is_trivially_copyable<Slice<float, 2u, float *>>::value, 
+    "Slice over a bare pointer must be trivially copyable");
+
+/** Return the number of bytes visited by a Slice */
+template< typename T, uint8_t s, typename ptr_t >
+inline size_t size_of(const Slice<T,s,ptr_t> &slice) {
+    return slice.size() * sizeof(T);
+}
+
+
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr Slice<T, stride, ptr_t>::Slice(const Base &buffer, size_t begin, size_t end)
+    : Base(buffer)
+    , mOffset(begin)
+    , mCount(begin < end ? (end - begin + stride - 1u) / stride : 0ul)
+{
+    cpp_buffer_assert(begin <= end && end <= buffer.size());
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr T &Slice<T, stride, ptr_t>::operator[](int i) {
+    cpp_buffer_assert(static_cast<size_t>(i) < mCount);
+    return Base::begin()[mOffset + static_cast<size_t>(i) * stride];
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr const T &Slice<T, stride, ptr_t>::operator[](int i) const {
+    cpp_buffer_assert(static_cast<size_t>(i) < mCount);
+    return Base::begin()[mOffset + static_cast<size_t>(i) * stride];
+}
+
+// iterators
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr typename Slice<T, stride, ptr_t>::Iterator Slice<T, stride, ptr_t>::begin() {
+    return StridedIterator<T, stride>::make(Base::begin() + mOffset, 0ul);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr typename Slice<T, stride, ptr_t>::Iterator Slice<T, stride, ptr_t>::end() {
+    return StridedIterator<T, stride>::make(Base::begin() + mOffset, mCount);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr typename Slice<T, stride, ptr_t>::ConstIterator Slice<T, stride, ptr_t>::begin() const {
+    return StridedIterator<const T, stride>::make(Base::begin() + mOffset, 0ul);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr typename Slice<T, stride, ptr_t>::ConstIterator Slice<T, stride, ptr_t>::end() const {
+    return StridedIterator<const T, stride>::make(Base::begin() + mOffset, mCount);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr size_t Slice<T, stride, ptr_t>::size() const {
+    return mCount;
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+CheckedView<T, stride> Slice<T, stride, ptr_t>::checked(size_t begin, size_t end) {
+    cpp_buffer_assert(begin <= end && end <= mCount);
+    return CheckedView<T, stride>(Base::begin() + mOffset + begin * stride, end - begin);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+CheckedView<const T, stride> Slice<T, stride, ptr_t>::checked(size_t begin, size_t end) const {
+    cpp_buffer_assert(begin <= end && end <= mCount);
+    return CheckedView<const T, stride>(Base::begin() + mOffset + begin * stride, end - begin);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+CheckedView<T, stride> Slice<T, stride, ptr_t>::checked() {
+    return CheckedView<T, stride>(Base::begin() + mOffset, mCount);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+CheckedView<const T, stride> Slice<T, stride, ptr_t>::checked() const {
+    return CheckedView<const T, stride>(Base::begin() + mOffset, mCount);
+}
+
+// slices of slices
+template< typename T, const uint8_t stride, typename ptr_t >
+template< uint8_t s >
+constexpr Slice<T, stride * s, ptr_t> Slice<T, stride, ptr_t>::slice(size_t begin, size_t end) {
+    static_assert(static_cast<unsigned>(stride) * s <= 255u, "compound slice stride does not fit in a uint8_t");
+    cpp_buffer_assert(begin <= end && end <= mCount);
+
+    // re-slice the underlying buffer, translating the interval into buffer coordinates
+    Slice<T, stride * s, ptr_t> result(static_cast<const Base &>(*this), 0ul, 0ul);
+    result.mOffset = mOffset + begin * stride;
+    result.mCount = begin < end ? (end - begin + s - 1u) / s : 0ul;
+    return result;
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+template< uint8_t s >
+constexpr Slice<T, stride * s, ptr_t> Slice<T, stride, ptr_t>::slice() {
+    return slice<s>(0ul, mCount);
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+constexpr Slice<T, dynamic_stride, ptr_t> Slice<T, stride, ptr_t>::slice(size_t begin, size_t end, size_t s) {
+    return Slice<T, dynamic_stride, ptr_t>(*this).slice(begin, end, s);
+}
+
+
+// the dynamic-stride Slice
+template< typename T, typename ptr_t >
+constexpr Slice<T, dynamic_stride, ptr_t>::Slice(const Base &buffer, size_t begin, size_t end, size_t stride)
+    : Base(buffer)
+    , mOffset(begin)
+    , mCount(begin < end && stride > 0u ? (end - begin + stride - 1u) / stride : 0ul)
+    , mStride(stride)
+{
+    cpp_buffer_assert(stride > 0u && begin <= end && end <= buffer.size());
+}
+
+template< typename T, typename ptr_t >
+template< uint8_t s >
+constexpr Slice<T, dynamic_stride, ptr_t>::Slice(const Slice<T, s, ptr_t> &other)
+    : Base(static_cast<const Base &>(other))
+    , mOffset(other.mOffset)
+    , mCount(other.mCount)
+    , mStride(s)
+{}
+
+template< typename T, typename ptr_t >
+constexpr T &Slice<T, dynamic_stride, ptr_t>::operator[](int i) {
+    cpp_buffer_assert(static_cast<size_t>(i) < mCount);
+    return Base::begin()[mOffset + static_cast<size_t>(i) * mStride];
+}
+
+template< typename T, typename ptr_t >
+constexpr const T &Slice<T, dynamic_stride, ptr_t>::operator[](int i) const {
+    cpp_buffer_assert(static_cast<size_t>(i) < mCount);
+    return Base::begin()[mOffset + static_cast<size_t>(i) * mStride];
+}
+
+template< typename T, typename ptr_t >
+constexpr typename Slice<T, dynamic_stride, ptr_t>::Iterator Slice<T, dynamic_stride, ptr_t>::begin() {
+    return StridedIterator<T, dynamic_stride>::make(Base::begin() + mOffset, 0ul, mStride);
+}
+
+template< typename T, typename ptr_t >
+constexpr typename Slice<T, dynamic_stride, ptr_t>::Iterator Slice<T, dynamic_stride, ptr_t>::end() {
+    return StridedIterator<T, dynamic_stride>::make(Base::begin() + mOffset, mCount, mStride);
+}
+
+template< typename T, typename ptr_t >
+constexpr typename Slice<T, dynamic_stride, ptr_t>::ConstIterator Slice<T, dynamic_stride, ptr_t>::begin() const {
+    return StridedIterator<const T, dynamic_stride>::make(Base::begin() + mOffset, 0ul, mStride);
+}
+
+template< typename T, typename ptr_t >
+constexpr typename Slice<T, dynamic_stride, ptr_t>::ConstIterator Slice<T, dynamic_stride, ptr_t>::end() const {
+    return StridedIterator<const T, dynamic_stride>::make(Base::begin() + mOffset, mCount, mStride);
+}
+
+template< typename T, typename ptr_t >
+constexpr size_t Slice<T, dynamic_stride, ptr_t>::size() const {
+    return mCount;
+}
+
+template< typename T, typename ptr_t >
+CheckedView<T, dynamic_stride> Slice<T, dynamic_stride, ptr_t>::checked(size_t begin, size_t end) {
+    cpp_buffer_assert(begin <= end && end <= mCount);
+    return CheckedView<T, dynamic_stride>(Base::begin() + mOffset + begin * mStride, end - begin, mStride);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<const T, dynamic_stride> Slice<T, dynamic_stride, ptr_t>::checked(size_t begin, size_t end) const {
+    cpp_buffer_assert(begin <= end && end <= mCount);
+    return CheckedView<const T, dynamic_stride>(Base::begin() + mOffset + begin * mStride, end - begin, mStride);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<T, dynamic_stride> Slice<T, dynamic_stride, ptr_t>::checked() {
+    return CheckedView<T, dynamic_stride>(Base::begin() + mOffset, mCount, mStride);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<const T, dynamic_stride> Slice<T, dynamic_stride, ptr_t>::checked() const {
+    return CheckedView<const T, dynamic_stride>(Base::begin() + mOffset, mCount, mStride);
+}
+
+template< typename T, typename ptr_t >
+template< uint8_t s >
+constexpr Slice<T, dynamic_stride, ptr_t> Slice<T, dynamic_stride, ptr_t>::slice(size_t begin, size_t end) {
+    return slice(begin, end, s);
+}
+
+template< typename T, typename ptr_t >
+template< uint8_t s >
+constexpr Slice<T, dynamic_stride, ptr_t> Slice<T, dynamic_stride, ptr_t>::slice() {
+    return slice(0ul, mCount, s);
+}
+
+template< typename T, typename ptr_t >
+constexpr Slice<T, dynamic_stride, ptr_t> Slice<T, dynamic_stride, ptr_t>::slice(size_t begin, size_t end, size_t s) {
+    cpp_buffer_assert(s > 0u && begin <= end && end <= mCount);
+
+    Slice result(*this);
+    result.mOffset = mOffset + begin * mStride;
+    result.mCount = begin < end ? (end - begin + s - 1u) / s : 0ul;
+    result.mStride = mStride * s;
+    return result;
 }
 
 }// namespace CPPBuffer
\ No newline at end of file
@@ -1,19 +1,51 @@
 #pragma once
 #include "buffer_definitions.h"
+#include "instrumentation.h"
 
 
+/**
+ *  cpp_buffer_assert() checks the bounds of Buffer and Slice accesses. What a failed check does depends on:
+ *      CPPBUFFER_USES_ASSERT=0             no checks at all
+ *      CPPBUFFER_ASSERT_USES_CASSERT=1     checks with assert(), so they follow NDEBUG
+ *      otherwise                           checks call assert_hook(), which throws an OutOfRangeError, or prints the
+ *                                          failure and aborts when CPPBUFFER_ASSERT_USES_EXCEPTIONS=0
+ *
+ *  A check that passes is one compare and a branch the compiler lays out as not taken. Everything a failure needs is
+ *  in assert_hook, which is cold and never inlined, so none of it ends up next to the access that was checked.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+  #define CPPBUFFER_COLD __attribute__((cold, noinline))
+  #define CPPBUFFER_UNLIKELY(cond_) __builtin_expect(!!(cond_), 0)
+#elif defined(_MSC_VER)
+  #define CPPBUFFER_COLD __declspec(noinline)
+  #define CPPBUFFER_UNLIKELY(cond_) (cond_)
+#else
+  #define CPPBUFFER_COLD
+  #define CPPBUFFER_UNLIKELY(cond_) (cond_)
+#endif
+
 #if CPPBUFFER_USES_ASSERT && CPPBUFFER_ASSERT_USES_CASSERT
   #include <cassert>
-  #define cpp_buffer_assert(cond_) cassert(cond_)
+  #define cpp_buffer_assert(cond_) assert(cond_)
+#elif CPPBUFFER_USES_ASSERT && __cplusplus >= 202002L
+  #define cpp_buffer_assert(cond_) \
+    do { if(!(cond_)) [[unlikely]] ::CPPBuffer::assert_hook(__FILE__, __LINE__, #cond_); } while(0)
 #elif CPPBUFFER_USES_ASSERT
-  #define cpp_buffer_assert(cond_) do { if(!(cond_)) ::CPPBuffer::assert_hook(__FILE__, __LINE__, cond_, #cond_); } while(0)
+  #define cpp_buffer_assert(cond_) \
+    do { if(CPPBUFFER_UNLIKELY(!(cond_))) ::CPPBuffer::assert_hook(__FILE__, __LINE__, #cond_); } while(0)
 #else
   #define cpp_buffer_assert(cond_) (void(0))
 #endif
 
 
 #if CPPBUFFER_ASSERT_USES_EXCEPTIONS
-#include <stdexcept>
+#include <exception>
+#endif
+
+#if CPPBUFFER_HEADER_ONLY
+  #define CPPBUFFER_ASSERT_LINKAGE inline
+#else
+  #define CPPBUFFER_ASSERT_LINKAGE
 #endif
 
 
@@ -21,9 +53,87 @@ namespace CPPBuffer
 {
 
 #if CPPBUFFER_ASSERT_USES_EXCEPTIONS
-typedef std::out_of_range OutOfRangeError;
+/**
+ *  Thrown by a failed bounds check. Throwing it allocates nothing besides the exception object itself: the file and
+ *  the condition are the string literals the macro saw, and the message is formatted into the exception when it is
+ *  thrown, so what() only reads it and the exception can be rethrown on any thread.
+ */
+class OutOfRangeError : public std::exception
+{
+    public:
+    OutOfRangeError(const char *file, int line, const char *condition) noexcept;
+
+    const char *file() const noexcept { return mFile; }
+    int line() const noexcept { return mLine; }
+    const char *condition() const noexcept { return mCondition; }
+
+    // falls back to a static string if the message couldn't be formatted
+    const char *what() const noexcept override {
+        return mMessage[0] != '\0' ? mMessage : "Buffer access out of bounds";
+    }
+
+    private:
+    const char *mFile;
+    int mLine;
+    const char *mCondition;
+    char mMessage[256] = {};
+};
+#endif
+
+/**
+ *  Reports a failed cpp_buffer_assert. Never returns.
+ *
+ *  It is a template only so that header-only builds can define it in every translation unit without declaring it
+ *  inline, which would fight with noinline. cpp_buffer_impl builds the one instantiation there is, out of line.
+ */
+template< typename = void >
+[[noreturn]] CPPBUFFER_COLD void assert_hook(const char *file, int line, const char *conditionString);
+
+#if !CPPBUFFER_HEADER_ONLY
+extern template void assert_hook<void>(const char *, int, const char *);
 #endif
 
-inline void assert_hook(const char *file, int line, const int condition, const char *conditionString);
+}// namespace CPPBuffer
 
+
+// The definitions, for header-only builds, and for the one translation unit of cpp_buffer_impl that asks for them
+#if CPPBUFFER_HEADER_ONLY || defined(CPPBUFFER_ASSERT_IMPLEMENTATION)
+
+#include <cstdio>
+#include <cstdlib>
+
+namespace CPPBuffer
+{
+
+#if CPPBUFFER_ASSERT_USES_EXCEPTIONS
+CPPBUFFER_ASSERT_LINKAGE OutOfRangeError::OutOfRangeError(const char *file, int line, const char *condition) noexcept
+    : mFile(file)
+    , mLine(line)
+    , mCondition(condition)
+{
+    // only thrown from assert_hook, which is cold, so this is the place to pay for formatting
+    if(std::snprintf(mMessage, sizeof(mMessage), "%s:%d buffer assert condition failed: \"%s\"",
+        file, line, condition) <= 0)
+        mMessage[0] = '\0';
+}
+#endif
+
+template< typename >
+void assert_hook(const char *file, int line, const char *conditionString)
+{
+    CPPBUFFER_RECORD_ASSERT_FAILURE();
+#if CPPBUFFER_ASSERT_USES_EXCEPTIONS
+    throw OutOfRangeError(file, line, conditionString);
+#else
+    std::fprintf(stderr, "%s:%d buffer assert condition failed: \"%s\"\n", file, line, conditionString);
+    std::abort();
+#endif
 }
+
+#if !CPPBUFFER_HEADER_ONLY
+template void assert_hook<void>(const char *, int, const char *);
+#endif
+
+}// namespace CPPBuffer
+
+#endif
@@ -0,0 +1,300 @@
+#pragma once
+
+#include<algorithm>
+#include<cstddef>
+#include<cstdint>
+#include<iterator>
+#include<utility>
+#include<vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include<sys/uio.h>
+#define CPPBUFFER_HAS_IOVEC 1
+#else
+#define CPPBUFFER_HAS_IOVEC 0
+#endif
+
+#include "buffer.h"
+
+
+namespace CPPBuffer
+{
+
+namespace detail
+{
+
+/**
+ *  A vector of default-constructible, cheaply movable values that keeps the first N in place and only moves to the
+ *  heap when it grows beyond that.
+ */
+template< typename T, size_t N >
+class SmallVector
+{
+    public:
+    SmallVector() = default;
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0u; }
+    T *data() { return mHeap.empty() ? mInline : mHeap.data(); }
+    const T *data() const { return mHeap.empty() ? mInline : mHeap.data(); }
+    T &operator[](size_t i) { return data()[i]; }
+    const T &operator[](size_t i) const { return data()[i]; }
+    T *begin() { return data(); }
+    T *end() { return data() + mSize; }
+    const T *begin() const { return data(); }
+    const T *end() const { return data() + mSize; }
+    T &front() { return data()[0]; }
+    T &back() { return data()[mSize - 1u]; }
+
+    void insert(size_t position, T value) {
+        if(mHeap.empty() && mSize == N) {
+            // spill everything to the heap, and stay there
+            mHeap.reserve(2u * N);
+            for(size_t i = 0; i < mSize; ++i)
+                mHeap.push_back(std::move(mInline[i]));
+            std::fill(mInline, mInline + N, T());
+        }
+        if(!mHeap.empty()) {
+            mHeap.insert(mHeap.begin() + position, std::move(value));
+        } else {
+            std::move_backward(mInline + position, mInline + mSize, mInline + mSize + 1u);
+            mInline[position] = std::move(value);
+        }
+        ++mSize;
+    }
+
+    void push_back(T value) { insert(mSize, std::move(value)); }
+
+    // removes [first, last)
+    void erase(size_t first, size_t last) {
+        if(!mHeap.empty()) {
+            mHeap.erase(mHeap.begin() + first, mHeap.begin() + last);
+            if(mHeap.empty())
+                mHeap.shrink_to_fit();
+        } else {
+            std::move(mInline + last, mInline + mSize, mInline + first);
+            std::fill(mInline + mSize - (last - first), mInline + mSize, T());
+        }
+        mSize -= last - first;
+    }
+
+    void clear() { erase(0u, mSize); }
+
+    private:
+    T mInline[N];
+    std::vector<T> mHeap;
+    size_t mSize = 0u;
+};
+
+}// namespace detail
+
+
+/**
+ *  A sequence of Buffer segments that reads as one contiguous message, for scatter/gather I/O without concatenating:
+ *      BufferChain<> message;
+ *      message.append(header);
+ *      message.append(payload.slice(0, length));
+ *      message.append(trailer);
+ *      iovec iov[BufferChain<>::inline_segments];
+ *      ssize_t sent = writev(fd, iov, message.to_iovec(iov, BufferChain<>::inline_segments));
+ *      message.trim_front(sent); // whatever is left still has to go
+ *
+ *  Segments are unit-strided Slices, so every segment shares ownership of its memory and splitting or trimming the
+ *  chain at any offset only adjusts slices, never copies elements. Offsets and sizes count elements, which for the
+ *  default uint8_t are bytes. Chains of up to inline_segments segments don't allocate.
+ */
+template< typename T = uint8_t, typename ptr_t = std::shared_ptr<T>, size_t N = 4u >
+class BufferChain
+{
+    public:
+    //typedefs
+    typedef Slice<T, 1u, ptr_t>     Segment;
+    static constexpr size_t inline_segments = N;
+
+    // iterates over the elements of every segment in turn
+    template< typename value_t, typename chain_t >
+    class ElementIterator
+    {
+        public:
+        typedef std::forward_iterator_tag   iterator_category;
+        typedef typename std::remove_const<value_t>::type value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef value_t *                   pointer;
+        typedef value_t &                   reference;
+
+        ElementIterator() = default;
+        ElementIterator(chain_t *chain, size_t segment, size_t index)
+            : mChain(chain)
+            , mSegment(segment)
+            , mIndex(index)
+        {}
+
+        reference operator*() const { return mChain->mSegments[mSegment].begin()[mIndex]; }
+        pointer operator->() const { return &**this; }
+
+        ElementIterator &operator++() {
+            if(++mIndex == mChain->mSegments[mSegment].size()) {
+                mIndex = 0u;
+                ++mSegment;
+            }
+            return *this;
+        }
+        ElementIterator operator++(int) { ElementIterator tmp(*this); ++*this; return tmp; }
+
+        friend bool operator==(const ElementIterator &a, const ElementIterator &b) {
+            return a.mSegment == b.mSegment && a.mIndex == b.mIndex;
+        }
+        friend bool operator!=(const ElementIterator &a, const ElementIterator &b) { return !(a == b); }
+
+        private:
+        chain_t *mChain = nullptr;
+        size_t mSegment = 0u;
+        size_t mIndex = 0u;
+    };
+
+    typedef ElementIterator<T, BufferChain>                 Iterator;
+    typedef ElementIterator<const T, const BufferChain>     ConstIterator;
+
+    BufferChain() = default;
+
+    // segments. Empty ones are dropped, so every segment holds at least one element.
+    void append(const Buffer<T, 1u, ptr_t> &buffer) { append(Segment(buffer, 0u, buffer.size())); }
+    void append(const Segment &segment);
+    void append(const BufferChain &other);
+    void prepend(const Buffer<T, 1u, ptr_t> &buffer) { prepend(Segment(buffer, 0u, buffer.size())); }
+    void prepend(const Segment &segment);
+
+    size_t segment_count() const { return mSegments.size(); }
+    const Segment &segment(size_t i) const { return mSegments[i]; }
+    Segment &segment(size_t i) { return mSegments[i]; }
+
+    size_t size() const { return mSize; } // elements across all segments
+    bool empty() const { return mSize == 0u; }
+
+    // element access walks the segments, so prefer iterating for sequential access
+    T &operator[](size_t);
+    const T &operator[](size_t) const;
+
+    Iterator begin() { return Iterator(this, 0u, 0u); }
+    Iterator end() { return Iterator(this, mSegments.size(), 0u); }
+    ConstIterator begin() const { return ConstIterator(this, 0u, 0u); }
+    ConstIterator end() const { return ConstIterator(this, mSegments.size(), 0u); }
+
+    // removes n elements from the front or the back
+    void trim_front(size_t n);
+    void trim_back(size_t n);
+    // keeps [0, offset) and returns a chain holding [offset, size())
+    BufferChain split(size_t offset);
+
+#if CPPBUFFER_HAS_IOVEC
+    // fills up to max iovecs for writev/readv/sendmsg and returns how many it filled
+    size_t to_iovec(struct iovec *out, size_t max) const;
+#endif
+
+    private:
+    // the segment holding element offset, and the offset into it
+    std::pair<size_t, size_t> locate(size_t offset) const;
+
+    detail::SmallVector<Segment, N> mSegments;
+    size_t mSize = 0u;
+};
+
+
+
+template< typename T, typename ptr_t, size_t N >
+void BufferChain<T, ptr_t, N>::append(const Segment &segment) {
+    if(segment.size() == 0u)
+        return;
+    mSegments.push_back(segment);
+    mSize += segment.size();
+}
+
+template< typename T, typename ptr_t, size_t N >
+void BufferChain<T, ptr_t, N>::append(const BufferChain &other) {
+    for(const Segment &segment : other.mSegments)
+        append(segment);
+}
+
+template< typename T, typename ptr_t, size_t N >
+void BufferChain<T, ptr_t, N>::prepend(const Segment &segment) {
+    if(segment.size() == 0u)
+        return;
+    mSegments.insert(0u, segment);
+    mSize += segment.size();
+}
+
+template< typename T, typename ptr_t, size_t N >
+std::pair<size_t, size_t> BufferChain<T, ptr_t, N>::locate(size_t offset) const {
+    size_t segment = 0u;
+    while(segment < mSegments.size() && offset >= mSegments[segment].size())
+        offset -= mSegments[segment++].size();
+    return std::make_pair(segment, offset);
+}
+
+template< typename T, typename ptr_t, size_t N >
+T &BufferChain<T, ptr_t, N>::operator[](size_t i) {
+    cpp_buffer_assert(i < mSize);
+    auto position = locate(i);
+    return mSegments[position.first].begin()[position.second];
+}
+
+template< typename T, typename ptr_t, size_t N >
+const T &BufferChain<T, ptr_t, N>::operator[](size_t i) const {
+    cpp_buffer_assert(i < mSize);
+    auto position = locate(i);
+    return mSegments[position.first].begin()[position.second];
+}
+
+template< typename T, typename ptr_t, size_t N >
+void BufferChain<T, ptr_t, N>::trim_front(size_t n) {
+    cpp_buffer_assert(n <= mSize);
+    auto position = locate(n);
+    mSegments.erase(0u, position.first);
+    if(position.second > 0u) {
+        Segment &first = mSegments.front();
+        first = first.slice(position.second, first.size());
+    }
+    mSize -= n;
+}
+
+template< typename T, typename ptr_t, size_t N >
+void BufferChain<T, ptr_t, N>::trim_back(size_t n) {
+    cpp_buffer_assert(n <= mSize);
+    split(mSize - n);
+}
+
+template< typename T, typename ptr_t, size_t N >
+BufferChain<T, ptr_t, N> BufferChain<T, ptr_t, N>::split(size_t offset) {
+    cpp_buffer_assert(offset <= mSize);
+    BufferChain tail;
+    auto position = locate(offset);
+    size_t first = position.first;
+
+    // a segment straddling the offset ends up in both halves
+    if(position.second > 0u) {
+        Segment &straddling = mSegments[first];
+        tail.append(straddling.slice(position.second, straddling.size()));
+        straddling = straddling.slice(0u, position.second);
+        ++first;
+    }
+    for(size_t i = first; i < mSegments.size(); ++i)
+        tail.append(mSegments[i]);
+    mSegments.erase(first, mSegments.size());
+    mSize = offset;
+    return tail;
+}
+
+#if CPPBUFFER_HAS_IOVEC
+template< typename T, typename ptr_t, size_t N >
+size_t BufferChain<T, ptr_t, N>::to_iovec(struct iovec *out, size_t max) const {
+    const size_t count = std::min(max, mSegments.size());
+    for(size_t i = 0; i < count; ++i) {
+        const Segment &segment = mSegments[i];
+        out[i].iov_base = const_cast<void *>(static_cast<const void *>(segment.begin()));
+        out[i].iov_len = size_of(segment);
+    }
+    return count;
+}
+#endif
+
+}// namespace CPPBuffer
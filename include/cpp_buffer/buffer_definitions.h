@@ -1,3 +1,4 @@
+#pragma once
 
 #ifndef CPPBUFFER_USES_ASSERT
 #define CPPBUFFER_USES_ASSERT 1
@@ -10,3 +11,13 @@
 #ifndef CPPBUFFER_ASSERT_USES_EXCEPTIONS
 #define CPPBUFFER_ASSERT_USES_EXCEPTIONS 1
 #endif
+
+// counters for allocations and failed checks, see instrumentation.h
+#ifndef CPPBUFFER_INSTRUMENTATION
+#define CPPBUFFER_INSTRUMENTATION 0
+#endif
+
+// header-only builds define assert_hook inline, cpp_buffer_impl builds it once and sets this to 0
+#ifndef CPPBUFFER_HEADER_ONLY
+#define CPPBUFFER_HEADER_ONLY 1
+#endif
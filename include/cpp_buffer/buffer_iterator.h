@@ -0,0 +1,192 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<iterator>
+#include<type_traits>
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  The stride of views whose stride is only known at runtime. Slice<T, dynamic_stride> and
+ *  BufferIterator<T, dynamic_stride> keep their stride as a member instead, which lifts the 255 limit of the
+ *  compile-time uint8_t, at the cost of a multiply by a variable.
+ */
+inline constexpr size_t dynamic_stride = 0u;
+
+/**
+ *  A random-access iterator that steps over every stride-th element of contiguous memory.
+ *
+ *  The iterator keeps the base pointer of the view and a logical index into it, so the stride is folded into the
+ *  address computation at compile time (base[index * stride]) and the end iterator never has to point further than the
+ *  view itself. Comparisons and distances are done on the logical index only.
+ *
+ *  Comparing iterators that were created from different views is undefined, just like it is for pointers.
+ */
+template< typename T, const uint8_t stride >
+class BufferIterator
+{
+    static_assert(stride > 0u, "BufferIterator requires a non-zero stride");
+
+    public:
+    //typedefs
+    typedef std::random_access_iterator_tag         iterator_category;
+    typedef typename std::remove_const<T>::type     value_type;
+    typedef std::ptrdiff_t                          difference_type;
+    typedef T *                                     pointer;
+    typedef T &                                     reference;
+
+    BufferIterator() = default;
+    BufferIterator(const BufferIterator &) = default;
+    constexpr BufferIterator &operator=(const BufferIterator &) = default;
+
+    constexpr BufferIterator(T *base, size_t index)
+        : mBase(base)
+        , mIndex(index)
+    {}
+
+    // a mutable iterator converts to a const one, but not the other way around
+    template< typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type >
+    constexpr BufferIterator(const BufferIterator<U, stride> &other)
+        : mBase(other.base())
+        , mIndex(other.index())
+    {}
+
+    // accessors
+    constexpr reference operator*() const { return mBase[mIndex * stride]; }
+    constexpr pointer operator->() const { return mBase + mIndex * stride; }
+    constexpr reference operator[](difference_type n) const { return mBase[(mIndex + n) * stride]; }
+
+    // the underlying position, mostly useful for conversions and for algorithms that want the raw pointers
+    constexpr T *base() const { return mBase; }
+    constexpr size_t index() const { return mIndex; }
+
+    // increments and decrements
+    constexpr BufferIterator &operator++() { ++mIndex; return *this; }
+    constexpr BufferIterator &operator--() { --mIndex; return *this; }
+    constexpr BufferIterator operator++(int) { BufferIterator tmp(*this); ++mIndex; return tmp; }
+    constexpr BufferIterator operator--(int) { BufferIterator tmp(*this); --mIndex; return tmp; }
+
+    constexpr BufferIterator &operator+=(difference_type n) { mIndex += n; return *this; }
+    constexpr BufferIterator &operator-=(difference_type n) { mIndex -= n; return *this; }
+
+    friend constexpr BufferIterator operator+(BufferIterator it, difference_type n) { return it += n; }
+    friend constexpr BufferIterator operator+(difference_type n, BufferIterator it) { return it += n; }
+    friend constexpr BufferIterator operator-(BufferIterator it, difference_type n) { return it -= n; }
+    friend constexpr difference_type operator-(const BufferIterator &a, const BufferIterator &b) {
+        return static_cast<difference_type>(a.mIndex) - static_cast<difference_type>(b.mIndex);
+    }
+
+    // comparisons
+    friend constexpr bool operator==(const BufferIterator &a, const BufferIterator &b) { return a.mIndex == b.mIndex; }
+    friend constexpr bool operator!=(const BufferIterator &a, const BufferIterator &b) { return a.mIndex != b.mIndex; }
+    friend constexpr bool operator<(const BufferIterator &a, const BufferIterator &b) { return a.mIndex < b.mIndex; }
+    friend constexpr bool operator>(const BufferIterator &a, const BufferIterator &b) { return a.mIndex > b.mIndex; }
+    friend constexpr bool operator<=(const BufferIterator &a, const BufferIterator &b) { return a.mIndex <= b.mIndex; }
+    friend constexpr bool operator>=(const BufferIterator &a, const BufferIterator &b) { return a.mIndex >= b.mIndex; }
+
+    private:
+    T *mBase = nullptr;
+    size_t mIndex = 0ul;
+};
+
+
+/**
+ *  The runtime-stride iterator: the same as any other BufferIterator, with the stride kept next to the index.
+ */
+template< typename T >
+class BufferIterator<T, dynamic_stride>
+{
+    public:
+    //typedefs
+    typedef std::random_access_iterator_tag         iterator_category;
+    typedef typename std::remove_const<T>::type     value_type;
+    typedef std::ptrdiff_t                          difference_type;
+    typedef T *                                     pointer;
+    typedef T &                                     reference;
+
+    BufferIterator() = default;
+    BufferIterator(const BufferIterator &) = default;
+    constexpr BufferIterator &operator=(const BufferIterator &) = default;
+
+    constexpr BufferIterator(T *base, size_t index, size_t stride)
+        : mBase(base)
+        , mIndex(index)
+        , mStride(stride)
+    {}
+
+    template< typename U, typename = typename std::enable_if<std::is_same<const U, T>::value>::type >
+    constexpr BufferIterator(const BufferIterator<U, dynamic_stride> &other)
+        : mBase(other.base())
+        , mIndex(other.index())
+        , mStride(other.stride())
+    {}
+
+    // accessors
+    constexpr reference operator*() const { return mBase[mIndex * mStride]; }
+    constexpr pointer operator->() const { return mBase + mIndex * mStride; }
+    constexpr reference operator[](difference_type n) const { return mBase[(mIndex + n) * mStride]; }
+
+    constexpr T *base() const { return mBase; }
+    constexpr size_t index() const { return mIndex; }
+    constexpr size_t stride() const { return mStride; }
+
+    // increments and decrements
+    constexpr BufferIterator &operator++() { ++mIndex; return *this; }
+    constexpr BufferIterator &operator--() { --mIndex; return *this; }
+    constexpr BufferIterator operator++(int) { BufferIterator tmp(*this); ++mIndex; return tmp; }
+    constexpr BufferIterator operator--(int) { BufferIterator tmp(*this); --mIndex; return tmp; }
+
+    constexpr BufferIterator &operator+=(difference_type n) { mIndex += n; return *this; }
+    constexpr BufferIterator &operator-=(difference_type n) { mIndex -= n; return *this; }
+
+    friend constexpr BufferIterator operator+(BufferIterator it, difference_type n) { return it += n; }
+    friend constexpr BufferIterator operator+(difference_type n, BufferIterator it) { return it += n; }
+    friend constexpr BufferIterator operator-(BufferIterator it, difference_type n) { return it -= n; }
+    friend constexpr difference_type operator-(const BufferIterator &a, const BufferIterator &b) {
+        return static_cast<difference_type>(a.mIndex) - static_cast<difference_type>(b.mIndex);
+    }
+
+    // comparisons
+    friend constexpr bool operator==(const BufferIterator &a, const BufferIterator &b) { return a.mIndex == b.mIndex; }
+    friend constexpr bool operator!=(const BufferIterator &a, const BufferIterator &b) { return a.mIndex != b.mIndex; }
+    friend constexpr bool operator<(const BufferIterator &a, const BufferIterator &b) { return a.mIndex < b.mIndex; }
+    friend constexpr bool operator>(const BufferIterator &a, const BufferIterator &b) { return a.mIndex > b.mIndex; }
+    friend constexpr bool operator<=(const BufferIterator &a, const BufferIterator &b) { return a.mIndex <= b.mIndex; }
+    friend constexpr bool operator>=(const BufferIterator &a, const BufferIterator &b) { return a.mIndex >= b.mIndex; }
+
+    private:
+    T *mBase = nullptr;
+    size_t mIndex = 0ul;
+    size_t mStride = 1ul;
+};
+
+
+/**
+ *  Selects the iterator type for a given stride. A unit stride is just contiguous memory, so it iterates with a bare
+ *  pointer, which is what every standard algorithm is best at. Everything else uses a BufferIterator.
+ */
+template< typename T, const uint8_t stride >
+struct StridedIterator
+{
+    typedef BufferIterator<T, stride> type;
+    static constexpr type make(T *base, size_t index) { return type(base, index); }
+};
+
+template< typename T >
+struct StridedIterator<T, 1u>
+{
+    typedef T * type;
+    static constexpr type make(T *base, size_t index) { return base + index; }
+};
+
+template< typename T >
+struct StridedIterator<T, dynamic_stride>
+{
+    typedef BufferIterator<T, dynamic_stride> type;
+    static constexpr type make(T *base, size_t index, size_t stride) { return type(base, index, stride); }
+};
+
+}// namespace CPPBuffer
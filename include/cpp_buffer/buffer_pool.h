@@ -0,0 +1,225 @@
+#pragma once
+
+#include<atomic>
+#include<cstddef>
+#include<thread>
+#include<vector>
+
+#include "buffer_assert.h"
+#include "shared_array.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A size-class arena for Buffers. Hand it to the allocating Buffer constructor and the buffer, together with its
+ *  control block, is carved out of one of the pool's slabs; when the last copy of the buffer goes away the block goes
+ *  back on the pool's free list instead of to the system:
+ *      BufferPool pool;
+ *      pool.reserve<uint8_t>(1500, 256); // warm up, so the steady state never touches malloc
+ *      Buffer<uint8_t> packet(1500, pool, uninitialized);
+ *
+ *  Blocks come in power-of-two size classes from min_block_bytes up to the maxBlockBytes given at construction.
+ *  Larger requests are passed on to NewDeleteResource. Each class keeps a plain free list for the thread that owns the
+ *  pool, which is the only thread allowed to allocate from it, and a lock-free list that buffers released on any other
+ *  thread are pushed onto. The owner adopts that list wholesale once its own runs dry, so allocating never takes a
+ *  lock, releasing on the owner is a plain push that hands back the most recently used (cache-warm) block next, and
+ *  releasing elsewhere costs a single compare-and-swap. Use one pool per allocating thread: allocating on any other
+ *  thread than the one that made the pool fails cpp_buffer_assert.
+ *
+ *  Blocks are aligned to their size, up to max_block_alignment, so larger classes also satisfy page alignment.
+ *
+ *  The pool has to outlive every buffer allocated from it.
+ */
+class BufferPool
+{
+    public:
+    static constexpr size_t min_block_bytes = 64u;
+    static constexpr size_t max_block_alignment = 4096u;
+    static constexpr size_t min_slab_bytes = 64u * 1024u;
+
+    // one contiguous run of blocks, as handed out by the upstream resource
+    struct Slab
+    {
+        void *memory;
+        size_t bytes;
+        size_t alignment;
+    };
+
+    explicit BufferPool(size_t maxBlockBytes = 1u << 20);
+    ~BufferPool();
+
+    BufferPool(const BufferPool &) = delete;
+    BufferPool &operator=(const BufferPool &) = delete;
+
+    // the resource interface used by Buffer(size_t, allocator_t &)
+    void *allocate(size_t bytes, size_t alignment);
+    void deallocate(void *p, size_t bytes, size_t alignment);
+
+    // makes sure count buffers of n elements each can be allocated without going upstream
+    template< typename T >
+    void reserve(size_t n, size_t count);
+
+    // Bulk release: every slab goes back upstream at once. No buffer allocated from the pool may still be alive, which
+    // fails cpp_buffer_assert, and terminates when it is the destructor that finds out.
+    void reset();
+
+    // the number of blocks currently handed out, including the ones passed on to the upstream resource. Safe from any
+    // thread, but only a snapshot there.
+    size_t outstanding() const;
+    // every slab the pool currently owns, e.g. for registering them with the kernel
+    const std::vector<Slab> &slabs() const { return mSlabs; }
+
+    private:
+    struct Node { Node *next; };
+
+    struct alignas(64) SizeClass
+    {
+        Node *local = nullptr;              // only touched by the owning thread
+        std::atomic<Node *> remote{nullptr};// pushed to from any thread, drained by the owner
+    };
+
+    // returns the size class index for a request, or -1 if it has to go upstream
+    int classify(size_t bytes, size_t alignment) const;
+    size_t classBytes(int sizeClass) const { return min_block_bytes << sizeClass; }
+    void grow(int sizeClass);
+    void pushLocal(int sizeClass, void *p);
+    void pushRemote(int sizeClass, void *p);
+
+    size_t mMaxBlockBytes;
+    int mClassCount = 0;
+    SizeClass *mClasses;
+    std::vector<Slab> mSlabs;
+    std::atomic<size_t> mHandedOut{0ul}; // only written by the owner, atomic so outstanding() can read it anywhere
+    std::atomic<size_t> mReturned{0ul};
+    std::thread::id mOwner;
+};
+
+
+
+inline BufferPool::BufferPool(size_t maxBlockBytes)
+    : mMaxBlockBytes(min_block_bytes)
+    , mOwner(std::this_thread::get_id())
+{
+    while(mMaxBlockBytes < maxBlockBytes) {
+        mMaxBlockBytes <<= 1;
+        ++mClassCount;
+    }
+    ++mClassCount;
+    mClasses = new SizeClass[mClassCount];
+}
+
+inline BufferPool::~BufferPool() {
+    reset();
+    delete[] mClasses;
+}
+
+inline int BufferPool::classify(size_t bytes, size_t alignment) const {
+    if(bytes > mMaxBlockBytes || alignment > max_block_alignment)
+        return -1;
+
+    // blocks are aligned to their size, so a large alignment also bumps the size class
+    size_t wanted = bytes > alignment ? bytes : alignment;
+    int sizeClass = 0;
+    while(classBytes(sizeClass) < wanted)
+        ++sizeClass;
+    return sizeClass < mClassCount ? sizeClass : -1;
+}
+
+inline void BufferPool::grow(int sizeClass) {
+    const size_t blockBytes = classBytes(sizeClass);
+    const size_t slabBytes = blockBytes > min_slab_bytes ? blockBytes : min_slab_bytes;
+    const size_t alignment = blockBytes < max_block_alignment ? blockBytes : max_block_alignment;
+
+    mSlabs.reserve(mSlabs.size() + 1u); // so that recording the slab can't throw once it is allocated
+    char *memory = static_cast<char *>(NewDeleteResource::instance().allocate(slabBytes, alignment));
+    mSlabs.push_back(Slab{memory, slabBytes, alignment});
+
+    // thread the new blocks onto the local free list, in address order
+    for(size_t offset = slabBytes; offset >= blockBytes; offset -= blockBytes)
+        pushLocal(sizeClass, memory + offset - blockBytes);
+}
+
+inline void *BufferPool::allocate(size_t bytes, size_t alignment) {
+    // another thread allocating would corrupt the local free lists
+    cpp_buffer_assert(std::this_thread::get_id() == mOwner);
+    // counted up front, and taken back off if neither the free lists nor upstream have the memory
+    mHandedOut.store(mHandedOut.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+    try {
+        const int sizeClass = classify(bytes, alignment);
+        if(sizeClass < 0)
+            return NewDeleteResource::instance().allocate(bytes, alignment);
+
+        SizeClass &c = mClasses[sizeClass];
+        if(c.local == nullptr)
+            c.local = c.remote.exchange(nullptr, std::memory_order_acquire);
+        if(c.local == nullptr)
+            grow(sizeClass);
+
+        Node *node = c.local;
+        c.local = node->next;
+        return node;
+    } catch(...) {
+        mHandedOut.store(mHandedOut.load(std::memory_order_relaxed) - 1u, std::memory_order_relaxed);
+        throw;
+    }
+}
+
+inline void BufferPool::pushLocal(int sizeClass, void *p) {
+    SizeClass &c = mClasses[sizeClass];
+    Node *node = static_cast<Node *>(p);
+    node->next = c.local;
+    c.local = node;
+}
+
+inline void BufferPool::pushRemote(int sizeClass, void *p) {
+    SizeClass &c = mClasses[sizeClass];
+    Node *node = static_cast<Node *>(p);
+    node->next = c.remote.load(std::memory_order_relaxed);
+    while(!c.remote.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+        ;
+}
+
+inline void BufferPool::deallocate(void *p, size_t bytes, size_t alignment) {
+    const int sizeClass = classify(bytes, alignment);
+    if(sizeClass < 0)
+        NewDeleteResource::instance().deallocate(p, bytes, alignment);
+    else if(std::this_thread::get_id() == mOwner)
+        pushLocal(sizeClass, p);
+    else
+        pushRemote(sizeClass, p);
+    mReturned.fetch_add(1u, std::memory_order_relaxed);
+}
+
+template< typename T >
+void BufferPool::reserve(size_t n, size_t count) {
+    // allocating the buffers for real is the only way to learn the block size, since it includes the control block
+    std::vector<std::shared_ptr<T>> buffers;
+    buffers.reserve(count);
+    for(size_t i = 0; i < count; ++i)
+        buffers.push_back(make_shared_array<T>(n, alignof(T), *this));
+}
+
+inline void BufferPool::reset() {
+    cpp_buffer_assert(outstanding() == 0u); // buffers from the pool are still alive
+
+    for(int i = 0; i < mClassCount; ++i) {
+        mClasses[i].local = nullptr;
+        mClasses[i].remote.store(nullptr, std::memory_order_relaxed);
+    }
+    for(const Slab &slab : mSlabs)
+        NewDeleteResource::instance().deallocate(slab.memory, slab.bytes, slab.alignment);
+    mSlabs.clear();
+    mHandedOut.store(0u, std::memory_order_relaxed);
+    mReturned.store(0u, std::memory_order_relaxed);
+}
+
+inline size_t BufferPool::outstanding() const {
+    // from other threads the return of a block can be seen before it being handed out
+    const size_t returned = mReturned.load(std::memory_order_relaxed);
+    const size_t handedOut = mHandedOut.load(std::memory_order_relaxed);
+    return handedOut > returned ? handedOut - returned : 0u;
+}
+
+}// namespace CPPBuffer
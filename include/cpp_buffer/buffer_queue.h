@@ -0,0 +1,131 @@
+#pragma once
+
+#include<atomic>
+#include<cassert>
+#include<cstddef>
+#include<cstdint>
+#include<utility>
+
+#include "buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A bounded multi-producer/multi-consumer lock-free queue for handing Buffers (or anything else that is cheap to move)
+ *  between threads, after Dmitry Vyukov's sequence-numbered ring.
+ *
+ *  Every slot carries a sequence number that tells producers and consumers whose turn it is, so a push or a pop is a
+ *  single compare-and-swap on the shared position, plus a release store on the slot. Buffers are moved in and out of
+ *  the slots, which hands over the ptr_t without touching its reference count:
+ *      BufferQueue<Buffer<uint8_t>> queue(1024);
+ *      queue.try_push(std::move(packet)); // network thread
+ *      Buffer<uint8_t> packet;
+ *      if(queue.try_pop(packet)) parse(packet); // parser thread
+ *  Popping into an empty handle keeps it that way; popping into a live one releases what it held first.
+ */
+template< typename buffer_t = Buffer<uint8_t> >
+class BufferQueue
+{
+    public:
+    explicit BufferQueue(size_t capacity); // rounded up to a power of two
+
+    BufferQueue(const BufferQueue &) = delete;
+    BufferQueue &operator=(const BufferQueue &) = delete;
+
+    size_t capacity() const { return mCells.size(); }
+    size_t size() const; // a snapshot, which may already be stale when it returns
+
+    bool try_push(buffer_t &&);
+    bool try_push(const buffer_t &value) { buffer_t copy(value); return try_push(std::move(copy)); }
+    bool try_pop(buffer_t &);
+
+    private:
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        buffer_t value;
+    };
+
+    static size_t roundUpToPowerOfTwo(size_t);
+
+    alignas(64) Buffer<Cell> mCells;
+    size_t mMask;
+    alignas(64) std::atomic<size_t> mEnqueuePosition{0u};
+    alignas(64) std::atomic<size_t> mDequeuePosition{0u};
+};
+
+
+
+template< typename buffer_t >
+size_t BufferQueue<buffer_t>::roundUpToPowerOfTwo(size_t n) {
+    size_t capacity = 2u;
+    while(capacity < n)
+        capacity <<= 1;
+    return capacity;
+}
+
+template< typename buffer_t >
+BufferQueue<buffer_t>::BufferQueue(size_t capacity)
+    : mCells(roundUpToPowerOfTwo(capacity), cache_line_aligned)
+    , mMask(mCells.size() - 1u)
+{
+    for(size_t i = 0; i < mCells.size(); ++i)
+        mCells.begin()[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template< typename buffer_t >
+size_t BufferQueue<buffer_t>::size() const {
+    const size_t dequeued = mDequeuePosition.load(std::memory_order_relaxed);
+    const size_t enqueued = mEnqueuePosition.load(std::memory_order_relaxed);
+    return enqueued > dequeued ? enqueued - dequeued : 0u;
+}
+
+template< typename buffer_t >
+bool BufferQueue<buffer_t>::try_push(buffer_t &&value) {
+    size_t position = mEnqueuePosition.load(std::memory_order_relaxed);
+    for(;;) {
+        Cell &cell = mCells.begin()[position & mMask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if(difference == 0) {
+            // the slot is free for this lap, try to claim it
+            if(mEnqueuePosition.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+                cell.value = std::move(value);
+                cell.sequence.store(position + 1u, std::memory_order_release);
+                return true;
+            }
+        } else if(difference < 0) {
+            return false; // the slot still holds a value from the previous lap: the queue is full
+        } else {
+            position = mEnqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template< typename buffer_t >
+bool BufferQueue<buffer_t>::try_pop(buffer_t &value) {
+    size_t position = mDequeuePosition.load(std::memory_order_relaxed);
+    for(;;) {
+        Cell &cell = mCells.begin()[position & mMask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1u);
+
+        if(difference == 0) {
+            // the slot has been filled for this lap, try to claim it
+            if(mDequeuePosition.compare_exchange_weak(position, position + 1u, std::memory_order_relaxed)) {
+                value = std::move(cell.value);
+                cell.sequence.store(position + mMask + 1u, std::memory_order_release);
+                return true;
+            }
+        } else if(difference < 0) {
+            return false; // nothing has been pushed into this slot yet: the queue is empty
+        } else {
+            position = mDequeuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,410 @@
+#pragma once
+
+#include<array>
+#include<cstddef>
+#include<cstdint>
+#include<type_traits>
+#include<utility>
+
+#if __cplusplus >= 202002L && __has_include(<span>)
+  #include<ranges>
+  #include<span>
+  #define CPPBUFFER_HAS_SPAN 1
+#else
+  #define CPPBUFFER_HAS_SPAN 0
+#endif
+
+#if __cplusplus > 202002L && __has_include(<mdspan>)
+  #include<mdspan>
+#endif
+#if defined(__cpp_lib_mdspan)
+  #define CPPBUFFER_HAS_MDSPAN 1
+#else
+  #define CPPBUFFER_HAS_MDSPAN 0
+#endif
+
+#include "buffer_assert.h"
+#include "buffer_iterator.h"
+#include "checked_view.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A view of the elements of a Buffer or Slice that doesn't own them: a pointer to the first element, a count and a
+ *  stride. Passing a Buffer by value copies its shared_ptr, which is an atomic increment and decrement per call.
+ *  Functions that only work on the elements can take a view instead, and every Buffer and Slice converts to one:
+ *      float mean(BufferView<const float> samples) {
+ *          return std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size();
+ *      }
+ *      mean(buffer);            // no reference counting, no copy
+ *      mean(buffer.slice(0, 8));
+ *
+ *  A SliceView<T, s> takes anything that iterates with stride s, and a SliceView<T, dynamic_stride> anything at all,
+ *  the same way Slice<T, dynamic_stride> does. Views of T convert to views of const T. Views keep the bounds checks of
+ *  what they were made from: operator[], slice() and checked() are checked, indexing into checked() is not.
+ *
+ *  Like std::span, and unlike Buffer, a view is shallow: a const view still hands out mutable elements, and it is only
+ *  valid for as long as whatever owns the memory keeps it alive. Keep a Buffer where the elements need to be kept.
+ *
+ *  With C++20 unit-stride views convert to and from std::span, and with C++23 any view converts to std::mdspan, see
+ *  as_span() and as_mdspan() below.
+ */
+template< typename T, const uint8_t stride = 1u >
+class SliceView;
+
+template< typename T >
+using BufferView = SliceView<T, 1u>;
+
+
+namespace detail
+{
+
+// Raw memory and compile-time stride behind the iterators Buffer and Slice hand out
+template< typename iterator_t >
+struct strided_memory;
+
+template< typename T >
+struct strided_memory<T *>
+{
+    static constexpr size_t stride = 1u;
+    static constexpr T *data(T *it) { return it; }
+};
+
+template< typename T, uint8_t s >
+struct strided_memory<BufferIterator<T, s>>
+{
+    static constexpr size_t stride = s;
+    static constexpr T *data(const BufferIterator<T, s> &it) { return it.base() + it.index() * s; }
+};
+
+template< typename T >
+struct strided_memory<BufferIterator<T, dynamic_stride>>
+{
+    static constexpr size_t stride = dynamic_stride;
+    static constexpr T *data(const BufferIterator<T, dynamic_stride> &it) {
+        return it.base() + it.index() * it.stride();
+    }
+};
+
+template< typename view_t >
+constexpr auto memory_of(view_t &view) -> decltype(strided_memory<decltype(view.begin())>::data(view.begin())) {
+    return strided_memory<decltype(view.begin())>::data(view.begin());
+}
+
+template< typename view_t >
+constexpr size_t stride_of() {
+    return strided_memory<decltype(std::declval<view_t &>().begin())>::stride;
+}
+
+// the stride of a view in elements, also when it is a dynamic_stride
+template< typename view_t >
+constexpr size_t stride_at(const view_t &view) {
+    if constexpr(stride_of<const view_t>() == dynamic_stride)
+        return view.stride();
+    else
+        return stride_of<const view_t>();
+}
+
+// whether a SliceView<T, stride> can be made from a view_t: its elements have to be T or a less qualified T, and its
+// stride the same unless the SliceView has a dynamic_stride
+template< typename view_t, typename T, size_t stride, typename = void >
+struct is_viewable : std::false_type {};
+
+template< typename view_t, typename T, size_t stride >
+struct is_viewable<view_t, T, stride,
+    std::void_t<decltype(memory_of(std::declval<view_t &>())), decltype(std::declval<view_t &>().size())>>
+    : std::integral_constant<bool,
+        std::is_convertible<std::remove_pointer_t<decltype(memory_of(std::declval<view_t &>()))> (*)[], T (*)[]>::value
+        && (stride == dynamic_stride || stride_of<view_t>() == stride)>
+{};
+
+}// namespace detail
+
+
+template< typename T, const uint8_t stride >
+class SliceView
+{
+    public:
+    //typedefs
+    typedef typename StridedIterator<T, stride>::type Iterator;
+
+    constexpr SliceView() = default;
+    // element i of the view is first[i * stride]
+    constexpr SliceView(T *first, size_t count);
+    // any Buffer, Slice or view with the same stride
+    template< typename view_t, typename = std::enable_if_t<detail::is_viewable<view_t, T, stride>::value> >
+    constexpr SliceView(view_t &&view);
+#if CPPBUFFER_HAS_SPAN
+    template< typename U, size_t extent,
+        typename = std::enable_if_t<stride == 1u && std::is_convertible<U (*)[], T (*)[]>::value> >
+    constexpr SliceView(std::span<U, extent> span);
+#endif
+
+    // accessors
+    constexpr T &operator[](int) const;
+
+    // iterators
+    constexpr Iterator begin() const;
+    constexpr Iterator end() const;
+
+    constexpr size_t size() const { return mCount; }
+
+    // checks [begin, end) of the view once, and returns a view of it with unchecked access
+    constexpr CheckedView<T, stride> checked(size_t begin, size_t end) const;
+    constexpr CheckedView<T, stride> checked() const;
+
+    // slices of views are relative to this view, and their strides compound
+    template< uint8_t s = 1u >
+    constexpr SliceView<T, stride * s> slice(size_t begin, size_t end) const;
+    template< uint8_t s = 1u >
+    constexpr SliceView<T, stride * s> slice() const;
+    constexpr SliceView<T, dynamic_stride> slice(size_t begin, size_t end, size_t s) const;
+
+    private:
+    T *mFirst = nullptr;
+    size_t mCount = 0ul;
+};
+
+
+/** The view of a runtime stride, which every other view, Buffer and Slice converts to */
+template< typename T >
+class SliceView<T, dynamic_stride>
+{
+    public:
+    //typedefs
+    typedef typename StridedIterator<T, dynamic_stride>::type Iterator;
+
+    constexpr SliceView() = default;
+    // element i of the view is first[i * stride]
+    constexpr SliceView(T *first, size_t count, size_t stride);
+    template< typename view_t, typename = std::enable_if_t<detail::is_viewable<view_t, T, dynamic_stride>::value> >
+    constexpr SliceView(view_t &&view);
+
+    // accessors
+    constexpr T &operator[](int) const;
+
+    // iterators
+    constexpr Iterator begin() const;
+    constexpr Iterator end() const;
+
+    constexpr size_t size() const { return mCount; }
+    constexpr size_t stride() const { return mStride; }
+
+    // checks [begin, end) of the view once, and returns a view of it with unchecked access
+    constexpr CheckedView<T, dynamic_stride> checked(size_t begin, size_t end) const;
+    constexpr CheckedView<T, dynamic_stride> checked() const;
+
+    // slices of views are relative to this view, and their strides compound
+    template< uint8_t s = 1u >
+    constexpr SliceView slice(size_t begin, size_t end) const;
+    template< uint8_t s = 1u >
+    constexpr SliceView slice() const;
+    constexpr SliceView slice(size_t begin, size_t end, size_t s) const;
+
+    private:
+    T *mFirst = nullptr;
+    size_t mCount = 0ul;
+    size_t mStride = 1ul;
+};
+
+// a view is only ever its pointer and count, so passing one by value is as cheap as passing a pointer
+static_assert(sizeof(SliceView<float, 2u>) == sizeof(float *) + sizeof(size_t),
+    "SliceView must be a pointer and a count");
+static_assert(std::is_trivially_copyable<SliceView<float, 2u>>::value, "SliceView must be trivially copyable");
+static_assert(std::is_trivially_copyable<SliceView<float, dynamic_stride>>::value,
+    "SliceView must be trivially copyable");
+
+
+#if CPPBUFFER_HAS_SPAN
+/** The std::span of the elements of a unit-stride Buffer, Slice or view */
+template< typename view_t >
+constexpr auto as_span(view_t &&view);
+#endif
+
+#if CPPBUFFER_HAS_MDSPAN
+/** A one-dimensional std::mdspan of the elements of any Buffer, Slice or view, with a layout_stride of its stride */
+template< typename view_t >
+constexpr auto as_mdspan(view_t &&view);
+
+/**
+ *  A row-major rows x columns std::mdspan of the elements of a unit-stride Buffer, Slice or view. The view has to
+ *  have at least rows * columns elements.
+ */
+template< typename view_t >
+constexpr auto as_mdspan(view_t &&view, size_t rows, size_t columns);
+#endif
+
+
+
+template< typename T, const uint8_t stride >
+constexpr SliceView<T, stride>::SliceView(T *first, size_t count)
+    : mFirst(first)
+    , mCount(count)
+{}
+
+template< typename T, const uint8_t stride >
+template< typename view_t, typename >
+constexpr SliceView<T, stride>::SliceView(view_t &&view)
+    : mFirst(detail::memory_of(view))
+    , mCount(view.size())
+{}
+
+#if CPPBUFFER_HAS_SPAN
+template< typename T, const uint8_t stride >
+template< typename U, size_t extent, typename >
+constexpr SliceView<T, stride>::SliceView(std::span<U, extent> span)
+    : mFirst(span.data())
+    , mCount(span.size())
+{}
+#endif
+
+template< typename T, const uint8_t stride >
+constexpr T &SliceView<T, stride>::operator[](int i) const {
+    cpp_buffer_assert(static_cast<size_t>(i) < mCount);
+    return mFirst[static_cast<size_t>(i) * stride];
+}
+
+template< typename T, const uint8_t stride >
+constexpr typename SliceView<T, stride>::Iterator SliceView<T, stride>::begin() const {
+    return StridedIterator<T, stride>::make(mFirst, 0ul);
+}
+
+template< typename T, const uint8_t stride >
+constexpr typename SliceView<T, stride>::Iterator SliceView<T, stride>::end() const {
+    return StridedIterator<T, stride>::make(mFirst, mCount);
+}
+
+template< typename T, const uint8_t stride >
+constexpr CheckedView<T, stride> SliceView<T, stride>::checked(size_t begin, size_t end) const {
+    cpp_buffer_assert(begin <= end && end <= mCount);
+    return CheckedView<T, stride>(mFirst + begin * stride, end - begin);
+}
+
+template< typename T, const uint8_t stride >
+constexpr CheckedView<T, stride> SliceView<T, stride>::checked() const {
+    return CheckedView<T, stride>(mFirst, mCount);
+}
+
+template< typename T, const uint8_t stride >
+template< uint8_t s >
+constexpr SliceView<T, stride * s> SliceView<T, stride>::slice(size_t begin, size_t end) const {
+    static_assert(static_cast<unsigned>(stride) * s <= 255u, "compound slice stride does not fit in a uint8_t");
+    cpp_buffer_assert(begin <= end && end <= mCount);
+    return SliceView<T, stride * s>(mFirst + begin * stride, begin < end ? (end - begin + s - 1u) / s : 0ul);
+}
+
+template< typename T, const uint8_t stride >
+template< uint8_t s >
+constexpr SliceView<T, stride * s> SliceView<T, stride>::slice() const {
+    return slice<s>(0ul, mCount);
+}
+
+template< typename T, const uint8_t stride >
+constexpr SliceView<T, dynamic_stride> SliceView<T, stride>::slice(size_t begin, size_t end, size_t s) const {
+    cpp_buffer_assert(s > 0u && begin <= end && end <= mCount);
+    return SliceView<T, dynamic_stride>(mFirst + begin * stride, begin < end ? (end - begin + s - 1u) / s : 0ul,
+        s * stride);
+}
+
+
+template< typename T >
+constexpr SliceView<T, dynamic_stride>::SliceView(T *first, size_t count, size_t stride)
+    : mFirst(first)
+    , mCount(count)
+    , mStride(stride)
+{}
+
+template< typename T >
+template< typename view_t, typename >
+constexpr SliceView<T, dynamic_stride>::SliceView(view_t &&view)
+    : mFirst(detail::memory_of(view))
+    , mCount(view.size())
+    , mStride(detail::stride_at(view))
+{}
+
+template< typename T >
+constexpr T &SliceView<T, dynamic_stride>::operator[](int i) const {
+    cpp_buffer_assert(static_cast<size_t>(i) < mCount);
+    return mFirst[static_cast<size_t>(i) * mStride];
+}
+
+template< typename T >
+constexpr typename SliceView<T, dynamic_stride>::Iterator SliceView<T, dynamic_stride>::begin() const {
+    return StridedIterator<T, dynamic_stride>::make(mFirst, 0ul, mStride);
+}
+
+template< typename T >
+constexpr typename SliceView<T, dynamic_stride>::Iterator SliceView<T, dynamic_stride>::end() const {
+    return StridedIterator<T, dynamic_stride>::make(mFirst, mCount, mStride);
+}
+
+template< typename T >
+constexpr CheckedView<T, dynamic_stride> SliceView<T, dynamic_stride>::checked(size_t begin, size_t end) const {
+    cpp_buffer_assert(begin <= end && end <= mCount);
+    return CheckedView<T, dynamic_stride>(mFirst + begin * mStride, end - begin, mStride);
+}
+
+template< typename T >
+constexpr CheckedView<T, dynamic_stride> SliceView<T, dynamic_stride>::checked() const {
+    return CheckedView<T, dynamic_stride>(mFirst, mCount, mStride);
+}
+
+template< typename T >
+template< uint8_t s >
+constexpr SliceView<T, dynamic_stride> SliceView<T, dynamic_stride>::slice(size_t begin, size_t end) const {
+    return slice(begin, end, s);
+}
+
+template< typename T >
+template< uint8_t s >
+constexpr SliceView<T, dynamic_stride> SliceView<T, dynamic_stride>::slice() const {
+    return slice(0ul, mCount, s);
+}
+
+template< typename T >
+constexpr SliceView<T, dynamic_stride> SliceView<T, dynamic_stride>::slice(size_t begin, size_t end, size_t s) const {
+    cpp_buffer_assert(s > 0u && begin <= end && end <= mCount);
+    return SliceView(mFirst + begin * mStride, begin < end ? (end - begin + s - 1u) / s : 0ul, s * mStride);
+}
+
+
+#if CPPBUFFER_HAS_SPAN
+template< typename view_t >
+constexpr auto as_span(view_t &&view) {
+    static_assert(detail::stride_of<view_t>() == 1u, "only unit-stride views are contiguous, use as_mdspan instead");
+    typedef std::remove_pointer_t<decltype(detail::memory_of(view))> element_t;
+    return std::span<element_t>(detail::memory_of(view), view.size());
+}
+#endif
+
+#if CPPBUFFER_HAS_MDSPAN
+template< typename view_t >
+constexpr auto as_mdspan(view_t &&view) {
+    typedef std::remove_pointer_t<decltype(detail::memory_of(view))> element_t;
+    typedef std::dextents<size_t, 1u> extents_t;
+    const std::array<size_t, 1u> strides{detail::stride_at(view)};
+    return std::mdspan<element_t, extents_t, std::layout_stride>(detail::memory_of(view),
+        std::layout_stride::mapping<extents_t>(extents_t(view.size()), strides));
+}
+
+template< typename view_t >
+constexpr auto as_mdspan(view_t &&view, size_t rows, size_t columns) {
+    static_assert(detail::stride_of<view_t>() == 1u, "only unit-stride views can be reshaped");
+    cpp_buffer_assert(rows * columns <= view.size());
+    typedef std::remove_pointer_t<decltype(detail::memory_of(view))> element_t;
+    return std::mdspan<element_t, std::dextents<size_t, 2u>>(detail::memory_of(view), rows, columns);
+}
+#endif
+
+}// namespace CPPBuffer
+
+#if CPPBUFFER_HAS_SPAN
+// views don't own their elements, so ranges may hold on to iterators of temporary ones, like they do for std::span
+namespace std::ranges
+{
+template< typename T, const uint8_t stride >
+inline constexpr bool enable_borrowed_range<CPPBuffer::SliceView<T, stride>> = true;
+}
+#endif
@@ -0,0 +1,84 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+
+#include "buffer_iterator.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A range of a Buffer or Slice whose bounds have already been checked. Buffer::checked() and Slice::checked()
+ *  validate a whole [begin, end) window once, and indexing into the view they return is then unchecked, so a tight
+ *  loop over it has no branch per element:
+ *      auto window = buffer.checked(begin, end); // fails here if the window is out of range
+ *      for(size_t i = 0; i < window.size(); ++i)
+ *          acc += window[i];
+ *
+ *  Indices into the view are relative to its begin, and are not checked again: stay below size(). The view does not
+ *  own anything, so it is only valid as long as the memory it was made from.
+ */
+template< typename T, const uint8_t stride = 1u >
+class CheckedView
+{
+    public:
+    //typedefs
+    typedef typename StridedIterator<T, stride>::type Iterator;
+
+    CheckedView() = default;
+    // element i of the view is base[i * stride]. Whoever makes a view proves that all of them are in range.
+    CheckedView(T *base, size_t count)
+        : mBase(base)
+        , mCount(count)
+    {}
+
+    // unchecked accessors
+    T &operator[](size_t i) const { return mBase[i * stride]; }
+
+    // iterators
+    Iterator begin() const { return StridedIterator<T, stride>::make(mBase, 0ul); }
+    Iterator end() const { return StridedIterator<T, stride>::make(mBase, mCount); }
+
+    size_t size() const { return mCount; }
+
+    private:
+    T *mBase = nullptr;
+    size_t mCount = 0ul;
+};
+
+
+/** The same, over a Slice or SliceView whose stride is a runtime value */
+template< typename T >
+class CheckedView<T, dynamic_stride>
+{
+    public:
+    //typedefs
+    typedef typename StridedIterator<T, dynamic_stride>::type Iterator;
+
+    CheckedView() = default;
+    // element i of the view is base[i * stride]
+    CheckedView(T *base, size_t count, size_t stride)
+        : mBase(base)
+        , mCount(count)
+        , mStride(stride)
+    {}
+
+    // unchecked accessors
+    T &operator[](size_t i) const { return mBase[i * mStride]; }
+
+    // iterators
+    Iterator begin() const { return StridedIterator<T, dynamic_stride>::make(mBase, 0ul, mStride); }
+    Iterator end() const { return StridedIterator<T, dynamic_stride>::make(mBase, mCount, mStride); }
+
+    size_t size() const { return mCount; }
+    size_t stride() const { return mStride; }
+
+    private:
+    T *mBase = nullptr;
+    size_t mCount = 0ul;
+    size_t mStride = 1ul;
+};
+
+}// namespace CPPBuffer
@@ -0,0 +1,162 @@
+#pragma once
+
+#include<atomic>
+#include<cstddef>
+#include<memory>
+#include<utility>
+
+#include "buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A copy-on-write Buffer. Copies share the memory like Buffer copies do, but the first write through a copy that
+ *  isn't the only owner clones the elements first, so writers never change what the other copies see:
+ *      CowBuffer<float> samples(n);
+ *      plugin.process(samples);    // takes a copy, no elements are copied unless the plugin writes to it
+ *      samples[0] = 1.0f;          // only copies if the plugin kept its copy
+ *
+ *  Reads go through the const overloads, and never copy. Everything that can write - the non-const operator[],
+ *  begin(), end() and checked() - detaches first, so take a const reference for loops that only read. Don't keep
+ *  writing through a pointer or view from the non-const overloads after copying the buffer: the copy would see it.
+ *
+ *  Clones are allocated from NewDeleteResource, whatever the original was allocated with, and copy-construct their
+ *  elements, so T only has to be copyable.
+ *
+ *  Like Buffer, a CowBuffer copy can be handed to another thread. The owner count is only a hint while other threads
+ *  drop their copies, which at worst makes a write clone a buffer that would just have become unshared. A write that
+ *  finds itself the only owner fences first, so it can't overtake the reads other threads made before letting go. A
+ *  single CowBuffer object still must not be used from two threads at once.
+ */
+template< typename T, typename ptr_t = std::shared_ptr<T> >
+class CowBuffer
+{
+    public:
+    //typedefs
+    typedef T*                      Iterator;
+    typedef const T *               ConstIterator;
+    typedef Buffer<T, 1u, ptr_t>    Storage;
+
+    CowBuffer() = default;
+    explicit CowBuffer(size_t); // value-initialized
+    CowBuffer(size_t, uninitialized_t);
+    // shares the memory of a Buffer, which the CowBuffer then treats as one more copy: it clones before writing
+    explicit CowBuffer(const Storage &);
+
+    // accessors. The non-const one detaches
+    T &operator[](int);
+    const T &operator[](int) const;
+
+    // iterators, likewise
+    Iterator begin();
+    Iterator end();
+    ConstIterator begin() const;
+    ConstIterator end() const;
+
+    size_t size() const { return mBuffer.size(); }
+    bool is_shared() const { return mBuffer.use_count() > 1; }
+
+    // makes this the only owner of its memory, cloning it if it has to. Writes do this on their own.
+    void detach();
+
+    // checks [begin, end) once, and returns a view of it with unchecked access
+    CheckedView<T> checked(size_t begin, size_t end);
+    CheckedView<const T> checked(size_t begin, size_t end) const;
+    CheckedView<T> checked();
+    CheckedView<const T> checked() const;
+
+    private:
+    Storage mBuffer;
+};
+
+
+
+template< typename T, typename ptr_t >
+CowBuffer<T, ptr_t>::CowBuffer(size_t n)
+    : mBuffer(n)
+{}
+
+template< typename T, typename ptr_t >
+CowBuffer<T, ptr_t>::CowBuffer(size_t n, uninitialized_t tag)
+    : mBuffer(n, tag)
+{}
+
+template< typename T, typename ptr_t >
+CowBuffer<T, ptr_t>::CowBuffer(const Storage &buffer)
+    : mBuffer(buffer)
+{}
+
+template< typename T, typename ptr_t >
+void CowBuffer<T, ptr_t>::detach() {
+    if(!is_shared()) {
+        // the count is a relaxed load: order the writes after whatever the owners that just let go did before that
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return;
+    }
+
+    const Storage &shared = mBuffer;
+    Storage clone(PointerAllocation<ptr_t>::make(shared.size(), alignof(T), NewDeleteResource::instance(),
+        detail::copied_from<T>{shared.begin()}), shared.size());
+    mBuffer = std::move(clone);
+}
+
+template< typename T, typename ptr_t >
+T &CowBuffer<T, ptr_t>::operator[](int i) {
+    cpp_buffer_assert(static_cast<size_t>(i) < mBuffer.size());
+    detach();
+    return mBuffer.begin()[i];
+}
+
+template< typename T, typename ptr_t >
+const T &CowBuffer<T, ptr_t>::operator[](int i) const {
+    return mBuffer[i];
+}
+
+template< typename T, typename ptr_t >
+typename CowBuffer<T, ptr_t>::Iterator CowBuffer<T, ptr_t>::begin() {
+    detach();
+    return mBuffer.begin();
+}
+
+template< typename T, typename ptr_t >
+typename CowBuffer<T, ptr_t>::Iterator CowBuffer<T, ptr_t>::end() {
+    detach();
+    return mBuffer.end();
+}
+
+template< typename T, typename ptr_t >
+typename CowBuffer<T, ptr_t>::ConstIterator CowBuffer<T, ptr_t>::begin() const {
+    return mBuffer.begin();
+}
+
+template< typename T, typename ptr_t >
+typename CowBuffer<T, ptr_t>::ConstIterator CowBuffer<T, ptr_t>::end() const {
+    return mBuffer.end();
+}
+
+template< typename T, typename ptr_t >
+CheckedView<T> CowBuffer<T, ptr_t>::checked(size_t begin, size_t end) {
+    cpp_buffer_assert(begin <= end && end <= mBuffer.size());
+    detach();
+    return mBuffer.checked(begin, end);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<const T> CowBuffer<T, ptr_t>::checked(size_t begin, size_t end) const {
+    return mBuffer.checked(begin, end);
+}
+
+template< typename T, typename ptr_t >
+CheckedView<T> CowBuffer<T, ptr_t>::checked() {
+    detach();
+    return mBuffer.checked();
+}
+
+template< typename T, typename ptr_t >
+CheckedView<const T> CowBuffer<T, ptr_t>::checked() const {
+    return mBuffer.checked();
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,265 @@
+#pragma once
+
+#include<cstddef>
+#include<type_traits>
+#include<utility>
+
+#include "algorithms.h"
+#include "buffer.h"
+
+
+/**
+ *  Element-wise arithmetic on Buffers and Slices, without temporaries. The operators build an expression tree, and
+ *  assigning it to a Buffer or Slice evaluates the whole tree in a single loop over the destination:
+ *      out = a * gain + b * (1.0f - gain); // one pass, reading a and b and writing out, and no allocations
+ *
+ *  +, -, * and / take any mix of Buffers, Slices, expressions and scalars, and unary - negates. Scalars are converted
+ *  to the element type of the other operand, so a float buffer times a double is still computed in float. Operands
+ *  have to be the same size. Each operand keeps its own stride, and the evaluation loop goes through the same SIMD
+ *  dispatch as the algorithms, so the fused loop vectorizes wherever the strides allow. The loop needs runtime alias
+ *  checks between the destination and the operands, which GCC only emits from -O3 on.
+ *
+ *  Expressions point at the memory of their operands without owning it, the same as iterators do: evaluate them in
+ *  the statement that builds them, or at least while every operand is alive. Reading the destination is fine as long
+ *  as it is read at the same index that is being written, like in out = out * 0.5f + a.
+ *
+ *  evaluate(expression) evaluates into a new Buffer, for when there is no destination yet.
+ */
+
+namespace CPPBuffer
+{
+
+/** The base of every expression node, so that operators and assignments can recognize them */
+template< typename expr_t >
+struct Expression
+{
+    const expr_t &self() const { return static_cast<const expr_t &>(*this); }
+};
+
+
+namespace detail
+{
+
+// a Buffer or Slice in an expression: its memory, stride and size
+template< typename T, size_t stride >
+struct TerminalExpression : Expression<TerminalExpression<T, stride>>
+{
+    typedef T value_type;
+
+    const T *data;
+    size_t count;
+    size_t runtimeStride;
+
+    CPPBUFFER_FORCE_INLINE T at(size_t i) const {
+        return data[i * (stride != dynamic_stride ? stride : runtimeStride)];
+    }
+    size_t size() const { return count; }
+};
+
+template< typename T >
+struct ScalarExpression : Expression<ScalarExpression<T>>
+{
+    typedef T value_type;
+
+    T value;
+
+    CPPBUFFER_FORCE_INLINE T at(size_t) const { return value; }
+};
+
+template< typename op_t, typename expr_t >
+struct UnaryExpression : Expression<UnaryExpression<op_t, expr_t>>
+{
+    typedef decltype(op_t::apply(std::declval<typename expr_t::value_type>())) value_type;
+
+    expr_t operand;
+
+    CPPBUFFER_FORCE_INLINE value_type at(size_t i) const { return op_t::apply(operand.at(i)); }
+    size_t size() const { return operand.size(); }
+};
+
+template< typename op_t, typename left_t, typename right_t >
+struct BinaryExpression : Expression<BinaryExpression<op_t, left_t, right_t>>
+{
+    typedef decltype(op_t::apply(std::declval<typename left_t::value_type>(),
+        std::declval<typename right_t::value_type>())) value_type;
+
+    left_t left;
+    right_t right;
+
+    CPPBUFFER_FORCE_INLINE value_type at(size_t i) const { return op_t::apply(left.at(i), right.at(i)); }
+    // scalars have no size, and adapt to the other side
+    size_t size() const {
+        if constexpr(std::is_same<left_t, ScalarExpression<typename left_t::value_type>>::value)
+            return right.size();
+        else
+            return left.size();
+    }
+};
+
+struct Negate
+{
+    template< typename a_t >
+    static CPPBUFFER_FORCE_INLINE auto apply(a_t a) { return -a; }
+};
+
+#define CPPBUFFER_EXPRESSION_OP(name, symbol) \
+    struct name \
+    { \
+        template< typename a_t, typename b_t > \
+        static CPPBUFFER_FORCE_INLINE auto apply(a_t a, b_t b) { return a symbol b; } \
+    };
+
+CPPBUFFER_EXPRESSION_OP(Plus, +)
+CPPBUFFER_EXPRESSION_OP(Minus, -)
+CPPBUFFER_EXPRESSION_OP(Multiply, *)
+CPPBUFFER_EXPRESSION_OP(Divide, /)
+
+#undef CPPBUFFER_EXPRESSION_OP
+
+
+// what can be an operand: expressions as they are, and Buffers and Slices as terminals
+template< typename operand_t, typename = void >
+struct operand_traits {};
+
+template< typename expr_t >
+struct operand_traits<expr_t, typename std::enable_if<std::is_base_of<Expression<expr_t>, expr_t>::value>::type>
+{
+    typedef expr_t expression_t;
+    typedef typename expr_t::value_type value_type;
+
+    static const expr_t &make(const expr_t &e) { return e; }
+};
+
+template< typename view_t >
+struct view_operand_traits
+{
+    typedef typename std::remove_const<element_t<const view_t>>::type value_type;
+    typedef TerminalExpression<value_type, stride_of<const view_t>()> expression_t;
+
+    static expression_t make(const view_t &view) {
+        expression_t e;
+        e.data = memory_of(view);
+        e.count = view.size();
+        e.runtimeStride = stride_at(view);
+        return e;
+    }
+};
+
+template< typename T, typename ptr_t >
+struct operand_traits<Buffer<T, 1u, ptr_t>> : view_operand_traits<Buffer<T, 1u, ptr_t>> {};
+
+template< typename T, uint8_t s, typename ptr_t >
+struct operand_traits<Slice<T, s, ptr_t>> : view_operand_traits<Slice<T, s, ptr_t>> {};
+
+template< typename operand_t >
+using expression_of = typename operand_traits<operand_t>::expression_t;
+
+template< typename operand_t >
+using value_of = typename operand_traits<operand_t>::value_type;
+
+// a scalar next to operand_t, in its element type
+template< typename operand_t >
+using scalar_of = ScalarExpression<value_of<operand_t>>;
+
+template< typename operand_t >
+scalar_of<operand_t> scalar_for(const value_of<operand_t> &value) {
+    scalar_of<operand_t> e;
+    e.value = value;
+    return e;
+}
+
+template< typename op_t, typename left_t, typename right_t >
+BinaryExpression<op_t, left_t, right_t> combine(const left_t &left, const right_t &right) {
+    cpp_buffer_assert(left.size() == right.size());
+    return {{}, left, right};
+}
+
+// The evaluation loop. Expressions are passed by value, which is a few pointers and sizes.
+template< size_t dstStride, typename T, typename expr_t >
+struct AssignKernel
+{
+    static CPPBUFFER_FORCE_INLINE void run(T *dst, expr_t e, size_t n, size_t runtimeStride) {
+        const size_t step = dstStride != dynamic_stride ? dstStride : runtimeStride;
+        for(size_t i = 0; i < n; ++i)
+            dst[i * step] = static_cast<T>(e.at(i));
+    }
+};
+
+// evaluates e into the elements of dst
+template< typename view_t, typename expr_t >
+void assign(view_t &dst, const expr_t &e) {
+    typedef typename std::remove_const<element_t<view_t>>::type T;
+    cpp_buffer_assert(e.size() == dst.size());
+    const size_t s = stride_at(dst);
+    with_stride<stride_of<view_t>()>(s, [&](auto stride) {
+        dispatch<AssignKernel<decltype(stride)::value, T, expr_t>>(memory_of(dst), e, dst.size(), s);
+    });
+}
+
+}// namespace detail
+
+
+// the operators, for operands on either side, and scalars on one of them
+#define CPPBUFFER_EXPRESSION_OPERATOR(symbol, op_t) \
+    template< typename left_t, typename right_t > \
+    detail::BinaryExpression<op_t, detail::expression_of<left_t>, detail::expression_of<right_t>> \
+    operator symbol(const left_t &left, const right_t &right) { \
+        return detail::combine<op_t>(detail::operand_traits<left_t>::make(left), \
+            detail::operand_traits<right_t>::make(right)); \
+    } \
+    template< typename left_t > \
+    detail::BinaryExpression<op_t, detail::expression_of<left_t>, detail::scalar_of<left_t>> \
+    operator symbol(const left_t &left, const detail::value_of<left_t> &right) { \
+        return {{}, detail::operand_traits<left_t>::make(left), detail::scalar_for<left_t>(right)}; \
+    } \
+    template< typename right_t > \
+    detail::BinaryExpression<op_t, detail::scalar_of<right_t>, detail::expression_of<right_t>> \
+    operator symbol(const detail::value_of<right_t> &left, const right_t &right) { \
+        return {{}, detail::scalar_for<right_t>(left), detail::operand_traits<right_t>::make(right)}; \
+    }
+
+CPPBUFFER_EXPRESSION_OPERATOR(+, detail::Plus)
+CPPBUFFER_EXPRESSION_OPERATOR(-, detail::Minus)
+CPPBUFFER_EXPRESSION_OPERATOR(*, detail::Multiply)
+CPPBUFFER_EXPRESSION_OPERATOR(/, detail::Divide)
+
+#undef CPPBUFFER_EXPRESSION_OPERATOR
+
+template< typename operand_t >
+detail::UnaryExpression<detail::Negate, detail::expression_of<operand_t>> operator-(const operand_t &operand) {
+    return {{}, detail::operand_traits<operand_t>::make(operand)};
+}
+
+/** Evaluates an expression into a new Buffer of its element type */
+template< typename expr_t >
+Buffer<typename expr_t::value_type> evaluate(const Expression<expr_t> &e) {
+    Buffer<typename expr_t::value_type> result(e.self().size());
+    detail::assign(result, e.self());
+    return result;
+}
+
+
+
+// the assignments declared in buffer.h
+template< typename T, typename ptr_t >
+template< typename expr_t >
+Buffer<T, 1u, ptr_t> &Buffer<T, 1u, ptr_t>::operator=(const Expression<expr_t> &e) {
+    detail::assign(*this, e.self());
+    return *this;
+}
+
+template< typename T, const uint8_t stride, typename ptr_t >
+template< typename expr_t >
+Slice<T, stride, ptr_t> &Slice<T, stride, ptr_t>::operator=(const Expression<expr_t> &e) {
+    detail::assign(*this, e.self());
+    return *this;
+}
+
+template< typename T, typename ptr_t >
+template< typename expr_t >
+Slice<T, dynamic_stride, ptr_t> &Slice<T, dynamic_stride, ptr_t>::operator=(const Expression<expr_t> &e) {
+    detail::assign(*this, e.self());
+    return *this;
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,288 @@
+#pragma once
+
+#include "buffer_definitions.h"
+
+
+/**
+ *  Counters for what the library does at runtime, compiled in with CPPBUFFER_INSTRUMENTATION=1 and gone otherwise:
+ *  every hook below expands to nothing unless it is set, and the statistics API only exists when it is.
+ *
+ *  What is counted:
+ *      - every array allocation behind the allocating Buffer and SoABuffer constructors, and every deallocation, with
+ *        its bytes as the resource saw them (the elements plus the control block), from any resource
+ *      - failed cpp_buffer_assert checks, as far as they go through assert_hook, so not with
+ *        CPPBUFFER_ASSERT_USES_CASSERT. cpp_buffer_impl has to be built with the same setting for that.
+ *      - allocations per site, for the allocations made while a CPPBUFFER_ALLOCATION_SITE is in scope:
+ *            void decode(const Packet &packet) {
+ *                CPPBUFFER_ALLOCATION_SITE("decode");
+ *                Buffer<float> samples(packet.count()); // counted under "decode"
+ *
+ *  Each thread counts into counters of its own, so counting is a load and a store to a line no other thread writes.
+ *  statistics() adds up every thread's counters, and those of the threads that have exited, into a snapshot.
+ *  Snapshots are consistent per counter, not across counters: a snapshot taken while other threads allocate may
+ *  count an allocation without yet counting its bytes.
+ *
+ *  Up to max_sites - 1 sites get their own counters. Sites past that, and allocations made outside any site, are
+ *  counted under "(unattributed)". Site names have to outlive the program, so pass string literals.
+ */
+#if CPPBUFFER_INSTRUMENTATION
+
+#include<algorithm>
+#include<atomic>
+#include<cstddef>
+#include<cstdint>
+#include<mutex>
+#include<vector>
+
+namespace CPPBuffer
+{
+namespace instrumentation
+{
+
+inline constexpr size_t max_sites = 64u;
+
+struct SiteStatistics
+{
+    const char *name;
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t largest;   // the biggest single allocation, in bytes
+};
+
+struct Statistics
+{
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t allocatedBytes;    // over the lifetime of the program
+    uint64_t freedBytes;
+    uint64_t assertFailures;
+    std::vector<SiteStatistics> sites; // the sites that allocated anything, unattributed first, then in order of entry
+
+    int64_t liveAllocations() const { return static_cast<int64_t>(allocations - deallocations); }
+    int64_t liveBytes() const { return static_cast<int64_t>(allocatedBytes - freedBytes); }
+};
+
+/** A snapshot of the counters of every thread */
+inline Statistics statistics();
+
+/** A named place in the code that allocations get attributed to. CPPBUFFER_ALLOCATION_SITE makes one per use. */
+class Site
+{
+    public:
+    explicit Site(const char *name);
+
+    size_t id() const { return mId; }
+
+    private:
+    size_t mId;
+};
+
+/** Attributes the allocations of this thread to a site while it is alive, and restores the previous site after */
+class SiteScope
+{
+    public:
+    explicit SiteScope(const Site &);
+    ~SiteScope();
+
+    SiteScope(const SiteScope &) = delete;
+    SiteScope &operator=(const SiteScope &) = delete;
+
+    private:
+    size_t mPrevious;
+};
+
+
+namespace detail
+{
+
+// Only its own thread writes a counter, so it doesn't need a read-modify-write. It is atomic for statistics() to
+// read it from other threads.
+struct Counter
+{
+    std::atomic<uint64_t> value{0u};
+
+    void add(uint64_t n) { value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed); }
+    void raise(uint64_t n) {
+        if(n > value.load(std::memory_order_relaxed))
+            value.store(n, std::memory_order_relaxed);
+    }
+    uint64_t get() const { return value.load(std::memory_order_relaxed); }
+};
+
+struct SiteCounters
+{
+    Counter allocations;
+    Counter bytes;
+    Counter largest;
+};
+
+struct Counters
+{
+    Counter allocations;
+    Counter deallocations;
+    Counter allocatedBytes;
+    Counter freedBytes;
+    Counter assertFailures;
+    SiteCounters sites[max_sites];
+};
+
+// the counters of one thread, which register themselves on construction and fold into the retired ones at exit
+struct ThreadCounters : Counters
+{
+    ThreadCounters();
+    ~ThreadCounters();
+};
+
+// what is left of the threads that have exited, and everything statistics() needs to find the others
+struct Registry
+{
+    std::mutex mutex;
+    std::vector<ThreadCounters *> threads;
+    Counters retired;
+    const char *siteNames[max_sites] = {"(unattributed)"};
+    size_t sites = 1u;
+};
+
+// never destroyed, since buffers may still be released while static objects are
+inline Registry &registry() {
+    static Registry *instance = new Registry;
+    return *instance;
+}
+
+inline thread_local size_t tCurrentSite = 0u;
+inline thread_local bool tFinished = false;
+
+// this thread's counters, or null once they have been destroyed at thread exit
+inline ThreadCounters *local() {
+    if(tFinished)
+        return nullptr;
+    thread_local ThreadCounters counters;
+    return &counters;
+}
+
+inline void fold(const Counters &from, Counters &into) {
+    into.allocations.add(from.allocations.get());
+    into.deallocations.add(from.deallocations.get());
+    into.allocatedBytes.add(from.allocatedBytes.get());
+    into.freedBytes.add(from.freedBytes.get());
+    into.assertFailures.add(from.assertFailures.get());
+    for(size_t i = 0; i < max_sites; ++i) {
+        into.sites[i].allocations.add(from.sites[i].allocations.get());
+        into.sites[i].bytes.add(from.sites[i].bytes.get());
+        into.sites[i].largest.raise(from.sites[i].largest.get());
+    }
+}
+
+inline ThreadCounters::ThreadCounters() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.threads.push_back(this);
+}
+
+inline ThreadCounters::~ThreadCounters() {
+    Registry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    fold(*this, r.retired);
+    r.threads.erase(std::find(r.threads.begin(), r.threads.end(), this));
+    tFinished = true;
+}
+
+// runs f on this thread's counters, or on the retired ones under the lock once this thread's are gone
+template< typename f_t >
+void count(f_t f) {
+    if(Counters *counters = local()) {
+        f(*counters);
+    } else {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        f(r.retired);
+    }
+}
+
+inline void record_allocation(size_t bytes) {
+    count([bytes](Counters &c) {
+        c.allocations.add(1u);
+        c.allocatedBytes.add(bytes);
+        SiteCounters &site = c.sites[tCurrentSite];
+        site.allocations.add(1u);
+        site.bytes.add(bytes);
+        site.largest.raise(bytes);
+    });
+}
+
+inline void record_deallocation(size_t bytes) {
+    count([bytes](Counters &c) {
+        c.deallocations.add(1u);
+        c.freedBytes.add(bytes);
+    });
+}
+
+inline void record_assert_failure() {
+    count([](Counters &c) { c.assertFailures.add(1u); });
+}
+
+}// namespace detail
+
+
+inline Site::Site(const char *name)
+    : mId(0u)
+{
+    detail::Registry &r = detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    if(r.sites < max_sites) {
+        mId = r.sites++;
+        r.siteNames[mId] = name;
+    }
+}
+
+inline SiteScope::SiteScope(const Site &site)
+    : mPrevious(detail::tCurrentSite)
+{
+    detail::tCurrentSite = site.id();
+}
+
+inline SiteScope::~SiteScope() {
+    detail::tCurrentSite = mPrevious;
+}
+
+inline Statistics statistics() {
+    detail::Registry &r = detail::registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    detail::Counters total;
+    detail::fold(r.retired, total);
+    for(const detail::ThreadCounters *thread : r.threads)
+        detail::fold(*thread, total);
+
+    Statistics snapshot;
+    snapshot.allocations = total.allocations.get();
+    snapshot.deallocations = total.deallocations.get();
+    snapshot.allocatedBytes = total.allocatedBytes.get();
+    snapshot.freedBytes = total.freedBytes.get();
+    snapshot.assertFailures = total.assertFailures.get();
+    for(size_t i = 0; i < r.sites; ++i) {
+        const detail::SiteCounters &site = total.sites[i];
+        if(site.allocations.get() > 0u)
+            snapshot.sites.push_back({r.siteNames[i], site.allocations.get(), site.bytes.get(), site.largest.get()});
+    }
+    return snapshot;
+}
+
+}// namespace instrumentation
+}// namespace CPPBuffer
+
+#define CPPBUFFER_RECORD_ALLOCATION(bytes_) ::CPPBuffer::instrumentation::detail::record_allocation(bytes_)
+#define CPPBUFFER_RECORD_DEALLOCATION(bytes_) ::CPPBuffer::instrumentation::detail::record_deallocation(bytes_)
+#define CPPBUFFER_RECORD_ASSERT_FAILURE() ::CPPBuffer::instrumentation::detail::record_assert_failure()
+#define CPPBUFFER_ALLOCATION_SITE(name_) \
+    static const ::CPPBuffer::instrumentation::Site cppBufferAllocationSite(name_); \
+    const ::CPPBuffer::instrumentation::SiteScope cppBufferAllocationSiteScope(cppBufferAllocationSite)
+
+#else
+
+#define CPPBUFFER_RECORD_ALLOCATION(bytes_) (void(0))
+#define CPPBUFFER_RECORD_DEALLOCATION(bytes_) (void(0))
+#define CPPBUFFER_RECORD_ASSERT_FAILURE() (void(0))
+#define CPPBUFFER_ALLOCATION_SITE(name_) (void(0))
+
+#endif
@@ -0,0 +1,381 @@
+#pragma once
+
+#if !defined(__linux__) || !__has_include(<linux/io_uring.h>)
+#error "io_ring.h needs Linux io_uring headers"
+#endif
+
+#include<algorithm>
+#include<cerrno>
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<stdexcept>
+#include<system_error>
+#include<vector>
+
+#include<linux/io_uring.h>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#include<sys/uio.h>
+#include<unistd.h>
+
+#include "buffer.h"
+#include "buffer_pool.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  Asynchronous reads and writes straight into and out of byte Buffers, over a Linux io_uring. No liburing needed,
+ *  the ring is driven through the raw system calls.
+ *
+ *  Submitting an operation keeps the Buffer (or Slice) it targets alive until its completion has been reaped, and the
+ *  completion hands it back, trimmed to the bytes that were actually transferred:
+ *      IoRing ring;
+ *      ring.register_buffers(pool); // optional, see below
+ *      ring.read(fd, Buffer<uint8_t>(4096, pool, uninitialized), offset, tag);
+ *      IoRing::Completion done[16];
+ *      for(size_t i = 0, n = ring.wait(done, 16); i < n; ++i)
+ *          if(done[i].ok()) parse(done[i].data);
+ *
+ *  Registering a BufferPool hands the kernel its slabs as fixed buffers up front, so operations on memory inside them
+ *  use IORING_OP_READ_FIXED / WRITE_FIXED and skip pinning pages on every call. Memory outside any registered slab,
+ *  including slabs the pool grows after registration, quietly takes the regular path instead.
+ *
+ *  An IoRing is not thread-safe. Setup and registration failures throw std::system_error; failed operations report
+ *  -errno in their completion's result. Operations on 4 GiB or more throw std::invalid_argument, split them up.
+ */
+class IoRing
+{
+    public:
+    typedef Slice<uint8_t, 1u, std::shared_ptr<uint8_t>> Data;
+
+    struct Completion
+    {
+        Data data;          // the transferred bytes, at the front of the submitted range
+        int result;         // bytes transferred, or -errno
+        uint64_t tag;       // as passed at submission
+        bool fixed;         // whether the operation went through a registered buffer
+
+        bool ok() const { return result >= 0; }
+    };
+
+    // the file position offset: read or write at the current position of a stream or file
+    static constexpr uint64_t current_position = uint64_t(-1);
+
+    explicit IoRing(unsigned entries = 256u);
+    ~IoRing();
+
+    IoRing(const IoRing &) = delete;
+    IoRing &operator=(const IoRing &) = delete;
+
+    // registers every slab the pool currently owns, replacing any earlier registration
+    void register_buffers(const BufferPool &pool);
+    void unregister_buffers();
+
+    // queue an operation. Returns false if the ring has no room left, in which case reap completions and try again.
+    // Data of 4 GiB or more throws std::invalid_argument.
+    bool read(int fd, const Buffer<uint8_t> &into, uint64_t offset, uint64_t tag = 0u);
+    bool read(int fd, const Data &into, uint64_t offset, uint64_t tag = 0u);
+    bool write(int fd, const Buffer<uint8_t> &from, uint64_t offset, uint64_t tag = 0u);
+    bool write(int fd, const Data &from, uint64_t offset, uint64_t tag = 0u);
+
+    // hands queued operations to the kernel, and returns how many it took
+    unsigned submit();
+    // reaps up to max completions without blocking
+    size_t poll(Completion *out, size_t max);
+    // submits, then blocks until at least min completions (and no more than the operations in flight) are available
+    size_t wait(Completion *out, size_t max, size_t min = 1u);
+
+    size_t in_flight() const { return mInFlight; }
+
+    private:
+    struct Pending
+    {
+        Data data;
+        uint64_t tag;
+        bool fixed;
+        uint32_t nextFree;
+    };
+
+    struct Registered
+    {
+        uintptr_t begin;
+        uintptr_t end;
+        uint16_t index;
+    };
+
+    bool queue(uint8_t opcode, uint8_t fixedOpcode, int fd, const Data &data, uint64_t offset, uint64_t tag);
+    int enter(unsigned toSubmit, unsigned minComplete, unsigned flags);
+    const Registered *findRegistered(const void *p, size_t bytes) const;
+
+    int mFd = -1;
+    void *mSqRing = nullptr;
+    size_t mSqRingBytes = 0u;
+    void *mCqRing = nullptr;
+    size_t mCqRingBytes = 0u;
+    io_uring_sqe *mSqes = nullptr;
+    size_t mSqesBytes = 0u;
+
+    // the rings' shared indices, as mapped
+    unsigned *mSqHead = nullptr;
+    unsigned *mSqTail = nullptr;
+    unsigned mSqMask = 0u;
+    unsigned mSqEntries = 0u;
+    unsigned *mCqHead = nullptr;
+    unsigned *mCqTail = nullptr;
+    unsigned mCqMask = 0u;
+    unsigned mCqEntries = 0u;
+    io_uring_cqe *mCqes = nullptr;
+
+    unsigned mQueued = 0u; // sqes written but not yet submitted
+    size_t mInFlight = 0u; // submitted or queued, and not yet reaped
+
+    std::vector<Pending> mPending;
+    uint32_t mFreePending = 0u;
+    std::vector<Registered> mRegistered; // sorted by address
+};
+
+
+
+inline IoRing::IoRing(unsigned entries) {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    mFd = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &params));
+    if(mFd < 0)
+        throw std::system_error(errno, std::generic_category(), "io_uring_setup");
+
+    mSqRingBytes = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    mCqRingBytes = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    const bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0u;
+    if(singleMmap)
+        mSqRingBytes = mCqRingBytes = std::max(mSqRingBytes, mCqRingBytes);
+
+    mSqRing = ::mmap(nullptr, mSqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd,
+        IORING_OFF_SQ_RING);
+    if(mSqRing == MAP_FAILED) {
+        const int error = errno;
+        ::close(mFd);
+        throw std::system_error(error, std::generic_category(), "mmap sq ring");
+    }
+    mCqRing = mSqRing;
+    if(!singleMmap) {
+        mCqRing = ::mmap(nullptr, mCqRingBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd,
+            IORING_OFF_CQ_RING);
+        if(mCqRing == MAP_FAILED) {
+            const int error = errno;
+            ::munmap(mSqRing, mSqRingBytes);
+            ::close(mFd);
+            throw std::system_error(error, std::generic_category(), "mmap cq ring");
+        }
+    }
+
+    mSqesBytes = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = ::mmap(nullptr, mSqesBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, mFd, IORING_OFF_SQES);
+    if(sqes == MAP_FAILED) {
+        const int error = errno;
+        if(mCqRing != mSqRing)
+            ::munmap(mCqRing, mCqRingBytes);
+        ::munmap(mSqRing, mSqRingBytes);
+        ::close(mFd);
+        throw std::system_error(error, std::generic_category(), "mmap sqes");
+    }
+    mSqes = static_cast<io_uring_sqe *>(sqes);
+
+    char *sq = static_cast<char *>(mSqRing);
+    mSqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+    mSqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+    mSqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+    mSqEntries = params.sq_entries;
+
+    // the indirection array never changes: slot i of the ring always submits sqe i
+    unsigned *array = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+    for(unsigned i = 0; i < mSqEntries; ++i)
+        array[i] = i;
+
+    char *cq = static_cast<char *>(mCqRing);
+    mCqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+    mCqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+    mCqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+    mCqEntries = params.cq_entries;
+    mCqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+
+    // one pending slot per completion the kernel can hold, threaded onto a free list
+    mPending.resize(mCqEntries);
+    for(uint32_t i = 0; i < mCqEntries; ++i)
+        mPending[i].nextFree = i + 1u;
+    mFreePending = 0u;
+}
+
+inline IoRing::~IoRing() {
+    // The kernel may still be writing into buffers we hold, so let everything in flight finish first. This can't
+    // throw like wait() does: if the kernel won't take the queued operations or wait for completions, closing the
+    // ring, which cancels whatever is left, is all there is to do.
+    Completion drained[16];
+    while(mInFlight > 0u) {
+        if(poll(drained, 16u) > 0u)
+            continue;
+        const int submitted = enter(mQueued, 1u, IORING_ENTER_GETEVENTS);
+        if(submitted < 0)
+            break;
+        mQueued -= static_cast<unsigned>(submitted);
+    }
+
+    ::munmap(mSqes, mSqesBytes);
+    if(mCqRing != mSqRing)
+        ::munmap(mCqRing, mCqRingBytes);
+    ::munmap(mSqRing, mSqRingBytes);
+    ::close(mFd);
+}
+
+inline void IoRing::register_buffers(const BufferPool &pool) {
+    unregister_buffers();
+
+    std::vector<iovec> iovecs;
+    for(const BufferPool::Slab &slab : pool.slabs())
+        iovecs.push_back(iovec{slab.memory, slab.bytes});
+    if(iovecs.empty())
+        return;
+    if(::syscall(__NR_io_uring_register, mFd, IORING_REGISTER_BUFFERS, iovecs.data(),
+        static_cast<unsigned>(iovecs.size())) < 0)
+        throw std::system_error(errno, std::generic_category(), "IORING_REGISTER_BUFFERS");
+
+    for(size_t i = 0; i < iovecs.size(); ++i) {
+        const uintptr_t begin = reinterpret_cast<uintptr_t>(iovecs[i].iov_base);
+        mRegistered.push_back(Registered{begin, begin + iovecs[i].iov_len, static_cast<uint16_t>(i)});
+    }
+    std::sort(mRegistered.begin(), mRegistered.end(),
+        [](const Registered &a, const Registered &b) { return a.begin < b.begin; });
+}
+
+inline void IoRing::unregister_buffers() {
+    if(mRegistered.empty())
+        return;
+    ::syscall(__NR_io_uring_register, mFd, IORING_UNREGISTER_BUFFERS, nullptr, 0u);
+    mRegistered.clear();
+}
+
+inline const IoRing::Registered *IoRing::findRegistered(const void *p, size_t bytes) const {
+    const uintptr_t begin = reinterpret_cast<uintptr_t>(p);
+    auto it = std::upper_bound(mRegistered.begin(), mRegistered.end(), begin,
+        [](uintptr_t address, const Registered &r) { return address < r.begin; });
+    if(it == mRegistered.begin())
+        return nullptr;
+    --it;
+    return begin + bytes <= it->end ? &*it : nullptr;
+}
+
+inline bool IoRing::queue(uint8_t opcode, uint8_t fixedOpcode, int fd, const Data &data, uint64_t offset,
+    uint64_t tag)
+{
+    // a single operation moves at most 4 GiB, the most an sqe's length can hold
+    if(data.size() > UINT32_MAX)
+        throw std::invalid_argument("IoRing: an operation can't transfer more than 4 GiB - 1 bytes");
+
+    const unsigned tail = *mSqTail;
+    const unsigned head = __atomic_load_n(mSqHead, __ATOMIC_ACQUIRE);
+    if(tail - head >= mSqEntries || mFreePending >= mPending.size())
+        return false;
+
+    const uint32_t slot = mFreePending;
+    Pending &pending = mPending[slot];
+    mFreePending = pending.nextFree;
+
+    const Registered *registered = findRegistered(data.begin(), data.size());
+    pending.data = data;
+    pending.tag = tag;
+    pending.fixed = registered != nullptr;
+
+    io_uring_sqe &sqe = mSqes[tail & mSqMask];
+    std::memset(&sqe, 0, sizeof(sqe));
+    sqe.opcode = registered ? fixedOpcode : opcode;
+    sqe.fd = fd;
+    sqe.off = offset;
+    sqe.addr = reinterpret_cast<uint64_t>(data.begin());
+    sqe.len = static_cast<uint32_t>(data.size());
+    sqe.user_data = slot;
+    if(registered)
+        sqe.buf_index = registered->index;
+
+    __atomic_store_n(mSqTail, tail + 1u, __ATOMIC_RELEASE);
+    ++mQueued;
+    ++mInFlight;
+    return true;
+}
+
+inline bool IoRing::read(int fd, const Buffer<uint8_t> &into, uint64_t offset, uint64_t tag) {
+    return read(fd, Data(into, 0u, into.size()), offset, tag);
+}
+
+inline bool IoRing::read(int fd, const Data &into, uint64_t offset, uint64_t tag) {
+    return queue(IORING_OP_READ, IORING_OP_READ_FIXED, fd, into, offset, tag);
+}
+
+inline bool IoRing::write(int fd, const Buffer<uint8_t> &from, uint64_t offset, uint64_t tag) {
+    return write(fd, Data(from, 0u, from.size()), offset, tag);
+}
+
+inline bool IoRing::write(int fd, const Data &from, uint64_t offset, uint64_t tag) {
+    return queue(IORING_OP_WRITE, IORING_OP_WRITE_FIXED, fd, from, offset, tag);
+}
+
+inline int IoRing::enter(unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    for(;;) {
+        const long result = ::syscall(__NR_io_uring_enter, mFd, toSubmit, minComplete, flags, nullptr, 0);
+        if(result >= 0 || errno != EINTR)
+            return static_cast<int>(result);
+    }
+}
+
+inline unsigned IoRing::submit() {
+    if(mQueued == 0u)
+        return 0u;
+    const int submitted = enter(mQueued, 0u, 0u);
+    if(submitted < 0)
+        throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+    mQueued -= static_cast<unsigned>(submitted);
+    return static_cast<unsigned>(submitted);
+}
+
+inline size_t IoRing::poll(Completion *out, size_t max) {
+    unsigned head = *mCqHead;
+    const unsigned tail = __atomic_load_n(mCqTail, __ATOMIC_ACQUIRE);
+
+    size_t n = 0u;
+    for(; head != tail && n < max; ++head, ++n) {
+        const io_uring_cqe &cqe = mCqes[head & mCqMask];
+        const uint32_t slot = static_cast<uint32_t>(cqe.user_data);
+        Pending &pending = mPending[slot];
+
+        Completion &completion = out[n];
+        completion.result = cqe.res;
+        completion.tag = pending.tag;
+        completion.fixed = pending.fixed;
+        completion.data = pending.data.slice(0u, cqe.res > 0 ? static_cast<size_t>(cqe.res) : 0u);
+
+        pending.data = Data();
+        pending.nextFree = mFreePending;
+        mFreePending = slot;
+        --mInFlight;
+    }
+    __atomic_store_n(mCqHead, head, __ATOMIC_RELEASE);
+    return n;
+}
+
+inline size_t IoRing::wait(Completion *out, size_t max, size_t min) {
+    min = std::min(std::min(min, max), mInFlight);
+    size_t n = poll(out, max);
+    while(n < min || mQueued > 0u) {
+        const unsigned toSubmit = mQueued;
+        const int submitted = enter(toSubmit, static_cast<unsigned>(min - std::min(n, min)),
+            n < min ? IORING_ENTER_GETEVENTS : 0u);
+        if(submitted < 0)
+            throw std::system_error(errno, std::generic_category(), "io_uring_enter");
+        mQueued -= static_cast<unsigned>(submitted);
+        n += poll(out + n, max - n);
+    }
+    return n;
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,269 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<new>
+#include<type_traits>
+#include<utility>
+
+#include "shared_array.h"
+
+
+/**
+ *  Reference-counted pointers for Buffers that never cross threads.
+ *
+ *  Copying a std::shared_ptr is an atomic increment and destroying one an atomic decrement, which shows up when
+ *  Buffers and Slices are copied around a lot. These two pointer types count with plain integers instead, so they must
+ *  not be shared between threads: hand a Buffer that uses them to another thread and the count is corrupted.
+ *
+ *  local_shared_ptr<T> is a pointer to the element plus a pointer to its count, like std::shared_ptr.
+ *  intrusive_array_ptr<T> keeps the count in a header right in front of the elements, so it is a single pointer, and a
+ *  Buffer using it is the same size as a Buffer over a bare pointer:
+ *      Buffer<float, 1u, local_shared_ptr<float>> a(256);
+ *      Buffer<float, 1u, intrusive_array_ptr<float>> b(256, pool);
+ *
+ *  Both allocate the count and the elements in one block from a resource (NewDeleteResource or a BufferPool, for
+ *  instance), through the same Buffer constructors std::shared_ptr uses.
+ */
+
+namespace CPPBuffer
+{
+
+namespace detail
+{
+
+// The part of a block that the pointers touch. It sits directly in front of the first element.
+struct LocalArrayHeader
+{
+    size_t references;
+    void (*release)(LocalArrayHeader *); // destroys the elements and gives the block back to its resource
+};
+
+template< typename T, typename resource_t >
+struct LocalArrayBlock
+{
+    resource_t *resource;
+    size_t count;
+    size_t blockBytes;
+    size_t blockAlignment;
+    size_t dataOffset;
+    LocalArrayHeader header; // has to be last, so it ends where the elements begin
+
+    static LocalArrayBlock *from(LocalArrayHeader *h) {
+        return reinterpret_cast<LocalArrayBlock *>(reinterpret_cast<char *>(h) - offsetof(LocalArrayBlock, header));
+    }
+
+    static void release(LocalArrayHeader *h) {
+        LocalArrayBlock *block = from(h);
+        T *data = reinterpret_cast<T *>(h + 1);
+        if(!std::is_trivially_destructible<T>::value) {
+            for(size_t i = block->count; i > 0; --i)
+                data[i - 1u].~T();
+        }
+
+        resource_t *resource = block->resource;
+        const size_t bytes = block->blockBytes;
+        const size_t alignment = block->blockAlignment;
+        void *memory = reinterpret_cast<char *>(data) - block->dataOffset;
+        block->~LocalArrayBlock();
+        resource->deallocate(memory, bytes, alignment);
+        CPPBUFFER_RECORD_DEALLOCATION(bytes);
+    }
+};
+
+/**
+ *  Allocates a block holding a LocalArrayBlock followed by n elements, with a reference count of one, and returns the
+ *  first element. The header is found again from there.
+ */
+template< typename T, typename resource_t, typename ... init_t >
+T *make_local_array(size_t n, size_t alignment, resource_t &resource, init_t ... init) {
+    typedef LocalArrayBlock<T, resource_t> Block;
+    static_assert(offsetof(Block, header) + sizeof(LocalArrayHeader) == sizeof(Block),
+        "the header has to end right where the elements begin");
+
+    if(alignment < alignof(T))
+        alignment = alignof(T);
+    if(alignment < alignof(Block))
+        alignment = alignof(Block);
+
+    const size_t dataOffset = round_up(sizeof(Block), alignment);
+    check_array_length<T>(n, dataOffset);
+    const size_t bytes = dataOffset + n * sizeof(T);
+    char *memory = static_cast<char *>(resource.allocate(bytes, alignment));
+    CPPBUFFER_RECORD_ALLOCATION(bytes);
+    T *data = reinterpret_cast<T *>(memory + dataOffset);
+
+    size_t i = 0;
+    try {
+        for(; i < n; ++i)
+            construct_element(data + i, i, init...);
+    } catch(...) {
+        while(i > 0)
+            data[--i].~T();
+        resource.deallocate(memory, bytes, alignment);
+        CPPBUFFER_RECORD_DEALLOCATION(bytes);
+        throw;
+    }
+
+    Block *block = ::new(static_cast<void *>(reinterpret_cast<char *>(data) - sizeof(Block))) Block;
+    block->resource = &resource;
+    block->count = n;
+    block->blockBytes = bytes;
+    block->blockAlignment = alignment;
+    block->dataOffset = dataOffset;
+    block->header.references = 1u;
+    block->header.release = &Block::release;
+    return data;
+}
+
+inline LocalArrayHeader *local_header_of(const void *data) {
+    return reinterpret_cast<LocalArrayHeader *>(const_cast<char *>(static_cast<const char *>(data))) - 1;
+}
+
+}// namespace detail
+
+
+/**
+ *  A non-atomic shared pointer. Copies share a count, and the last one to go releases the block. Like the aliasing
+ *  std::shared_ptr constructor, a local_shared_ptr can point anywhere into the block it keeps alive.
+ */
+template< typename T >
+class local_shared_ptr
+{
+    public:
+    typedef T element_type;
+
+    local_shared_ptr() = default;
+    local_shared_ptr(std::nullptr_t) noexcept {}
+    local_shared_ptr(const local_shared_ptr &other) : mPtr(other.mPtr), mHeader(other.mHeader) { retain(); }
+    local_shared_ptr(local_shared_ptr &&other) noexcept : mPtr(other.mPtr), mHeader(other.mHeader) {
+        other.mPtr = nullptr;
+        other.mHeader = nullptr;
+    }
+    // aliasing: shares ownership with other, but points at p
+    local_shared_ptr(const local_shared_ptr &other, T *p) : mPtr(p), mHeader(other.mHeader) { retain(); }
+    ~local_shared_ptr() { release(); }
+
+    local_shared_ptr &operator=(local_shared_ptr other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    // takes over a block made by make_local_array, which already counts this reference
+    static local_shared_ptr adopt(T *data) {
+        local_shared_ptr p;
+        p.mPtr = data;
+        p.mHeader = data ? detail::local_header_of(data) : nullptr;
+        return p;
+    }
+
+    T *get() const { return mPtr; }
+    T &operator*() const { return *mPtr; }
+    T *operator->() const { return mPtr; }
+    explicit operator bool() const { return mPtr != nullptr; }
+    size_t use_count() const { return mHeader ? mHeader->references : 0u; }
+
+    void reset() noexcept { local_shared_ptr().swap(*this); }
+    void swap(local_shared_ptr &other) noexcept {
+        std::swap(mPtr, other.mPtr);
+        std::swap(mHeader, other.mHeader);
+    }
+
+    friend bool operator==(const local_shared_ptr &a, std::nullptr_t) { return a.mPtr == nullptr; }
+    friend bool operator!=(const local_shared_ptr &a, std::nullptr_t) { return a.mPtr != nullptr; }
+
+    private:
+    void retain() {
+        if(mHeader)
+            ++mHeader->references;
+    }
+
+    void release() {
+        if(mHeader && --mHeader->references == 0u)
+            mHeader->release(mHeader);
+    }
+
+    T *mPtr = nullptr;
+    detail::LocalArrayHeader *mHeader = nullptr;
+};
+
+
+/**
+ *  A non-atomic shared pointer to the first element of a block made by make_local_array. The count lives in front of
+ *  the element it points at, so it is a single pointer, and it cannot point anywhere else.
+ */
+template< typename T >
+class intrusive_array_ptr
+{
+    public:
+    typedef T element_type;
+
+    intrusive_array_ptr() = default;
+    intrusive_array_ptr(std::nullptr_t) noexcept {}
+    intrusive_array_ptr(const intrusive_array_ptr &other) : mPtr(other.mPtr) { retain(); }
+    intrusive_array_ptr(intrusive_array_ptr &&other) noexcept : mPtr(other.mPtr) { other.mPtr = nullptr; }
+    ~intrusive_array_ptr() { release(); }
+
+    intrusive_array_ptr &operator=(intrusive_array_ptr other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    // takes over a block made by make_local_array, which already counts this reference
+    static intrusive_array_ptr adopt(T *data) {
+        intrusive_array_ptr p;
+        p.mPtr = data;
+        return p;
+    }
+
+    T *get() const { return mPtr; }
+    T &operator*() const { return *mPtr; }
+    T *operator->() const { return mPtr; }
+    explicit operator bool() const { return mPtr != nullptr; }
+    size_t use_count() const { return mPtr ? detail::local_header_of(mPtr)->references : 0u; }
+
+    void reset() noexcept { intrusive_array_ptr().swap(*this); }
+    void swap(intrusive_array_ptr &other) noexcept { std::swap(mPtr, other.mPtr); }
+
+    friend bool operator==(const intrusive_array_ptr &a, std::nullptr_t) { return a.mPtr == nullptr; }
+    friend bool operator!=(const intrusive_array_ptr &a, std::nullptr_t) { return a.mPtr != nullptr; }
+
+    private:
+    void retain() {
+        if(mPtr)
+            ++detail::local_header_of(mPtr)->references;
+    }
+
+    void release() {
+        if(mPtr) {
+            detail::LocalArrayHeader *header = detail::local_header_of(mPtr);
+            if(--header->references == 0u)
+                header->release(header);
+        }
+    }
+
+    T *mPtr = nullptr;
+};
+
+static_assert(sizeof(intrusive_array_ptr<float>) == sizeof(float *), "intrusive_array_ptr must be a single pointer");
+
+
+template< typename T >
+struct PointerAllocation<local_shared_ptr<T>>
+{
+    template< typename resource_t, typename ... init_t >
+    static local_shared_ptr<T> make(size_t n, size_t alignment, resource_t &resource, init_t ... init) {
+        return local_shared_ptr<T>::adopt(detail::make_local_array<T>(n, alignment, resource, init...));
+    }
+};
+
+template< typename T >
+struct PointerAllocation<intrusive_array_ptr<T>>
+{
+    template< typename resource_t, typename ... init_t >
+    static intrusive_array_ptr<T> make(size_t n, size_t alignment, resource_t &resource, init_t ... init) {
+        return intrusive_array_ptr<T>::adopt(detail::make_local_array<T>(n, alignment, resource, init...));
+    }
+};
+
+}// namespace CPPBuffer
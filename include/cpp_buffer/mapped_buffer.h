@@ -0,0 +1,172 @@
+#pragma once
+
+#include<cerrno>
+#include<cstddef>
+#include<cstdint>
+#include<memory>
+#include<system_error>
+#include<type_traits>
+
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/stat.h>
+#include<unistd.h>
+
+#include "buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/** Hints for the kernel about how a mapping is going to be accessed */
+enum class Advice
+{
+    normal,
+    sequential,     // read ahead aggressively, and drop pages behind the reader
+    random,         // don't read ahead
+    will_need,      // start paging the range in now
+    huge_page,      // back the range with transparent huge pages where the kernel can
+};
+
+/**
+ *  Buffers backed by memory-mapped files (POSIX only). The file isn't read up front: pages are faulted in from the
+ *  page cache as they are touched, and every process mapping the same file shares those pages.
+ *
+ *  The element type decides the kind of mapping. A Buffer<const T> maps the file read-only. A Buffer<T> maps it
+ *  copy-on-write: writes are private to the process and never reach the file. open_shared() maps it shared instead,
+ *  so writes go to the file and are seen by every other process mapping it, which is how shared_memory.h hands
+ *  buffers between processes.
+ *      auto samples = MappedBuffer::open<const int16_t>("capture.raw");
+ *      MappedBuffer::advise(samples, Advice::sequential);
+ *
+ *  The mapping goes away when the last Buffer or Slice sharing it does. Failures to open or map throw a
+ *  std::system_error carrying errno.
+ */
+class MappedBuffer
+{
+    public:
+    // maps every whole element of the file at path
+    template< typename T >
+    static Buffer<T> open(const char *path);
+
+    // maps count elements (or as many as the file holds, if count is size_t(-1)) from byte offset on. The offset doesn't
+    // have to be page aligned, but it should be aligned for T.
+    template< typename T >
+    static Buffer<T> open(int fd, size_t offset = 0u, size_t count = size_t(-1));
+
+    // as above, but writes through a Buffer<T> go to the file, for every process mapping it to see
+    template< typename T >
+    static Buffer<T> open_shared(int fd, size_t offset = 0u, size_t count = size_t(-1));
+
+    // passes advice on to the kernel for the pages under buffer. Returns false if the kernel didn't take it, which is
+    // harmless, since advice is only ever a hint.
+    template< typename buffer_t >
+    static bool advise(const buffer_t &buffer, Advice advice);
+
+    static size_t page_size() {
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    private:
+    template< typename T >
+    static Buffer<T> map(int fd, size_t offset, size_t count, int flags);
+    static int toMadvise(Advice advice);
+    static bool adviseRange(const void *begin, size_t bytes, Advice advice);
+};
+
+
+
+template< typename T >
+Buffer<T> MappedBuffer::open(const char *path) {
+    const int flags = std::is_const<T>::value ? O_RDONLY : O_RDWR;
+    int fd = ::open(path, flags | O_CLOEXEC);
+    if(fd < 0 && errno == EACCES && !std::is_const<T>::value)
+        fd = ::open(path, O_RDONLY | O_CLOEXEC); // a private mapping doesn't need write access to the file
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), path);
+
+    try {
+        Buffer<T> buffer = open<T>(fd);
+        ::close(fd); // the mapping keeps its own reference to the file
+        return buffer;
+    } catch(...) {
+        ::close(fd);
+        throw;
+    }
+}
+
+template< typename T >
+Buffer<T> MappedBuffer::open(int fd, size_t offset, size_t count) {
+    return map<T>(fd, offset, count, MAP_PRIVATE);
+}
+
+template< typename T >
+Buffer<T> MappedBuffer::open_shared(int fd, size_t offset, size_t count) {
+    return map<T>(fd, offset, count, MAP_SHARED);
+}
+
+template< typename T >
+Buffer<T> MappedBuffer::map(int fd, size_t offset, size_t count, int flags) {
+    struct stat info;
+    if(::fstat(fd, &info) != 0)
+        throw std::system_error(errno, std::generic_category(), "fstat");
+
+    const size_t fileBytes = static_cast<size_t>(info.st_size);
+    const size_t available = fileBytes > offset ? (fileBytes - offset) / sizeof(T) : 0u;
+    if(count > available)
+        count = available;
+    if(count == 0u)
+        return Buffer<T>();
+
+    // mmap wants a page-aligned offset, so map from the page the data starts in
+    const size_t pageOffset = offset % page_size();
+    const size_t length = pageOffset + count * sizeof(T);
+    const int protection = std::is_const<T>::value ? PROT_READ : PROT_READ | PROT_WRITE;
+    void *base = ::mmap(nullptr, length, protection, flags, fd, static_cast<off_t>(offset - pageOffset));
+    if(base == MAP_FAILED)
+        throw std::system_error(errno, std::generic_category(), "mmap");
+
+    T *data = reinterpret_cast<T *>(static_cast<char *>(base) + pageOffset);
+    // if allocating the control block throws, shared_ptr already calls the deleter, so nothing is left to clean up
+    std::shared_ptr<T> memory(data, [base, length](T *) { ::munmap(base, length); });
+    return Buffer<T>(std::move(memory), count);
+}
+
+inline int MappedBuffer::toMadvise(Advice advice) {
+    switch(advice) {
+        case Advice::sequential: return MADV_SEQUENTIAL;
+        case Advice::random: return MADV_RANDOM;
+        case Advice::will_need: return MADV_WILLNEED;
+#ifdef MADV_HUGEPAGE
+        case Advice::huge_page: return MADV_HUGEPAGE;
+#else
+        case Advice::huge_page: return -1;
+#endif
+        case Advice::normal: break;
+    }
+    return MADV_NORMAL;
+}
+
+inline bool MappedBuffer::adviseRange(const void *begin, size_t bytes, Advice advice) {
+    const int hint = toMadvise(advice);
+    if(hint < 0 || bytes == 0u)
+        return false;
+
+    // madvise works on whole pages
+    const uintptr_t address = reinterpret_cast<uintptr_t>(begin);
+    const uintptr_t first = address - address % page_size();
+    return ::madvise(reinterpret_cast<void *>(first), address + bytes - first, hint) == 0;
+}
+
+template< typename buffer_t >
+bool MappedBuffer::advise(const buffer_t &buffer, Advice advice) {
+    if(buffer.size() == 0u)
+        return false;
+    const auto *first = &*buffer.begin();
+    const auto *last = &*(buffer.end() - 1);
+    return adviseRange(first, static_cast<size_t>(reinterpret_cast<const char *>(last + 1)
+        - reinterpret_cast<const char *>(first)), advice);
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,219 @@
+#pragma once
+
+#if !defined(__linux__)
+#error "page_resource.h needs Linux"
+#endif
+
+#include<algorithm>
+#include<cerrno>
+#include<cstddef>
+#include<cstdint>
+#include<new>
+#include<system_error>
+#include<type_traits>
+#include<utility>
+
+#include<linux/mempolicy.h>
+#include<sys/mman.h>
+#include<sys/syscall.h>
+#include<unistd.h>
+
+#include "algorithms.h"
+#include "buffer.h"
+#include "parallel.h"
+
+
+namespace CPPBuffer
+{
+
+enum class PageSize
+{
+    standard,           // the system's base pages, usually 4K
+    transparent_huge,   // base pages, laid out and advised so the kernel can back them with 2M pages
+    huge_2m,            // explicit 2M pages from the hugetlb pool
+    huge_1g,            // explicit 1G pages from the hugetlb pool
+};
+
+enum class NumaPolicy
+{
+    first_touch,        // the kernel default: each page goes to the node of the thread that writes it first
+    bind,               // only from the given nodes
+    interleave,         // round-robin over the given nodes, page by page
+    preferred,          // from the first of the given nodes while it has memory, then from anywhere
+};
+
+/**
+ *  A resource that maps memory straight from the kernel, with control over the page size and the NUMA placement of
+ *  large buffers (Linux only). Like any other resource it goes through the allocator constructors:
+ *      PageResource local(PageSize::transparent_huge, NumaPolicy::bind, 1ul << node);
+ *      Buffer<float> samples(n, local, uninitialized);
+ *
+ *  Every allocation is its own mapping, rounded up to whole pages, so this is for big, long-lived buffers. Small ones
+ *  are better off in a BufferPool. Transparent huge pages are a hint: the kernel backs the 2M-aligned parts of the
+ *  mapping with huge pages when it has them, and base pages otherwise. Explicit huge pages come from the pool reserved
+ *  in /proc/sys/vm/nr_hugepages, and allocating fails with std::bad_alloc once that runs out.
+ *
+ *  nodes is a bit mask, with bit i for NUMA node i. Leaving it 0 means every node the process may allocate from. A
+ *  policy the kernel rejects throws std::system_error. Placement happens when pages are first touched, so leave the
+ *  elements uninitialized and let parallel_first_touch() write them from the threads that are going to use them.
+ *
+ *  The resource itself holds no state besides its settings, so it can be shared between threads.
+ */
+class PageResource
+{
+    public:
+    explicit PageResource(PageSize pages = PageSize::transparent_huge, NumaPolicy numa = NumaPolicy::first_touch,
+        unsigned long nodes = 0ul);
+
+    void *allocate(size_t bytes, size_t alignment);
+    void deallocate(void *p, size_t bytes, size_t alignment);
+
+    PageSize page_size() const { return mPages; }
+    NumaPolicy numa_policy() const { return mNuma; }
+    unsigned long nodes() const { return mNodes; }
+
+    // the size of one page of the given kind
+    static size_t page_bytes(PageSize);
+
+    private:
+    size_t mappedBytes(size_t bytes) const { return detail::round_up(bytes, page_bytes(mPages)); }
+
+    PageSize mPages;
+    NumaPolicy mNuma;
+    unsigned long mNodes;
+};
+
+
+/** The NUMA nodes this process may allocate from, as a bit mask like PageResource takes */
+inline unsigned long numa_nodes();
+
+/** The NUMA node the page holding p is on, or -1 when the page hasn't been touched yet or the kernel doesn't say */
+inline int numa_node_of(const void *p);
+
+/** The node of the first element of a Buffer or Slice */
+template< typename view_t, typename = decltype(std::declval<const view_t &>().size()) >
+int numa_node_of(const view_t &view) {
+    return view.size() > 0u ? numa_node_of(static_cast<const void *>(&*view.begin())) : -1;
+}
+
+/**
+ *  Writes T() to every element of a freshly allocated, uninitialized view, in the chunks a parallel_for with the same
+ *  grain would hand out, so that under first-touch placement each page ends up on the node of the thread that wrote
+ *  it. Threads steal work, so this puts pages close to the threads that later work on them only as far as the pool
+ *  schedules the later loops the same way, which holds best for loops of the same size, grain and pool.
+ */
+template< typename view_t >
+void parallel_first_touch(ThreadPool &pool, view_t view, size_t grain) {
+    typedef typename std::remove_const<detail::element_t<view_t>>::type T;
+    parallel_for(pool, view, grain, [](auto chunk) { fill(chunk, T()); });
+}
+
+template< typename view_t >
+void parallel_first_touch(view_t view, size_t grain) {
+    parallel_first_touch(ThreadPool::shared(), view, grain);
+}
+
+
+
+namespace detail
+{
+
+// the kernel drops the last bit of maxnode, so a full unsigned long mask needs one more
+constexpr unsigned long numa_mask_bits = 8u * sizeof(unsigned long) + 1u;
+
+inline int to_mpol(NumaPolicy policy) {
+    switch(policy) {
+        case NumaPolicy::bind: return MPOL_BIND;
+        case NumaPolicy::interleave: return MPOL_INTERLEAVE;
+        case NumaPolicy::preferred: return MPOL_PREFERRED;
+        case NumaPolicy::first_touch: break;
+    }
+    return MPOL_DEFAULT;
+}
+
+}// namespace detail
+
+inline PageResource::PageResource(PageSize pages, NumaPolicy numa, unsigned long nodes)
+    : mPages(pages)
+    , mNuma(numa)
+    , mNodes(nodes != 0ul ? nodes : numa_nodes())
+{}
+
+inline size_t PageResource::page_bytes(PageSize pages) {
+    switch(pages) {
+        case PageSize::huge_2m: return size_t(1u) << 21;
+        case PageSize::huge_1g: return size_t(1u) << 30;
+        case PageSize::standard:
+        case PageSize::transparent_huge: break;
+    }
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+inline void *PageResource::allocate(size_t bytes, size_t alignment) {
+    const size_t page = page_bytes(mPages);
+    const size_t length = mappedBytes(bytes);
+
+    // huge pages only back 2M-aligned ranges, so transparent ones want big mappings to start on such a boundary
+    size_t align = std::max(alignment, page);
+    if(mPages == PageSize::transparent_huge && length >= page_bytes(PageSize::huge_2m))
+        align = std::max(align, page_bytes(PageSize::huge_2m));
+
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if(mPages == PageSize::huge_2m)
+        flags |= MAP_HUGETLB | (21 << MAP_HUGE_SHIFT);
+    else if(mPages == PageSize::huge_1g)
+        flags |= MAP_HUGETLB | (30 << MAP_HUGE_SHIFT);
+
+    // map enough to find an aligned range in, and give back what's left on either side of it
+    const size_t slack = align - page;
+    void *base = ::mmap(nullptr, length + slack, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if(base == MAP_FAILED)
+        throw std::bad_alloc();
+
+    const uintptr_t address = reinterpret_cast<uintptr_t>(base);
+    const uintptr_t start = detail::round_up(address, align);
+    if(start > address)
+        ::munmap(base, start - address);
+    if(address + slack > start)
+        ::munmap(reinterpret_cast<void *>(start + length), address + slack - start);
+    void *memory = reinterpret_cast<void *>(start);
+
+#ifdef MADV_HUGEPAGE
+    if(mPages == PageSize::transparent_huge)
+        ::madvise(memory, length, MADV_HUGEPAGE); // only a hint, and harmless when THP is off
+#endif
+
+    if(mNuma != NumaPolicy::first_touch) {
+        if(::syscall(SYS_mbind, memory, length, detail::to_mpol(mNuma), &mNodes, detail::numa_mask_bits, 0u) != 0) {
+            const int error = errno;
+            ::munmap(memory, length);
+            throw std::system_error(error, std::generic_category(), "mbind");
+        }
+    }
+    return memory;
+}
+
+inline void PageResource::deallocate(void *p, size_t bytes, size_t) {
+    ::munmap(p, mappedBytes(bytes));
+}
+
+inline unsigned long numa_nodes() {
+    unsigned long mask = 0ul;
+    if(::syscall(SYS_get_mempolicy, nullptr, &mask, detail::numa_mask_bits, nullptr, MPOL_F_MEMS_ALLOWED) != 0
+        || mask == 0ul)
+        return 1ul; // no NUMA support: everything is on node 0
+    return mask;
+}
+
+inline int numa_node_of(const void *p) {
+    // move_pages without target nodes only reports where each page is
+    const uintptr_t address = reinterpret_cast<uintptr_t>(p);
+    void *page = reinterpret_cast<void *>(address - address % PageResource::page_bytes(PageSize::standard));
+    int status = -1;
+    if(::syscall(SYS_move_pages, 0, 1ul, &page, nullptr, &status, 0) != 0)
+        return -1;
+    return status >= 0 ? status : -1;
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,329 @@
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<condition_variable>
+#include<cstddef>
+#include<cstdint>
+#include<deque>
+#include<exception>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<thread>
+#include<vector>
+
+#include "algorithms.h"
+#include "buffer.h"
+
+
+/**
+ *  Data-parallel loops over Buffers and Slices, on a work-stealing thread pool:
+ *      parallel_for(samples, 4096, [](auto chunk) { for(float &f : chunk) f *= gain; });
+ *      double total = parallel_reduce(samples, 4096, 0.0,
+ *          [](auto chunk) { return double(sum(chunk)); },
+ *          [](double a, double b) { return a + b; });
+ *
+ *  The view is partitioned with slice(), into chunks of at least grain elements. Chunk edges are moved onto cache line
+ *  boundaries in memory wherever the view's layout allows it, so two threads writing neighbouring chunks never write
+ *  to the same cache line. parallel_reduce combines the chunk results in chunk order, so the result doesn't depend on
+ *  how the work happened to be scheduled.
+ *
+ *  The calling thread works on the loop too, and only returns once every chunk is done. If a chunk throws, the rest of
+ *  the chunks still run and the first exception is rethrown from the call.
+ */
+
+namespace CPPBuffer
+{
+
+/**
+ *  A fixed set of worker threads, each with its own deque of ranges of work. A worker splits the range it takes in
+ *  halves, keeps working on the front half and pushes the back half onto its deque, from where idle workers steal it.
+ *  Owners pop the most recently pushed (smallest, cache-warm) range, thieves take the oldest (largest) one.
+ */
+class ThreadPool
+{
+    public:
+    // threads workers, on top of the thread that calls run(), which helps
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    // a process-wide pool, with one worker less than there are hardware threads
+    static ThreadPool &shared();
+
+    size_t threads() const { return mWorkers.size(); }
+
+    // calls task(i) for every i in [0, count), and returns when all of them are done
+    void run(size_t count, const std::function<void(size_t)> &task);
+
+    private:
+    struct Job
+    {
+        const std::function<void(size_t)> *task;
+        std::atomic<size_t> remaining;
+        std::mutex errorMutex;
+        std::exception_ptr error;
+    };
+
+    struct Range
+    {
+        Job *job;
+        size_t begin;
+        size_t end;
+    };
+
+    struct alignas(64) Queue
+    {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    void workerLoop(size_t self);
+    void push(size_t queue, const Range &);
+    bool pop(size_t queue, Range &);
+    bool steal(size_t thief, Range &);
+    bool runOne(size_t self);
+    void execute(size_t self, Range);
+    size_t currentQueue() const;
+
+    std::vector<std::thread> mWorkers;
+    // one queue per worker, and a last one for threads from outside the pool
+    std::unique_ptr<Queue[]> mQueues;
+    size_t mQueueCount;
+
+    std::atomic<size_t> mQueued{0u};
+    std::atomic<size_t> mSleeping{0u};
+    std::atomic<bool> mStop{false};
+    std::mutex mSleepMutex;
+    std::condition_variable mWake;
+};
+
+
+namespace detail
+{
+
+// where worker threads find their own queue
+struct WorkerIdentity
+{
+    const ThreadPool *pool;
+    size_t queue;
+};
+
+inline thread_local WorkerIdentity current_worker = {nullptr, 0u};
+
+/**
+ *  Chunk edges for a view: every edge but the first and the last sits at an element that starts a cache line, if the
+ *  view has any. The first chunk runs from 0 to head + chunk, and each following one is chunk elements long.
+ */
+struct Partition
+{
+    size_t size;
+    size_t head;
+    size_t chunk;
+
+    size_t count() const { return size > head ? (size - head + chunk - 1u) / chunk : (size > 0u ? 1u : 0u); }
+    size_t begin(size_t i) const { return i == 0u ? 0u : std::min(size, head + i * chunk); }
+    size_t end(size_t i) const { return std::min(size, head + (i + 1u) * chunk); }
+};
+
+template< typename T >
+Partition partition(const T *memory, size_t stride, size_t size, size_t grain) {
+    constexpr size_t line = 64u;
+    const size_t step = stride * sizeof(T); // bytes between consecutive elements of the view
+
+    // elements per period of the line pattern: after that many, the elements sit at the same offsets into a line again
+    size_t period = 1u;
+    while((period * step) % line != 0u)
+        ++period;
+
+    // the first element that starts a cache line, if one does
+    const uintptr_t address = reinterpret_cast<uintptr_t>(memory);
+    size_t head = 0u;
+    while(head < period && (address + head * step) % line != 0u)
+        ++head;
+    if(head == period)
+        head = 0u; // no element ever starts a line: nothing can be aligned
+
+    grain = std::max<size_t>(grain, 1u);
+    const size_t chunk = (grain + period - 1u) / period * period;
+    return Partition{size, head, chunk};
+}
+
+template< typename view_t >
+Partition partition(view_t &view, size_t grain) {
+    return partition(memory_of(view), stride_at(view), view.size(), grain);
+}
+
+}// namespace detail
+
+
+/** Calls fn(chunk) for consecutive Slice chunks that cover the view, in parallel */
+template< typename view_t, typename function_t >
+void parallel_for(ThreadPool &pool, view_t view, size_t grain, function_t &&fn) {
+    const detail::Partition p = detail::partition(view, grain);
+    pool.run(p.count(), [&](size_t i) { fn(view.slice(p.begin(i), p.end(i))); });
+}
+
+template< typename view_t, typename function_t >
+void parallel_for(view_t view, size_t grain, function_t &&fn) {
+    parallel_for(ThreadPool::shared(), view, grain, std::forward<function_t>(fn));
+}
+
+/** combine(map(chunk)...) over the chunks of the view, folded from identity in chunk order */
+template< typename view_t, typename result_t, typename map_t, typename combine_t >
+result_t parallel_reduce(ThreadPool &pool, view_t view, size_t grain, result_t identity, map_t &&map,
+    combine_t &&combine)
+{
+    // each chunk's result on its own cache line, so the workers don't share lines while writing them
+    struct alignas(64) Partial
+    {
+        result_t value;
+    };
+
+    const detail::Partition p = detail::partition(view, grain);
+    std::vector<Partial> partials(p.count(), Partial{identity});
+    pool.run(p.count(), [&](size_t i) { partials[i].value = map(view.slice(p.begin(i), p.end(i))); });
+
+    result_t result = identity;
+    for(const Partial &partial : partials)
+        result = combine(result, partial.value);
+    return result;
+}
+
+template< typename view_t, typename result_t, typename map_t, typename combine_t >
+result_t parallel_reduce(view_t view, size_t grain, result_t identity, map_t &&map, combine_t &&combine) {
+    return parallel_reduce(ThreadPool::shared(), view, grain, identity, std::forward<map_t>(map),
+        std::forward<combine_t>(combine));
+}
+
+
+
+inline ThreadPool::ThreadPool(size_t threads)
+    : mQueues(new Queue[threads + 1u])
+    , mQueueCount(threads + 1u)
+{
+    mWorkers.reserve(threads);
+    for(size_t i = 0; i < threads; ++i)
+        mWorkers.emplace_back([this, i]() { workerLoop(i); });
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mStop.store(true);
+    }
+    mWake.notify_all();
+    for(std::thread &worker : mWorkers)
+        worker.join();
+}
+
+inline ThreadPool &ThreadPool::shared() {
+    static ThreadPool pool(std::max(std::thread::hardware_concurrency(), 1u) - 1u);
+    return pool;
+}
+
+inline size_t ThreadPool::currentQueue() const {
+    return detail::current_worker.pool == this ? detail::current_worker.queue : mQueueCount - 1u;
+}
+
+inline void ThreadPool::push(size_t queue, const Range &range) {
+    {
+        std::lock_guard<std::mutex> lock(mQueues[queue].mutex);
+        mQueues[queue].ranges.push_back(range);
+    }
+    mQueued.fetch_add(1u);
+    // pairs with the increment of mSleeping in workerLoop: either the sleeper sees the work, or we see the sleeper
+    if(mSleeping.load() > 0u) {
+        std::lock_guard<std::mutex> lock(mSleepMutex);
+        mWake.notify_one();
+    }
+}
+
+inline bool ThreadPool::pop(size_t queue, Range &range) {
+    std::lock_guard<std::mutex> lock(mQueues[queue].mutex);
+    if(mQueues[queue].ranges.empty())
+        return false;
+    range = mQueues[queue].ranges.back();
+    mQueues[queue].ranges.pop_back();
+    mQueued.fetch_sub(1u);
+    return true;
+}
+
+inline bool ThreadPool::steal(size_t thief, Range &range) {
+    for(size_t i = 1; i < mQueueCount; ++i) {
+        Queue &victim = mQueues[(thief + i) % mQueueCount];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.ranges.empty()) {
+            range = victim.ranges.front();
+            victim.ranges.pop_front();
+            mQueued.fetch_sub(1u);
+            return true;
+        }
+    }
+    return false;
+}
+
+inline bool ThreadPool::runOne(size_t self) {
+    Range range;
+    if(!pop(self, range) && !steal(self, range))
+        return false;
+    execute(self, range);
+    return true;
+}
+
+inline void ThreadPool::execute(size_t self, Range range) {
+    // split down to a single index, leaving the back halves for thieves
+    while(range.end - range.begin > 1u) {
+        const size_t middle = range.begin + (range.end - range.begin) / 2u;
+        push(self, Range{range.job, middle, range.end});
+        range.end = middle;
+    }
+
+    Job &job = *range.job;
+    try {
+        (*job.task)(range.begin);
+    } catch(...) {
+        std::lock_guard<std::mutex> lock(job.errorMutex);
+        if(!job.error)
+            job.error = std::current_exception();
+    }
+    job.remaining.fetch_sub(1u, std::memory_order_acq_rel);
+}
+
+inline void ThreadPool::run(size_t count, const std::function<void(size_t)> &task) {
+    if(count == 0u)
+        return;
+
+    Job job;
+    job.task = &task;
+    job.remaining.store(count);
+
+    const size_t self = currentQueue();
+    execute(self, Range{&job, 0u, count});
+    // help until every index is done, which includes ranges other threads stole and are still working on
+    while(job.remaining.load(std::memory_order_acquire) > 0u) {
+        if(!runOne(self))
+            std::this_thread::yield();
+    }
+
+    if(job.error)
+        std::rethrow_exception(job.error);
+}
+
+inline void ThreadPool::workerLoop(size_t self) {
+    detail::current_worker = detail::WorkerIdentity{this, self};
+    while(!mStop.load()) {
+        if(runOne(self))
+            continue;
+
+        std::unique_lock<std::mutex> lock(mSleepMutex);
+        mSleeping.fetch_add(1u);
+        mWake.wait(lock, [this]() { return mQueued.load() > 0u || mStop.load(); });
+        mSleeping.fetch_sub(1u);
+    }
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,373 @@
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<chrono>
+#include<cstddef>
+#include<deque>
+#include<exception>
+#include<functional>
+#include<memory>
+#include<mutex>
+#include<optional>
+#include<stdexcept>
+#include<thread>
+#include<utility>
+#include<vector>
+
+#include "buffer.h"
+#include "buffer_pool.h"
+#include "parallel.h"
+#include "ring_buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A chain of stages that hand Buffers to each other, like read -> decode -> filter -> write, with every stage working
+ *  on its own thread so that I/O and compute overlap:
+ *      Pipeline pipeline;
+ *      auto raw = pipeline.source<uint8_t>([&](Blocks<uint8_t> &blocks) -> std::optional<Buffer<uint8_t>> {
+ *          if(!file.more())
+ *              return std::nullopt; // the end of the stream
+ *          Buffer<uint8_t> block = blocks.allocate(4096, uninitialized);
+ *          file.read(block.begin(), block.size());
+ *          return block;
+ *      });
+ *      // decode is a std::optional<Buffer<float>>(Buffer<uint8_t>, Blocks<float> &)
+ *      auto samples = pipeline.stage<float>(raw, decode);
+ *      auto filtered = pipeline.stage<float>(samples, filter, 3u); // triple-buffered
+ *      pipeline.sink(filtered, [&](Buffer<float> block) { write(block); });
+ *      pipeline.run();
+ *
+ *  Each stage passes its blocks on to the next over a RingBuffer, which moves the Buffers without touching their
+ *  reference counts. The depth of a stage is how many blocks may wait for the next one: with 2 a stage fills one block
+ *  while the next works on the one before. A stage whose output is full waits, and so does everything upstream of it,
+ *  so a slow stage slows the source down instead of piling up blocks.
+ *
+ *  Stages allocate their blocks through the Blocks they are handed, from a BufferPool of their own. Blocks come back to
+ *  that pool when whichever stage is last to see them lets go of them, so in the steady state the pipeline recycles the
+ *  same few blocks and never touches malloc. A stage that only changes its input can return it, which passes it on
+ *  without allocating at all. Returning std::nullopt from a stage drops the block, and from a source ends the stream.
+ *  Every stage keeps going until the ones before it are done and its input is empty.
+ *
+ *  run() runs every stage on a thread of its own. run(executor) spreads the stages over the tasks of a ThreadPool
+ *  instead, which take turns running whichever of their stages can go ahead. Those tasks all have to be running at the
+ *  same time, so don't share the executor with work that waits for the pipeline, and don't run parallel loops on it
+ *  from within the stages. Stages with nothing to do yield, and then sleep in steps of pipeline_idle_sleep, so an
+ *  idle pipeline doesn't keep cores busy. A block that arrives at a sleeping stage waits for up to that long.
+ *
+ *  If a stage throws, the pipeline stops and run() rethrows the exception. A Pipeline only runs once, and throws
+ *  std::logic_error when it is run again. It has to outlive every block its stages allocated.
+ */
+class Pipeline;
+
+inline constexpr std::chrono::microseconds pipeline_idle_sleep{50};
+
+
+/** How a stage allocates its blocks: from its own pool, on the thread that runs the stage */
+template< typename T >
+class Blocks
+{
+    public:
+    Buffer<T> allocate(size_t n);
+    Buffer<T> allocate(size_t n, uninitialized_t);
+
+    // the blocks from this stage that are still alive, wherever they are in the pipeline
+    size_t outstanding() const { return *mPool ? (*mPool)->outstanding() : 0u; }
+
+    private:
+    friend class Pipeline;
+
+    explicit Blocks(std::unique_ptr<BufferPool> &pool) : mPool(&pool) {}
+    // made on first use, which makes the thread that runs the stage the owner of the pool
+    BufferPool &pool();
+
+    std::unique_ptr<BufferPool> *mPool;
+};
+
+
+namespace detail
+{
+
+// what connects a stage to the next: the blocks that wait for it, and whether any more are coming
+template< typename T >
+struct PipelineLink
+{
+    explicit PipelineLink(size_t depth) : ring(depth), depth(depth) {}
+
+    bool has_room() const { return ring.size() < depth; }
+
+    RingBuffer<Buffer<T>> ring;
+    const size_t depth;
+    std::atomic<bool> closed{false}; // the producer has pushed its last block
+    bool connected = false;
+};
+
+enum class PipelineStep
+{
+    progressed,
+    waiting,
+    finished,
+};
+
+}// namespace detail
+
+
+/** The output of a stage, which exactly one later stage or sink has to take as its input */
+template< typename T >
+class Port
+{
+    private:
+    friend class Pipeline;
+
+    explicit Port(detail::PipelineLink<T> *link) : mLink(link) {}
+
+    detail::PipelineLink<T> *mLink;
+};
+
+
+class Pipeline
+{
+    public:
+    Pipeline() = default;
+
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+
+    // a stage without input: std::optional<Buffer<T>> f(Blocks<T> &), until it returns std::nullopt
+    template< typename T, typename function_t >
+    Port<T> source(function_t f, size_t depth = 2u);
+
+    // std::optional<Buffer<U>> f(Buffer<T> input, Blocks<U> &), once for every block of input
+    template< typename U, typename T, typename function_t >
+    Port<U> stage(Port<T> input, function_t f, size_t depth = 2u);
+
+    // void f(Buffer<T> input), once for every block of input
+    template< typename T, typename function_t >
+    void sink(Port<T> input, function_t f);
+
+    size_t stages() const { return mStages.size(); }
+
+    // runs every stage on a thread of its own until the stream has made it through, the last one on this thread
+    void run();
+    // the same, with the stages on executor.threads() + 1 tasks of the executor, at most one per stage
+    void run(ThreadPool &executor);
+
+    private:
+    struct Stage
+    {
+        std::function<detail::PipelineStep()> step; // runs the stage once, if it can go ahead
+        bool finished;                              // only touched by the thread that runs the stage
+    };
+
+    template< typename T >
+    detail::PipelineLink<T> *link(size_t depth);
+    template< typename T >
+    detail::PipelineLink<T> *connect(Port<T>);
+    std::unique_ptr<BufferPool> &pool();
+
+    void start();
+    // runs the stages first, first + step, first + 2 * step, ... until they are done or another one threw
+    void work(size_t first, size_t step);
+    void finish();
+
+    // destroyed in reverse: the stages, then the blocks waiting in the links, then the pools the blocks come from
+    std::deque<std::unique_ptr<BufferPool>> mPools;
+    std::vector<std::shared_ptr<void>> mLinks;
+    std::vector<Stage> mStages;
+    size_t mOpenPorts = 0u;
+    bool mStarted = false;
+
+    std::atomic<bool> mStop{false};
+    std::mutex mErrorMutex;
+    std::exception_ptr mError;
+};
+
+
+
+template< typename T >
+BufferPool &Blocks<T>::pool() {
+    if(!*mPool)
+        mPool->reset(new BufferPool());
+    return **mPool;
+}
+
+template< typename T >
+Buffer<T> Blocks<T>::allocate(size_t n) {
+    return Buffer<T>(n, pool());
+}
+
+template< typename T >
+Buffer<T> Blocks<T>::allocate(size_t n, uninitialized_t tag) {
+    return Buffer<T>(n, pool(), tag);
+}
+
+
+template< typename T >
+detail::PipelineLink<T> *Pipeline::link(size_t depth) {
+    if(depth == 0u)
+        throw std::invalid_argument("Pipeline: a stage needs a depth of at least one block");
+    auto created = std::make_shared<detail::PipelineLink<T>>(depth);
+    mLinks.push_back(created);
+    ++mOpenPorts;
+    return created.get();
+}
+
+template< typename T >
+detail::PipelineLink<T> *Pipeline::connect(Port<T> port) {
+    if(port.mLink->connected)
+        throw std::invalid_argument("Pipeline: the output of a stage can only be the input of one other stage");
+    port.mLink->connected = true;
+    --mOpenPorts;
+    return port.mLink;
+}
+
+inline std::unique_ptr<BufferPool> &Pipeline::pool() {
+    mPools.emplace_back();
+    return mPools.back();
+}
+
+template< typename T, typename function_t >
+Port<T> Pipeline::source(function_t f, size_t depth) {
+    detail::PipelineLink<T> *out = link<T>(depth);
+    Blocks<T> blocks(pool());
+    mStages.push_back(Stage{[f, out, blocks]() mutable {
+        if(!out->has_room())
+            return detail::PipelineStep::waiting;
+        std::optional<Buffer<T>> block = f(blocks);
+        if(!block) {
+            out->closed.store(true, std::memory_order_release);
+            return detail::PipelineStep::finished;
+        }
+        [[maybe_unused]] const bool pushed = out->ring.try_push(std::move(*block));
+        cpp_buffer_assert(pushed); // has_room() said there was
+        return detail::PipelineStep::progressed;
+    }, false});
+    return Port<T>(out);
+}
+
+template< typename U, typename T, typename function_t >
+Port<U> Pipeline::stage(Port<T> input, function_t f, size_t depth) {
+    detail::PipelineLink<T> *in = connect(input);
+    detail::PipelineLink<U> *out = link<U>(depth);
+    Blocks<U> blocks(pool());
+    mStages.push_back(Stage{[f, in, out, blocks]() mutable {
+        if(!out->has_room())
+            return detail::PipelineStep::waiting;
+        Buffer<T> block;
+        if(!in->ring.try_pop(block)) {
+            // the last block is pushed before the link is closed, so a closed link that is empty stays that way
+            if(!in->closed.load(std::memory_order_acquire) || !in->ring.empty())
+                return detail::PipelineStep::waiting;
+            out->closed.store(true, std::memory_order_release);
+            return detail::PipelineStep::finished;
+        }
+        std::optional<Buffer<U>> result = f(std::move(block), blocks);
+        if(result) {
+            [[maybe_unused]] const bool pushed = out->ring.try_push(std::move(*result));
+            cpp_buffer_assert(pushed);
+        }
+        return detail::PipelineStep::progressed;
+    }, false});
+    return Port<U>(out);
+}
+
+template< typename T, typename function_t >
+void Pipeline::sink(Port<T> input, function_t f) {
+    detail::PipelineLink<T> *in = connect(input);
+    mStages.push_back(Stage{[f, in]() mutable {
+        Buffer<T> block;
+        if(!in->ring.try_pop(block)) {
+            if(!in->closed.load(std::memory_order_acquire) || !in->ring.empty())
+                return detail::PipelineStep::waiting;
+            return detail::PipelineStep::finished;
+        }
+        f(std::move(block));
+        return detail::PipelineStep::progressed;
+    }, false});
+}
+
+inline void Pipeline::start() {
+    if(mStarted)
+        throw std::logic_error("Pipeline: a pipeline only runs once");
+    mStarted = true;
+    if(mOpenPorts != 0u)
+        throw std::invalid_argument("Pipeline: every stage needs a later stage or sink that takes its output");
+}
+
+inline void Pipeline::work(size_t first, size_t step) {
+    size_t idle = 0u;
+    while(!mStop.load(std::memory_order_relaxed)) {
+        bool progressed = false;
+        bool remaining = false;
+        for(size_t i = first; i < mStages.size(); i += step) {
+            Stage &stage = mStages[i];
+            if(stage.finished)
+                continue;
+
+            detail::PipelineStep result;
+            try {
+                result = stage.step();
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(mErrorMutex);
+                if(!mError)
+                    mError = std::current_exception();
+                mStop.store(true, std::memory_order_relaxed);
+                return;
+            }
+            stage.finished = result == detail::PipelineStep::finished;
+            remaining = remaining || !stage.finished;
+            progressed = progressed || result != detail::PipelineStep::waiting;
+        }
+        if(!remaining)
+            return;
+
+        // back off while the other stages catch up: a few yields first, then short sleeps
+        if(progressed)
+            idle = 0u;
+        else if(++idle < 64u)
+            std::this_thread::yield();
+        else
+            std::this_thread::sleep_for(pipeline_idle_sleep);
+    }
+}
+
+inline void Pipeline::finish() {
+    if(mError)
+        std::rethrow_exception(mError);
+}
+
+inline void Pipeline::run() {
+    start();
+    if(mStages.empty())
+        return;
+
+    const size_t count = mStages.size();
+    std::vector<std::thread> threads;
+    threads.reserve(count - 1u);
+    try {
+        for(size_t i = 0; i + 1u < count; ++i)
+            threads.emplace_back([this, i, count]() { work(i, count); });
+    } catch(...) {
+        mStop.store(true, std::memory_order_relaxed);
+        for(std::thread &thread : threads)
+            thread.join();
+        throw;
+    }
+    work(count - 1u, count);
+    for(std::thread &thread : threads)
+        thread.join();
+    finish();
+}
+
+inline void Pipeline::run(ThreadPool &executor) {
+    start();
+    const size_t tasks = std::min(executor.threads() + 1u, mStages.size());
+    if(tasks > 0u)
+        executor.run(tasks, [this, tasks](size_t task) { work(task, tasks); });
+    finish();
+}
+
+}// namespace CPPBuffer
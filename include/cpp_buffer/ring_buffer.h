@@ -0,0 +1,234 @@
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<cstddef>
+
+#include "buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A single-producer/single-consumer lock-free ring over a Buffer. Exactly one thread may call the producer half of
+ *  the API (push, write_regions, commit_write) and exactly one other the consumer half (pop, read_regions,
+ *  commit_read); size() and empty() are safe from either.
+ *
+ *  The capacity is a power of two, so positions are free-running counters masked into the buffer, and all of the
+ *  capacity is usable. Each side's position lives on its own cache line, together with that side's cached copy of the
+ *  other position, so the two threads only share a cache line when one of them actually runs out of room.
+ *
+ *  Besides element-wise and batch push and pop, the ring hands out the contiguous regions it can be written to or read
+ *  from directly, which is two regions when they wrap around the end of the buffer:
+ *      auto regions = ring.write_regions(n);
+ *      size_t written = produce(regions.first) + produce(regions.second);
+ *      ring.commit_write(written);
+ *  The regions are non-owning Slices, and stay valid until they are committed.
+ */
+template< typename T, typename ptr_t = std::shared_ptr<T> >
+class RingBuffer
+{
+    public:
+    //typedefs
+    typedef Buffer<T, 1u, ptr_t>    Storage;
+    typedef Slice<T, 1u, T *>       Region;
+
+    // the one or two contiguous pieces of the ring that can be accessed at once, in order
+    struct Regions
+    {
+        Region first;
+        Region second;
+
+        size_t size() const { return first.size() + second.size(); }
+    };
+
+    explicit RingBuffer(size_t capacity); // rounded up to a power of two
+    explicit RingBuffer(const Storage &storage); // the size of storage has to be a power of two
+
+    RingBuffer(const RingBuffer &) = delete;
+    RingBuffer &operator=(const RingBuffer &) = delete;
+
+    size_t capacity() const { return mStorage.size(); }
+    size_t size() const;
+    bool empty() const { return size() == 0u; }
+
+    // producer
+    bool try_push(const T &);
+    bool try_push(T &&);
+    size_t push(const T *, size_t); // copies as many elements as fit, and returns how many that was
+    template< typename view_t >
+    size_t push(const view_t &);
+    Regions write_regions(size_t max = size_t(-1));
+    void commit_write(size_t); // at most as many elements as the last write_regions handed out
+
+    // consumer
+    bool try_pop(T &);
+    size_t pop(T *, size_t); // moves out as many elements as there are, up to n, and returns how many that was
+    template< typename view_t >
+    size_t pop(view_t &&);
+    Regions read_regions(size_t max = size_t(-1));
+    void commit_read(size_t); // at most as many elements as the last read_regions handed out
+
+    private:
+    static size_t roundUpToPowerOfTwo(size_t);
+    Regions regions(size_t position, size_t count);
+
+    // the storage and mask are read-only after construction, so they can share a line
+    alignas(64) Storage mStorage;
+    size_t mMask;
+
+    // producer line
+    alignas(64) std::atomic<size_t> mHead{0u};
+    size_t mCachedTail = 0u;
+
+    // consumer line
+    alignas(64) std::atomic<size_t> mTail{0u};
+    size_t mCachedHead = 0u;
+};
+
+
+
+template< typename T, typename ptr_t >
+size_t RingBuffer<T, ptr_t>::roundUpToPowerOfTwo(size_t n) {
+    size_t capacity = 1u;
+    while(capacity < n)
+        capacity <<= 1;
+    return capacity;
+}
+
+template< typename T, typename ptr_t >
+RingBuffer<T, ptr_t>::RingBuffer(size_t capacity)
+    : RingBuffer(Storage(roundUpToPowerOfTwo(capacity), cache_line_aligned))
+{}
+
+template< typename T, typename ptr_t >
+RingBuffer<T, ptr_t>::RingBuffer(const Storage &storage)
+    : mStorage(storage)
+    , mMask(storage.size() - 1u)
+{
+    cpp_buffer_assert(storage.size() > 0u && (storage.size() & mMask) == 0u);
+}
+
+template< typename T, typename ptr_t >
+size_t RingBuffer<T, ptr_t>::size() const {
+    const size_t tail = mTail.load(std::memory_order_acquire);
+    const size_t head = mHead.load(std::memory_order_acquire);
+    return head - tail;
+}
+
+template< typename T, typename ptr_t >
+typename RingBuffer<T, ptr_t>::Regions RingBuffer<T, ptr_t>::regions(size_t position, size_t count) {
+    T *memory = mStorage.begin();
+    const size_t offset = position & mMask;
+    const size_t first = std::min(count, capacity() - offset);
+    return Regions{
+        Buffer<T, 1u, T *>(memory + offset, first).slice(),
+        Buffer<T, 1u, T *>(memory, count - first).slice(),
+    };
+}
+
+// producer
+template< typename T, typename ptr_t >
+typename RingBuffer<T, ptr_t>::Regions RingBuffer<T, ptr_t>::write_regions(size_t max) {
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    if(capacity() - (head - mCachedTail) < max)
+        mCachedTail = mTail.load(std::memory_order_acquire);
+    return regions(head, std::min(max, capacity() - (head - mCachedTail)));
+}
+
+template< typename T, typename ptr_t >
+void RingBuffer<T, ptr_t>::commit_write(size_t n) {
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    cpp_buffer_assert(n <= capacity() - (head - mCachedTail));
+    mHead.store(head + n, std::memory_order_release);
+}
+
+template< typename T, typename ptr_t >
+bool RingBuffer<T, ptr_t>::try_push(const T &value) {
+    T copy(value);
+    return try_push(std::move(copy));
+}
+
+template< typename T, typename ptr_t >
+bool RingBuffer<T, ptr_t>::try_push(T &&value) {
+    const size_t head = mHead.load(std::memory_order_relaxed);
+    if(head - mCachedTail == capacity()) {
+        mCachedTail = mTail.load(std::memory_order_acquire);
+        if(head - mCachedTail == capacity())
+            return false;
+    }
+    mStorage.begin()[head & mMask] = std::move(value);
+    mHead.store(head + 1u, std::memory_order_release);
+    return true;
+}
+
+template< typename T, typename ptr_t >
+size_t RingBuffer<T, ptr_t>::push(const T *src, size_t n) {
+    Regions r = write_regions(n);
+    std::copy(src, src + r.first.size(), r.first.begin());
+    std::copy(src + r.first.size(), src + r.size(), r.second.begin());
+    commit_write(r.size());
+    return r.size();
+}
+
+template< typename T, typename ptr_t >
+template< typename view_t >
+size_t RingBuffer<T, ptr_t>::push(const view_t &src) {
+    Regions r = write_regions(src.size());
+    auto it = src.begin();
+    std::copy_n(it, r.first.size(), r.first.begin());
+    std::copy_n(it + r.first.size(), r.second.size(), r.second.begin());
+    commit_write(r.size());
+    return r.size();
+}
+
+// consumer
+template< typename T, typename ptr_t >
+typename RingBuffer<T, ptr_t>::Regions RingBuffer<T, ptr_t>::read_regions(size_t max) {
+    const size_t tail = mTail.load(std::memory_order_relaxed);
+    if(mCachedHead - tail < max)
+        mCachedHead = mHead.load(std::memory_order_acquire);
+    return regions(tail, std::min(max, mCachedHead - tail));
+}
+
+template< typename T, typename ptr_t >
+void RingBuffer<T, ptr_t>::commit_read(size_t n) {
+    const size_t tail = mTail.load(std::memory_order_relaxed);
+    cpp_buffer_assert(n <= mCachedHead - tail);
+    mTail.store(tail + n, std::memory_order_release);
+}
+
+template< typename T, typename ptr_t >
+bool RingBuffer<T, ptr_t>::try_pop(T &value) {
+    const size_t tail = mTail.load(std::memory_order_relaxed);
+    if(tail == mCachedHead) {
+        mCachedHead = mHead.load(std::memory_order_acquire);
+        if(tail == mCachedHead)
+            return false;
+    }
+    value = std::move(mStorage.begin()[tail & mMask]);
+    mTail.store(tail + 1u, std::memory_order_release);
+    return true;
+}
+
+template< typename T, typename ptr_t >
+size_t RingBuffer<T, ptr_t>::pop(T *dst, size_t n) {
+    Regions r = read_regions(n);
+    std::move(r.first.begin(), r.first.end(), dst);
+    std::move(r.second.begin(), r.second.end(), dst + r.first.size());
+    commit_read(r.size());
+    return r.size();
+}
+
+template< typename T, typename ptr_t >
+template< typename view_t >
+size_t RingBuffer<T, ptr_t>::pop(view_t &&dst) {
+    Regions r = read_regions(dst.size());
+    auto it = std::move(r.first.begin(), r.first.end(), dst.begin());
+    std::move(r.second.begin(), r.second.end(), it);
+    commit_read(r.size());
+    return r.size();
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,290 @@
+#pragma once
+
+#include<algorithm>
+#include<cstddef>
+#include<cstdint>
+#include<cstring>
+#include<memory>
+#include<new>
+#include<stdexcept>
+#include<type_traits>
+
+#include "algorithms.h"
+#include "buffer.h"
+
+
+/**
+ *  A framed binary format for the contents of Buffers and Slices, for sending them to other processes or to disk:
+ *      Buffer<uint8_t> frame = serialize(samples);
+ *      ...
+ *      Buffer<float> received = deserialize<float>(bytes);        // no copy when the payload is aligned
+ *
+ *  A frame is a 16 byte header, padding up to the payload alignment, the elements, and more padding up to the next
+ *  multiple of the alignment, so frames written back to back keep their payloads aligned:
+ *      bytes 0-3       magic "CPBF"
+ *      byte 4          format version
+ *      byte 5          element type, an ElementType
+ *      byte 6          element size in bytes
+ *      byte 7          bits 0-5: log2 of the payload alignment, bit 7: set for a big-endian payload and count
+ *      bytes 8-15      element count, as a uint64_t
+ *      from round_up(16, alignment) on: the elements, in the byte order of the flags
+ *
+ *  Any trivially copyable element type can be framed. Arithmetic types get their own tag and are byte-swapped when the
+ *  frame comes from a machine of the other byte order, everything else is tagged opaque and only checked for its size,
+ *  which has to fit in a byte.
+ *
+ *  deserialize() hands out a Buffer pointing straight into the received bytes when the payload is aligned for T and in
+ *  native byte order, keeping the bytes alive for as long as the Buffer is. Otherwise it decodes into a new Buffer.
+ *  Malformed frames, and frames of another element type, throw a FrameError.
+ */
+
+namespace CPPBuffer
+{
+
+enum class ElementType : uint8_t
+{
+    opaque = 0,     // any other trivially copyable type, checked by its size only
+    u8, i8, u16, i16, u32, i32, u64, i64, f32, f64,
+};
+
+/** Thrown for bytes that aren't a frame of the expected element type */
+class FrameError : public std::runtime_error
+{
+    public:
+    using std::runtime_error::runtime_error;
+};
+
+/** What a frame header says */
+struct FrameInfo
+{
+    ElementType type;
+    size_t elementBytes;
+    uint64_t count;
+    bool bigEndian;
+    size_t alignment;       // of the payload, relative to the start of the frame
+    size_t payloadOffset;   // from the start of the frame
+    size_t frameBytes;      // the whole frame, with its trailing padding
+
+    // whether the payload is in this machine's byte order
+    bool native() const;
+};
+
+
+/** The element type tag for T */
+template< typename T >
+constexpr ElementType element_type();
+
+/** The bytes serialize() writes for view, with its payload aligned to alignment, a power of two */
+template< typename view_t >
+size_t frame_size(const view_t &view, size_t alignment = alignof(detail::element_t<const view_t>));
+
+/** Writes view as a frame to out, which needs room for frame_size() bytes, and returns how many bytes it wrote */
+template< typename view_t >
+size_t serialize(const view_t &view, uint8_t *out, size_t capacity,
+    size_t alignment = alignof(detail::element_t<const view_t>));
+
+/** view as a frame, in a new byte Buffer whose start is aligned like the payload */
+template< typename view_t >
+Buffer<uint8_t> serialize(const view_t &view, size_t alignment = alignof(detail::element_t<const view_t>));
+
+/** Parses and checks the frame header at the start of bytes, size bytes long */
+FrameInfo read_frame(const uint8_t *bytes, size_t size);
+
+/**
+ *  The elements of the frame at offset in bytes, a byte Buffer or unit-strided byte Slice. The result aliases the
+ *  ownership of bytes when the payload can be used in place, and is a decoded copy when it can't. Writing to the
+ *  elements of an aliasing result writes to the bytes.
+ */
+template< typename T, typename bytes_t >
+Buffer<T> deserialize(bytes_t bytes, size_t offset = 0u);
+
+
+
+namespace detail
+{
+
+constexpr uint8_t frame_magic[4] = {'C', 'P', 'B', 'F'};
+constexpr uint8_t frame_version = 1u;
+constexpr size_t frame_header_bytes = 16u;
+constexpr uint8_t frame_big_endian = 0x80u;
+constexpr uint8_t frame_alignment_bits = 0x3fu;
+
+inline bool native_big_endian() {
+    const uint16_t probe = 1u;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1u);
+    return first == 0u;
+}
+
+inline void byte_swap(uint8_t *p, size_t bytes) {
+    std::reverse(p, p + bytes);
+}
+
+inline size_t log2_of(size_t alignment) {
+    size_t shift = 0u;
+    while((size_t(1u) << shift) < alignment)
+        ++shift;
+    return shift;
+}
+
+inline size_t payload_offset(size_t alignment) {
+    return round_up(frame_header_bytes, alignment);
+}
+
+template< typename pointer_t >
+struct is_shared_ptr : std::false_type {};
+
+template< typename U >
+struct is_shared_ptr<std::shared_ptr<U>> : std::true_type {};
+
+// whether a view's memory is owned by a std::shared_ptr, which pointers into the memory can share without a control
+// block of their own
+template< typename view_t, typename = void >
+struct owned_by_shared_ptr : std::false_type {};
+
+template< typename view_t >
+struct owned_by_shared_ptr<view_t, std::void_t<decltype(std::declval<const view_t &>().pointer())>>
+    : is_shared_ptr<std::decay_t<decltype(std::declval<const view_t &>().pointer())>>
+{};
+
+}// namespace detail
+
+
+template< typename T >
+constexpr ElementType element_type() {
+    typedef typename std::remove_cv<T>::type U;
+    static_assert(std::is_trivially_copyable<U>::value && sizeof(U) <= 255u,
+        "only trivially copyable elements of up to 255 bytes can be framed");
+    if constexpr(std::is_floating_point<U>::value && sizeof(U) == 4u)
+        return ElementType::f32;
+    else if constexpr(std::is_floating_point<U>::value && sizeof(U) == 8u)
+        return ElementType::f64;
+    else if constexpr(std::is_integral<U>::value && !std::is_same<U, bool>::value) {
+        constexpr bool isSigned = std::is_signed<U>::value;
+        switch(sizeof(U)) {
+            case 1u: return isSigned ? ElementType::i8 : ElementType::u8;
+            case 2u: return isSigned ? ElementType::i16 : ElementType::u16;
+            case 4u: return isSigned ? ElementType::i32 : ElementType::u32;
+            case 8u: return isSigned ? ElementType::i64 : ElementType::u64;
+        }
+        return ElementType::opaque;
+    } else
+        return ElementType::opaque;
+}
+
+inline bool FrameInfo::native() const {
+    return bigEndian == detail::native_big_endian();
+}
+
+template< typename view_t >
+size_t frame_size(const view_t &view, size_t alignment) {
+    typedef detail::element_t<const view_t> T;
+    cpp_buffer_assert(alignment > 0u && (alignment & (alignment - 1u)) == 0u);
+    return detail::round_up(detail::payload_offset(alignment) + view.size() * sizeof(T), alignment);
+}
+
+template< typename view_t >
+size_t serialize(const view_t &view, uint8_t *out, size_t capacity, size_t alignment) {
+    typedef typename std::remove_const<detail::element_t<const view_t>>::type T;
+    const size_t bytes = frame_size(view, alignment);
+    cpp_buffer_assert(capacity >= bytes);
+
+    const uint64_t count = view.size();
+    const size_t offset = detail::payload_offset(alignment);
+    std::memcpy(out, detail::frame_magic, 4u);
+    out[4] = detail::frame_version;
+    out[5] = static_cast<uint8_t>(element_type<T>());
+    out[6] = static_cast<uint8_t>(sizeof(T));
+    const uint8_t byteOrder = detail::native_big_endian() ? detail::frame_big_endian : 0u;
+    out[7] = static_cast<uint8_t>(detail::log2_of(alignment) | byteOrder);
+    std::memcpy(out + 8u, &count, sizeof(count));
+    std::fill(out + detail::frame_header_bytes, out + offset, uint8_t(0u));
+
+    // the payload is raw memory that may not be aligned for T, so strided views are gathered a whole element at a time
+    uint8_t *payload = out + offset;
+    if constexpr(detail::stride_of<const view_t>() == 1u) {
+        if(count > 0u)
+            std::memcpy(payload, detail::memory_of(view), count * sizeof(T));
+    } else {
+        for(const T &element : view) {
+            std::memcpy(payload, &element, sizeof(T));
+            payload += sizeof(T);
+        }
+    }
+    std::fill(out + offset + count * sizeof(T), out + bytes, uint8_t(0u));
+    return bytes;
+}
+
+template< typename view_t >
+Buffer<uint8_t> serialize(const view_t &view, size_t alignment) {
+    const size_t bytes = frame_size(view, alignment);
+    Buffer<uint8_t> frame(bytes, std::align_val_t(std::max(alignment, alignof(std::max_align_t))), uninitialized);
+    serialize(view, frame.begin(), bytes, alignment);
+    return frame;
+}
+
+inline FrameInfo read_frame(const uint8_t *bytes, size_t size) {
+    if(size < detail::frame_header_bytes || std::memcmp(bytes, detail::frame_magic, 4u) != 0)
+        throw FrameError("not a frame");
+    if(bytes[4] != detail::frame_version)
+        throw FrameError("unsupported frame version");
+    const size_t shift = bytes[7] & detail::frame_alignment_bits;
+    if(bytes[5] > static_cast<uint8_t>(ElementType::f64) || bytes[6] == 0u || shift >= 8u * sizeof(size_t))
+        throw FrameError("corrupt frame header");
+
+    FrameInfo info;
+    info.type = static_cast<ElementType>(bytes[5]);
+    info.elementBytes = bytes[6];
+    info.bigEndian = (bytes[7] & detail::frame_big_endian) != 0u;
+    info.alignment = size_t(1u) << shift;
+    info.payloadOffset = detail::payload_offset(info.alignment);
+    std::memcpy(&info.count, bytes + 8u, sizeof(info.count));
+    if(!info.native())
+        detail::byte_swap(reinterpret_cast<uint8_t *>(&info.count), sizeof(info.count));
+
+    // checking the count on its own first keeps the product from overflowing
+    if(info.payloadOffset > size || info.count > size || info.count * info.elementBytes > size - info.payloadOffset)
+        throw FrameError("truncated frame");
+    // the trailing padding may be missing from the last frame of a file, it is never read
+    info.frameBytes = std::min(size, detail::round_up(info.payloadOffset + info.count * info.elementBytes,
+        info.alignment));
+    return info;
+}
+
+template< typename T, typename bytes_t >
+Buffer<T> deserialize(bytes_t bytes, size_t offset) {
+    static_assert(std::is_same<detail::element_t<bytes_t>, uint8_t>::value && detail::stride_of<bytes_t>() == 1u,
+        "frames are read from contiguous, writable bytes");
+    cpp_buffer_assert(offset <= bytes.size());
+
+    uint8_t *frame = detail::memory_of(bytes) + offset;
+    const FrameInfo info = read_frame(frame, bytes.size() - offset);
+    if(info.type != element_type<T>() || info.elementBytes != sizeof(T))
+        throw FrameError("frame holds another element type");
+    if(!info.native() && info.type == ElementType::opaque)
+        throw FrameError("opaque elements can't be byte-swapped");
+
+    uint8_t *payload = frame + info.payloadOffset;
+    const size_t count = static_cast<size_t>(info.count);
+    if(info.native() && reinterpret_cast<uintptr_t>(payload) % alignof(T) == 0u) {
+        // in place: the new pointer shares ownership of the bytes, or when that is no std::shared_ptr, gets a control
+        // block that keeps a copy of the byte view, and with it the bytes
+        if constexpr(detail::owned_by_shared_ptr<bytes_t>::value)
+            return Buffer<T>(std::shared_ptr<T>(bytes.pointer(), reinterpret_cast<T *>(payload)), count);
+        else {
+            std::shared_ptr<T> memory(reinterpret_cast<T *>(payload), [bytes](T *) {});
+            return Buffer<T>(std::move(memory), count);
+        }
+    }
+
+    Buffer<T> decoded(count, uninitialized);
+    if(count > 0u)
+        std::memcpy(static_cast<void *>(decoded.begin()), payload, count * sizeof(T));
+    if(!info.native() && sizeof(T) > 1u) {
+        for(T &element : decoded)
+            detail::byte_swap(reinterpret_cast<uint8_t *>(&element), sizeof(T));
+    }
+    return decoded;
+}
+
+}// namespace CPPBuffer
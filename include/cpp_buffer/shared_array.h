@@ -0,0 +1,316 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<memory>
+#include<new>
+#include<type_traits>
+
+#include "instrumentation.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  Tag type for constructors that skip initializing their elements. Only meaningful for trivially constructible types,
+ *  where it avoids zero-filling memory that is about to be overwritten anyway:
+ *      Buffer<float> samples(n, uninitialized);
+ *      read(fd, samples.begin(), size_of(samples));
+ */
+struct uninitialized_t
+{
+    explicit uninitialized_t() = default;
+};
+inline constexpr uninitialized_t uninitialized{};
+
+
+/**
+ *  Alignments for Buffer(size_t, std::align_val_t): a cache line, which is also the widest SIMD register on current
+ *  hardware, and a page.
+ */
+inline constexpr std::align_val_t cache_line_aligned{64u};
+inline constexpr std::align_val_t page_aligned{4096u};
+
+
+/**
+ *  The default upstream for array allocations: global operator new, over-aligned when asked to be.
+ *
+ *  Anything with the same two member functions can stand in for it: make_shared_array only ever asks its resource for
+ *  a number of bytes at an alignment, and hands back exactly the same numbers when it is done with them.
+ */
+struct NewDeleteResource
+{
+    void *allocate(size_t bytes, size_t alignment) {
+        if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            return ::operator new(bytes, std::align_val_t(alignment));
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void *p, size_t bytes, size_t alignment) {
+        if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(p, bytes, std::align_val_t(alignment));
+        else
+            ::operator delete(p, bytes);
+    }
+
+    static NewDeleteResource &instance() {
+        static NewDeleteResource resource;
+        return resource;
+    }
+};
+
+
+namespace detail
+{
+
+// detects the allocate(bytes, alignment) / deallocate(p, bytes, alignment) interface of NewDeleteResource
+template< typename resource_t, typename = void >
+struct is_resource : std::false_type {};
+
+template< typename resource_t >
+struct is_resource<resource_t, decltype(void(
+    static_cast<void *>(std::declval<resource_t &>().allocate(size_t(), size_t()))),
+    std::declval<resource_t &>().deallocate(static_cast<void *>(nullptr), size_t(), size_t())
+    )> : std::true_type {};
+
+inline size_t round_up(size_t n, size_t alignment) {
+    return (n + alignment - 1u) & ~(alignment - 1u);
+}
+
+// throws, like new T[n] does, unless n elements of T and then extra bytes fit into a size_t
+template< typename T >
+void check_array_length(size_t n, size_t extra = 0u) {
+    if(n > (SIZE_MAX - extra) / sizeof(T))
+        throw std::bad_array_new_length();
+}
+
+// Tag for allocations that copy-construct their elements from source[0, n) instead of initializing them
+template< typename T >
+struct copied_from
+{
+    const T *source;
+};
+
+// how the allocations construct element i: value-initialized, default-initialized, or copied
+template< typename T >
+void construct_element(T *p, size_t) {
+    ::new(static_cast<void *>(p)) T();
+}
+
+template< typename T >
+void construct_element(T *p, size_t, uninitialized_t) {
+    static_assert(std::is_trivially_default_constructible<T>::value,
+        "only trivially constructible types can be left uninitialized");
+    ::new(static_cast<void *>(p)) T;
+}
+
+template< typename T >
+void construct_element(T *p, size_t i, copied_from<T> from) {
+    ::new(static_cast<void *>(p)) T(from.source[i]);
+}
+
+/**
+ *  The object that std::allocate_shared places in the control block. It owns the elements, which live directly after
+ *  the control block in the same allocation, and destroys them when the last shared_ptr goes away.
+ */
+template< typename T >
+class SharedArrayHeader
+{
+    public:
+    // constructs every element the way construct_element does for init
+    template< typename ... init_t >
+    SharedArrayHeader(void *const &location, size_t n, init_t ... init)
+        : mData(static_cast<T *>(location))
+        , mSize(n)
+    {
+        size_t i = 0;
+        try {
+            for(; i < mSize; ++i)
+                construct_element(mData + i, i, init...);
+        } catch(...) {
+            destroy(i);
+            throw;
+        }
+    }
+
+    SharedArrayHeader(const SharedArrayHeader &) = delete;
+    SharedArrayHeader &operator=(const SharedArrayHeader &) = delete;
+
+    ~SharedArrayHeader() {
+        destroy(mSize);
+    }
+
+    T *data() const { return mData; }
+
+    private:
+    void destroy(size_t n) {
+        if(!std::is_trivially_destructible<T>::value) {
+            while(n > 0)
+                mData[--n].~T();
+        }
+    }
+
+    T *mData;
+    size_t mSize;
+};
+
+/**
+ *  The allocator handed to std::allocate_shared. Whatever it gets rebound to (in practice the control block type), it
+ *  asks the resource for that many bytes plus room for the array, and reports where the array starts through
+ *  mArrayLocation. That is how the control block and the elements end up in a single allocation.
+ *
+ *  The array goes first and the control block after it, so an over-aligned array doesn't have to pad the control block
+ *  out to its alignment: a page-aligned buffer costs one page less than it would the other way around.
+ */
+template< typename U, typename resource_t >
+class ArrayBlockAllocator
+{
+    public:
+    typedef U value_type;
+
+    ArrayBlockAllocator(resource_t &resource, size_t arrayBytes, size_t arrayAlignment, void **arrayLocation)
+        : mResource(&resource)
+        , mArrayBytes(arrayBytes)
+        , mArrayAlignment(arrayAlignment)
+        , mArrayLocation(arrayLocation)
+    {}
+
+    template< typename V >
+    ArrayBlockAllocator(const ArrayBlockAllocator<V, resource_t> &other)
+        : mResource(other.mResource)
+        , mArrayBytes(other.mArrayBytes)
+        , mArrayAlignment(other.mArrayAlignment)
+        , mArrayLocation(other.mArrayLocation)
+    {}
+
+    U *allocate(size_t n) {
+        check_array_length<U>(n, mArrayBytes + (alignof(U) - 1u)); // the caller made sure that sum doesn't wrap
+        char *block = static_cast<char *>(mResource->allocate(blockBytes(n), blockAlignment()));
+        CPPBUFFER_RECORD_ALLOCATION(blockBytes(n));
+        *mArrayLocation = block;
+        return reinterpret_cast<U *>(block + arrayExtent());
+    }
+
+    void deallocate(U *p, size_t n) {
+        CPPBUFFER_RECORD_DEALLOCATION(blockBytes(n));
+        mResource->deallocate(reinterpret_cast<char *>(p) - arrayExtent(), blockBytes(n), blockAlignment());
+    }
+
+    template< typename V >
+    bool operator==(const ArrayBlockAllocator<V, resource_t> &other) const {
+        return mResource == other.mResource
+            && mArrayBytes == other.mArrayBytes
+            && mArrayAlignment == other.mArrayAlignment;
+    }
+
+    template< typename V >
+    bool operator!=(const ArrayBlockAllocator<V, resource_t> &other) const {
+        return !(*this == other);
+    }
+
+    private:
+    template< typename, typename >
+    friend class ArrayBlockAllocator;
+
+    size_t arrayExtent() const { return round_up(mArrayBytes, alignof(U)); }
+    size_t blockBytes(size_t n) const { return arrayExtent() + n * sizeof(U); }
+    size_t blockAlignment() const { return mArrayAlignment > alignof(U) ? mArrayAlignment : alignof(U); }
+
+    resource_t *mResource;
+    size_t mArrayBytes;
+    size_t mArrayAlignment;
+    void **mArrayLocation; // only written to while allocate_shared is running
+};
+
+}// namespace detail
+
+
+/**
+ *  Allocates n elements and their shared_ptr control block in one allocation from resource, like the C++20
+ *  std::allocate_shared<T[]>. The returned pointer aliases the control block and points at the first element, which is
+ *  aligned to at least alignment (a power of two) and alignof(T).
+ *
+ *  The extra arguments are forwarded to the element initialization, so pass uninitialized to skip it, or
+ *  detail::copied_from to copy the elements of another array.
+ */
+template< typename T, typename resource_t, typename ... init_t >
+std::shared_ptr<T> make_shared_array(size_t n, size_t alignment, resource_t &resource, init_t ... init) {
+    if(alignment < alignof(T))
+        alignment = alignof(T);
+
+    // leaves room for the padding and the control block, which ArrayBlockAllocator checks once it knows their size
+    detail::check_array_length<T>(n, 4096u);
+    void *location = nullptr;
+    detail::ArrayBlockAllocator<detail::SharedArrayHeader<T>, resource_t>
+        allocator(resource, n * sizeof(T), alignment, &location);
+    auto header = std::allocate_shared<detail::SharedArrayHeader<T>>(allocator, location, n, init...);
+
+    T *data = header->data();
+    return std::shared_ptr<T>(header, data);
+}
+
+template< typename T >
+std::shared_ptr<T> make_shared_array(size_t n) {
+    return make_shared_array<T>(n, alignof(T), NewDeleteResource::instance());
+}
+
+template< typename T >
+std::shared_ptr<T> make_shared_array(size_t n, uninitialized_t tag) {
+    return make_shared_array<T>(n, alignof(T), NewDeleteResource::instance(), tag);
+}
+
+/**
+ *  How the allocating Buffer constructors get their memory for a given ptr_t. A pointer type opts in by specializing
+ *  this with a make(n, alignment, resource, init...) that returns an owning ptr_t to n elements, initialized the way
+ *  make_shared_array does it. std::shared_ptr is built in.
+ */
+template< typename ptr_t >
+struct PointerAllocation;
+
+template< typename T >
+struct PointerAllocation<std::shared_ptr<T>>
+{
+    template< typename resource_t, typename ... init_t >
+    static std::shared_ptr<T> make(size_t n, size_t alignment, resource_t &resource, init_t ... init) {
+        return make_shared_array<T>(n, alignment, resource, init...);
+    }
+};
+
+
+/**
+ *  Allocates n value-initialized elements through a standard allocator. The allocator also provides the control
+ *  block, and gets the memory back when the last shared_ptr goes away.
+ */
+template< typename T, typename allocator_t >
+std::shared_ptr<T> make_allocated_array(size_t n, const allocator_t &allocator) {
+    typedef typename std::allocator_traits<allocator_t>::template rebind_alloc<T> element_allocator_t;
+    typedef std::allocator_traits<element_allocator_t> traits;
+
+    detail::check_array_length<T>(n);
+    element_allocator_t elements(allocator);
+    T *data = traits::allocate(elements, n);
+    CPPBUFFER_RECORD_ALLOCATION(n * sizeof(T));
+
+    size_t i = 0;
+    try {
+        for(; i < n; ++i)
+            traits::construct(elements, data + i);
+    } catch(...) {
+        while(i > 0)
+            traits::destroy(elements, data + --i);
+        traits::deallocate(elements, data, n);
+        CPPBUFFER_RECORD_DEALLOCATION(n * sizeof(T));
+        throw;
+    }
+
+    auto deleter = [elements, n](T *p) mutable {
+        for(size_t j = n; j > 0; --j)
+            traits::destroy(elements, p + j - 1u);
+        traits::deallocate(elements, p, n);
+        CPPBUFFER_RECORD_DEALLOCATION(n * sizeof(T));
+    };
+    return std::shared_ptr<T>(data, deleter, elements);
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,450 @@
+#pragma once
+
+#include<algorithm>
+#include<atomic>
+#include<cerrno>
+#include<cstddef>
+#include<cstdint>
+#include<cstdio>
+#include<cstring>
+#include<new>
+#include<stdexcept>
+#include<system_error>
+#include<type_traits>
+#include<utility>
+
+#include<fcntl.h>
+#include<sys/mman.h>
+#include<sys/socket.h>
+#include<sys/stat.h>
+#include<sys/uio.h>
+#include<unistd.h>
+
+#include "buffer.h"
+#include "mapped_buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A POSIX shared memory object, for handing Buffers between processes on the same host without copying them through
+ *  a socket or pipe (POSIX only). Every process maps the object into Buffers of its own, and then uses them like any
+ *  other Buffer: writes through one process's Buffer are seen through every other's.
+ *      SharedMemory memory = SharedMemory::create(n * sizeof(float));
+ *      Buffer<float> samples = memory.map<float>();
+ *      send_fd(socket, memory.fd());                   // or hand over a name, see below
+ *      ...
+ *      SharedMemory received(receive_fd(socket));      // in the other process
+ *      Buffer<const float> view = received.map<const float>();
+ *
+ *  Anonymous objects come from memfd_create on Linux, and from an immediately unlinked shm_open elsewhere, and are
+ *  only reachable through their descriptor: pass it over a Unix socket with send_fd() or inherit it across fork().
+ *  Named objects can be opened by name from unrelated processes, and last until they are unlinked.
+ *
+ *  The SharedMemory owns its descriptor, and closes it on destruction. Mappings don't need it: the Buffers from
+ *  map() keep the memory alive on their own, until the last one sharing a mapping goes away. Map with a const T for a
+ *  read-only view. The memory starts out zeroed. Failures throw a std::system_error carrying errno.
+ *
+ *  The elements are the same bytes in every process, so T has to be trivially copyable, and must not hold pointers.
+ */
+class SharedMemory
+{
+    public:
+    // an anonymous object of bytes
+    static SharedMemory create(size_t bytes);
+    // a new object of bytes, under a name of the form "/name" that other processes can open()
+    static SharedMemory create(const char *name, size_t bytes);
+    // an existing named object
+    static SharedMemory open(const char *name);
+    // removes a name, the object itself lives on as long as it is open or mapped anywhere
+    static void unlink(const char *name);
+
+    // takes over fd, for example one from receive_fd()
+    explicit SharedMemory(int fd);
+    SharedMemory(SharedMemory &&);
+    SharedMemory &operator=(SharedMemory &&);
+    ~SharedMemory();
+
+    SharedMemory(const SharedMemory &) = delete;
+    SharedMemory &operator=(const SharedMemory &) = delete;
+
+    int fd() const { return mFd; }
+    size_t size() const { return mBytes; } // in bytes
+
+    // maps count elements (or all that fit, if count is size_t(-1)) from byte offset on, shared with other processes
+    template< typename T >
+    Buffer<T> map(size_t offset = 0u, size_t count = size_t(-1)) const;
+
+    private:
+    static SharedMemory sized(int fd, size_t bytes);
+
+    int mFd;
+    size_t mBytes;
+};
+
+/** Sends a copy of fd over a connected Unix domain socket, for the other end to pick up with receive_fd() */
+inline void send_fd(int socket, int fd);
+
+/** Receives a descriptor sent with send_fd(), which the caller then owns */
+inline int receive_fd(int socket);
+
+
+/**
+ *  A single-producer/single-consumer ring in shared memory, for streaming elements from one process to another. It
+ *  works like RingBuffer, with the producer half of the API used in one process and the consumer half in another:
+ *      SharedRing<float> ring(4096);           // the producer creates it
+ *      send_fd(socket, ring.memory().fd());
+ *      auto regions = ring.write_regions(n);   // and writes straight into the shared memory
+ *      ...
+ *      SharedRing<float> ring(SharedMemory(receive_fd(socket))); // and the consumer attaches to it
+ *      auto regions = ring.read_regions();
+ *
+ *  The positions live at the start of the shared object, each on its own cache line, followed by the elements. Each
+ *  process keeps its cached copy of the other side's position to itself, the same as RingBuffer does for threads.
+ *  The regions are non-owning Slices into this process's mapping, and stay valid until they are committed.
+ *
+ *  The capacity is a power of two. Elements have to be trivially copyable, and the positions have to be lock-free
+ *  atomics, which use no process-local state. Attaching to memory that doesn't hold a ring throws
+ *  std::invalid_argument.
+ *
+ *  Neither process trusts the positions the other one writes: a peer that moves them further apart than the capacity,
+ *  or past each other, has corrupted the ring, and the regions of the side that notices throw std::runtime_error
+ *  instead of reaching past the mapping. Committing more than the regions handed out fails cpp_buffer_assert.
+ */
+template< typename T >
+class SharedRing
+{
+    public:
+    //typedefs
+    typedef Slice<T, 1u, T *>       Region;
+
+    struct Regions
+    {
+        Region first;
+        Region second;
+
+        size_t size() const { return first.size() + second.size(); }
+    };
+
+    explicit SharedRing(size_t capacity); // in a new anonymous object, rounded up to a power of two
+    explicit SharedRing(SharedMemory memory); // attaches to a ring another process created
+
+    SharedRing(const SharedRing &) = delete;
+    SharedRing &operator=(const SharedRing &) = delete;
+
+    // the object the ring lives in, to pass to the other process
+    const SharedMemory &memory() const { return mMemory; }
+
+    size_t capacity() const { return mMask + 1u; }
+    size_t size() const; // a snapshot, which is never more than the capacity
+    bool empty() const { return size() == 0u; }
+
+    // producer
+    bool try_push(const T &);
+    size_t push(const T *, size_t); // copies as many elements as fit, and returns how many that was
+    Regions write_regions(size_t max = size_t(-1));
+    void commit_write(size_t);
+
+    // consumer
+    bool try_pop(T &);
+    size_t pop(T *, size_t); // copies out as many elements as there are, up to n, and returns how many that was
+    Regions read_regions(size_t max = size_t(-1));
+    void commit_read(size_t);
+
+    private:
+    static_assert(std::is_trivially_copyable<T>::value, "elements are shared between processes as raw bytes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "the positions are shared between processes");
+
+    struct Header
+    {
+        uint64_t magic;
+        uint64_t elementBytes;
+        uint64_t capacity;
+        alignas(64) std::atomic<uint64_t> head;
+        alignas(64) std::atomic<uint64_t> tail;
+    };
+
+    static constexpr uint64_t magic = 0x43504253'52494e47ull; // "CPBSRING"
+    static constexpr size_t dataOffset = (sizeof(Header) + 63u) / 64u * 64u;
+
+    static size_t roundUpToPowerOfTwo(size_t);
+    static SharedMemory createRing(size_t capacity);
+    Regions regions(size_t position, size_t count);
+    // the number of elements from tail up to head, at least one of which the other process wrote
+    size_t used(size_t head, size_t tail) const;
+
+    SharedMemory mMemory;
+    Buffer<uint8_t> mMapping;
+    Header *mHeader;
+    T *mData;
+    size_t mMask;
+    size_t mCachedTail = 0u; // the producer's
+    size_t mCachedHead = 0u; // the consumer's
+};
+
+
+
+inline SharedMemory SharedMemory::sized(int fd, size_t bytes) {
+    SharedMemory memory(fd);
+    if(::ftruncate(fd, static_cast<off_t>(bytes)) != 0)
+        throw std::system_error(errno, std::generic_category(), "ftruncate");
+    memory.mBytes = bytes;
+    return memory;
+}
+
+inline SharedMemory SharedMemory::create(size_t bytes) {
+#if defined(__linux__)
+    const int fd = ::memfd_create("cpp_buffer", MFD_CLOEXEC);
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), "memfd_create");
+#else
+    // a name only this process knows, for just long enough to open it
+    static std::atomic<unsigned> counter{0u};
+    char name[64];
+    std::snprintf(name, sizeof(name), "/cpp_buffer.%ld.%u", static_cast<long>(::getpid()), counter++);
+    const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), "shm_open");
+    ::shm_unlink(name);
+#endif
+    return sized(fd, bytes);
+}
+
+inline SharedMemory SharedMemory::create(const char *name, size_t bytes) {
+    const int fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), name);
+    return sized(fd, bytes);
+}
+
+inline SharedMemory SharedMemory::open(const char *name) {
+    const int fd = ::shm_open(name, O_RDWR, 0);
+    if(fd < 0)
+        throw std::system_error(errno, std::generic_category(), name);
+    return SharedMemory(fd);
+}
+
+inline void SharedMemory::unlink(const char *name) {
+    if(::shm_unlink(name) != 0)
+        throw std::system_error(errno, std::generic_category(), name);
+}
+
+inline SharedMemory::SharedMemory(int fd)
+    : mFd(fd)
+    , mBytes(0u)
+{
+    struct stat info;
+    if(::fstat(fd, &info) != 0) {
+        const int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "fstat");
+    }
+    mBytes = static_cast<size_t>(info.st_size);
+}
+
+inline SharedMemory::SharedMemory(SharedMemory &&other)
+    : mFd(std::exchange(other.mFd, -1))
+    , mBytes(std::exchange(other.mBytes, 0u))
+{}
+
+inline SharedMemory &SharedMemory::operator=(SharedMemory &&other) {
+    if(this != &other) {
+        if(mFd >= 0)
+            ::close(mFd);
+        mFd = std::exchange(other.mFd, -1);
+        mBytes = std::exchange(other.mBytes, 0u);
+    }
+    return *this;
+}
+
+inline SharedMemory::~SharedMemory() {
+    if(mFd >= 0)
+        ::close(mFd);
+}
+
+template< typename T >
+Buffer<T> SharedMemory::map(size_t offset, size_t count) const {
+    static_assert(std::is_trivially_copyable<T>::value, "elements are shared between processes as raw bytes");
+    return MappedBuffer::open_shared<T>(mFd, offset, count);
+}
+
+inline void send_fd(int socket, int fd) {
+    // one byte of data, since some systems drop control messages that come without any
+    char byte = 0;
+    iovec data{&byte, 1u};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+    msghdr message = {};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    cmsghdr *header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(header), &fd, sizeof(int));
+
+    while(::sendmsg(socket, &message, 0) < 0) {
+        if(errno != EINTR)
+            throw std::system_error(errno, std::generic_category(), "sendmsg");
+    }
+}
+
+inline int receive_fd(int socket) {
+    char byte;
+    iovec data{&byte, 1u};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))];
+
+    msghdr message = {};
+    message.msg_iov = &data;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    while((received = ::recvmsg(socket, &message, 0)) < 0) {
+        if(errno != EINTR)
+            throw std::system_error(errno, std::generic_category(), "recvmsg");
+    }
+
+    cmsghdr *header = CMSG_FIRSTHDR(&message);
+    if(received == 0 || header == nullptr || header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS)
+        throw std::system_error(EBADMSG, std::generic_category(), "receive_fd");
+    int fd;
+    std::memcpy(&fd, CMSG_DATA(header), sizeof(int));
+    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+    return fd;
+}
+
+
+template< typename T >
+size_t SharedRing<T>::roundUpToPowerOfTwo(size_t n) {
+    size_t capacity = 1u;
+    while(capacity < n)
+        capacity <<= 1;
+    return capacity;
+}
+
+template< typename T >
+SharedMemory SharedRing<T>::createRing(size_t capacity) {
+    capacity = roundUpToPowerOfTwo(capacity);
+    SharedMemory memory = SharedMemory::create(dataOffset + capacity * sizeof(T));
+    Buffer<uint8_t> mapping = memory.map<uint8_t>();
+    new(mapping.begin()) Header{magic, sizeof(T), capacity, {0u}, {0u}};
+    return memory; // the mapping goes, the ring stays in the object
+}
+
+template< typename T >
+SharedRing<T>::SharedRing(size_t capacity)
+    : SharedRing(createRing(capacity))
+{}
+
+template< typename T >
+SharedRing<T>::SharedRing(SharedMemory memory)
+    : mMemory(std::move(memory))
+{
+    if(mMemory.size() < dataOffset)
+        throw std::invalid_argument("not a SharedRing");
+    mMapping = mMemory.map<uint8_t>();
+    mHeader = reinterpret_cast<Header *>(mMapping.begin());
+
+    const uint64_t capacity = mHeader->capacity;
+    if(mHeader->magic != magic || mHeader->elementBytes != sizeof(T) || capacity == 0u
+        || (capacity & (capacity - 1u)) != 0u || capacity > (mMemory.size() - dataOffset) / sizeof(T))
+        throw std::invalid_argument("not a SharedRing of this element type");
+    mData = reinterpret_cast<T *>(mMapping.begin() + dataOffset);
+    mMask = static_cast<size_t>(capacity) - 1u;
+    mCachedTail = mHeader->tail.load(std::memory_order_acquire);
+    mCachedHead = mHeader->head.load(std::memory_order_acquire);
+}
+
+template< typename T >
+size_t SharedRing<T>::size() const {
+    const size_t tail = mHeader->tail.load(std::memory_order_acquire);
+    const size_t head = mHeader->head.load(std::memory_order_acquire);
+    // the consumer may have moved on and the producer filled that up again between the two loads
+    return std::min(head - tail, capacity());
+}
+
+template< typename T >
+typename SharedRing<T>::Regions SharedRing<T>::regions(size_t position, size_t count) {
+    const size_t offset = position & mMask;
+    const size_t first = std::min(count, capacity() - offset);
+    return Regions{
+        Buffer<T, 1u, T *>(mData + offset, first).slice(),
+        Buffer<T, 1u, T *>(mData, count - first).slice(),
+    };
+}
+
+template< typename T >
+size_t SharedRing<T>::used(size_t head, size_t tail) const {
+    const size_t n = head - tail;
+    if(n > capacity())
+        throw std::runtime_error("SharedRing: the other process corrupted the positions");
+    return n;
+}
+
+// producer
+template< typename T >
+typename SharedRing<T>::Regions SharedRing<T>::write_regions(size_t max) {
+    const size_t head = mHeader->head.load(std::memory_order_relaxed);
+    if(capacity() - used(head, mCachedTail) < max)
+        mCachedTail = mHeader->tail.load(std::memory_order_acquire);
+    return regions(head, std::min(max, capacity() - used(head, mCachedTail)));
+}
+
+template< typename T >
+void SharedRing<T>::commit_write(size_t n) {
+    const size_t head = mHeader->head.load(std::memory_order_relaxed);
+    cpp_buffer_assert(n <= capacity() - used(head, mCachedTail));
+    mHeader->head.store(head + n, std::memory_order_release);
+}
+
+template< typename T >
+bool SharedRing<T>::try_push(const T &value) {
+    return push(&value, 1u) == 1u;
+}
+
+template< typename T >
+size_t SharedRing<T>::push(const T *src, size_t n) {
+    Regions r = write_regions(n);
+    std::copy(src, src + r.first.size(), r.first.begin());
+    std::copy(src + r.first.size(), src + r.size(), r.second.begin());
+    commit_write(r.size());
+    return r.size();
+}
+
+// consumer
+template< typename T >
+typename SharedRing<T>::Regions SharedRing<T>::read_regions(size_t max) {
+    const size_t tail = mHeader->tail.load(std::memory_order_relaxed);
+    if(used(mCachedHead, tail) < max)
+        mCachedHead = mHeader->head.load(std::memory_order_acquire);
+    return regions(tail, std::min(max, used(mCachedHead, tail)));
+}
+
+template< typename T >
+void SharedRing<T>::commit_read(size_t n) {
+    const size_t tail = mHeader->tail.load(std::memory_order_relaxed);
+    cpp_buffer_assert(n <= used(mCachedHead, tail));
+    mHeader->tail.store(tail + n, std::memory_order_release);
+}
+
+template< typename T >
+bool SharedRing<T>::try_pop(T &value) {
+    return pop(&value, 1u) == 1u;
+}
+
+template< typename T >
+size_t SharedRing<T>::pop(T *dst, size_t n) {
+    Regions r = read_regions(n);
+    std::copy(r.first.begin(), r.first.end(), dst);
+    std::copy(r.second.begin(), r.second.end(), dst + r.first.size());
+    commit_read(r.size());
+    return r.size();
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,398 @@
+#pragma once
+
+#include<algorithm>
+#include<cstddef>
+#include<initializer_list>
+#include<memory>
+#include<new>
+#include<type_traits>
+#include<utility>
+
+#include "buffer.h"
+
+
+/**
+ *  Buffers that keep their elements inline, for the many small buffers (headers, coefficient sets) where the heap
+ *  allocation and the pointer chase of a Buffer cost more than the elements themselves.
+ *
+ *  StaticBuffer<T, N> always stores its elements inline, and holds up to N of them. SmallBuffer<T, N> stores up to N
+ *  inline and puts larger sizes in a heap Buffer. Both have the access API of Buffer, and slice into non-owning Slices:
+ *      StaticBuffer<float, 16> taps = {0.25f, 0.5f, 0.25f};
+ *      SmallBuffer<uint8_t, 64> header(headerBytes); // on the heap only when headerBytes > 64
+ *      auto even = header.slice<2>();               // a Slice<uint8_t, 2u, uint8_t *>
+ *
+ *  Unlike Buffer, these are value types: a copy has its own elements. A Slice of one points into its storage, so it is
+ *  only valid as long as the buffer it came from, and moving a buffer that is stored inline moves the elements.
+ *
+ *  StaticBuffer is a literal type for literal T, so tables can be computed at compile time, and end up in .rodata
+ *  instead of being filled in at startup:
+ *      constexpr auto window = make_window<256>(); // a constexpr function filling a StaticBuffer<float, 256>
+ *      constexpr float middle = window[128];
+ *      auto odd = window.slice<2>(1, window.size()); // a Slice<const float, 2u, const float *>
+ *  Indexing and slicing are still checked: in a constant expression, a failed check is a compile error.
+ */
+
+namespace CPPBuffer
+{
+
+/**
+ *  Up to N elements, stored inline. All N elements are constructed, whatever the size, the same as in a std::array.
+ *  Everything but the uninitialized constructor and alignment() can be used in constant expressions.
+ */
+template< typename T, size_t N >
+class StaticBuffer
+{
+    static_assert(N > 0u, "StaticBuffer needs room for at least one element");
+
+    public:
+    //typedefs
+    typedef T*          Iterator;
+    typedef const T *   ConstIterator;
+    typedef T*          ptr_t; // the pointer the slices of a StaticBuffer hold
+
+    constexpr StaticBuffer(); // all N elements, value-initialized
+    constexpr explicit StaticBuffer(size_t); // value-initialized
+    StaticBuffer(size_t, uninitialized_t);
+    constexpr StaticBuffer(std::initializer_list<T>);
+
+    static constexpr size_t capacity() { return N; }
+
+    // accessors
+    constexpr T &operator[](int);
+    constexpr const T &operator[](int) const;
+
+    // iterators
+    constexpr Iterator begin() { return mData; }
+    constexpr Iterator end() { return mData + mSize; }
+    constexpr ConstIterator begin() const { return mData; }
+    constexpr ConstIterator end() const { return mData + mSize; }
+
+    constexpr size_t size() const { return mSize; }
+    size_t alignment() const { return alignment_of(mData); }
+
+    // slices point into this buffer, and don't keep it alive. Those of a const buffer are read-only.
+    template< uint8_t s = 1u >
+    constexpr Slice<T, s, T *> slice(size_t begin, size_t end);
+    template< uint8_t s = 1u >
+    constexpr Slice<T, s, T *> slice();
+    template< uint8_t s = 1u >
+    constexpr Slice<const T, s, const T *> slice(size_t begin, size_t end) const;
+    template< uint8_t s = 1u >
+    constexpr Slice<const T, s, const T *> slice() const;
+
+    private:
+    T mData[N];
+    size_t mSize;
+};
+
+
+/**
+ *  A Buffer with room for N elements inline. Sizes up to N never touch the heap, larger ones allocate a Buffer<T, 1u,
+ *  ptr_t>, from a resource if one is given. Only the elements in use are constructed.
+ */
+template< typename T, size_t N, typename ptr_t = std::shared_ptr<T> >
+class SmallBuffer
+{
+    static_assert(N > 0u, "SmallBuffer needs room for at least one element");
+
+    public:
+    //typedefs
+    typedef T*                  Iterator;
+    typedef const T *           ConstIterator;
+    typedef Buffer<T, 1u, ptr_t> HeapBuffer;
+
+    SmallBuffer() = default;
+    explicit SmallBuffer(size_t); // value-initialized
+    SmallBuffer(size_t, uninitialized_t);
+    template< typename allocator_t >
+    SmallBuffer(size_t, allocator_t &); // allocator_t is only used when the buffer spills onto the heap
+    SmallBuffer(std::initializer_list<T>);
+
+    SmallBuffer(const SmallBuffer &);
+    SmallBuffer(SmallBuffer &&) noexcept(std::is_nothrow_move_constructible<T>::value);
+    SmallBuffer &operator=(SmallBuffer);
+    ~SmallBuffer();
+
+    static constexpr size_t inline_capacity() { return N; }
+    bool is_inline() const { return mSize <= N; }
+
+    // accessors
+    T &operator[](int);
+    const T &operator[](int) const;
+
+    // iterators
+    Iterator begin() { return mData; }
+    Iterator end() { return mData + mSize; }
+    ConstIterator begin() const { return mData; }
+    ConstIterator end() const { return mData + mSize; }
+
+    size_t size() const { return mSize; }
+    size_t alignment() const { return alignment_of(mData); }
+
+    // slices point into this buffer, and don't keep it alive. Those of a const buffer are read-only.
+    template< uint8_t s = 1u >
+    Slice<T, s, T *> slice(size_t begin, size_t end);
+    template< uint8_t s = 1u >
+    Slice<T, s, T *> slice();
+    template< uint8_t s = 1u >
+    Slice<const T, s, const T *> slice(size_t begin, size_t end) const;
+    template< uint8_t s = 1u >
+    Slice<const T, s, const T *> slice() const;
+
+    private:
+    // the number of inline elements, which is mSize, but written so that the compiler can see it is at most N
+    size_t inlineSize() const { return std::min(mSize, N); }
+    T *inlineData() { return reinterpret_cast<T *>(mInline); }
+    template< typename ... init_t >
+    void constructInline(size_t, init_t ...);
+    void takeFrom(SmallBuffer &&);
+    void destroy();
+
+    // mData points either at the inline storage or into mHeap, so access never has to check which
+    alignas(T) unsigned char mInline[N * sizeof(T)];
+    HeapBuffer mHeap;
+    T *mData = inlineData();
+    size_t mSize = 0ul;
+};
+
+
+
+// StaticBuffer
+template< typename T, size_t N >
+constexpr StaticBuffer<T, N>::StaticBuffer()
+    : mData()
+    , mSize(N)
+{}
+
+template< typename T, size_t N >
+constexpr StaticBuffer<T, N>::StaticBuffer(size_t n)
+    : mData()
+    , mSize(n)
+{
+    cpp_buffer_assert(n <= N);
+}
+
+template< typename T, size_t N >
+StaticBuffer<T, N>::StaticBuffer(size_t n, uninitialized_t)
+    : mSize(n)
+{
+    static_assert(std::is_trivially_default_constructible<T>::value,
+        "only trivially constructible types can be left uninitialized");
+    cpp_buffer_assert(n <= N);
+}
+
+template< typename T, size_t N >
+constexpr StaticBuffer<T, N>::StaticBuffer(std::initializer_list<T> values)
+    : mData()
+    , mSize(values.size())
+{
+    cpp_buffer_assert(values.size() <= N);
+    // std::copy only becomes constexpr in C++20
+    size_t i = 0;
+    for(const T &value : values)
+        mData[i++] = value;
+}
+
+template< typename T, size_t N >
+constexpr T &StaticBuffer<T, N>::operator[](int i) {
+    cpp_buffer_assert(static_cast<size_t>(i) < mSize);
+    return mData[i];
+}
+
+template< typename T, size_t N >
+constexpr const T &StaticBuffer<T, N>::operator[](int i) const {
+    cpp_buffer_assert(static_cast<size_t>(i) < mSize);
+    return mData[i];
+}
+
+template< typename T, size_t N >
+template< uint8_t s >
+constexpr Slice<T, s, T *> StaticBuffer<T, N>::slice(size_t begin, size_t end) {
+    return Buffer<T, 1u, T *>(mData, mSize).template slice<s>(begin, end);
+}
+
+template< typename T, size_t N >
+template< uint8_t s >
+constexpr Slice<T, s, T *> StaticBuffer<T, N>::slice() {
+    return slice<s>(0ul, mSize);
+}
+
+template< typename T, size_t N >
+template< uint8_t s >
+constexpr Slice<const T, s, const T *> StaticBuffer<T, N>::slice(size_t begin, size_t end) const {
+    return Buffer<const T, 1u, const T *>(mData, mSize).template slice<s>(begin, end);
+}
+
+template< typename T, size_t N >
+template< uint8_t s >
+constexpr Slice<const T, s, const T *> StaticBuffer<T, N>::slice() const {
+    return slice<s>(0ul, mSize);
+}
+
+
+// SmallBuffer
+template< typename T, size_t N, typename ptr_t >
+template< typename ... init_t >
+void SmallBuffer<T, N, ptr_t>::constructInline(size_t n, init_t ...) {
+    T *data = inlineData();
+    size_t i = 0;
+    try {
+        for(; i < n; ++i) {
+            if(sizeof...(init_t) == 0)
+                ::new(static_cast<void *>(data + i)) T();
+            else
+                ::new(static_cast<void *>(data + i)) T;
+        }
+    } catch(...) {
+        while(i > 0)
+            data[--i].~T();
+        throw;
+    }
+    mSize = n;
+}
+
+template< typename T, size_t N, typename ptr_t >
+SmallBuffer<T, N, ptr_t>::SmallBuffer(size_t n) {
+    if(n <= N) {
+        constructInline(n);
+    } else {
+        mHeap = HeapBuffer(n);
+        mData = mHeap.begin();
+        mSize = n;
+    }
+}
+
+template< typename T, size_t N, typename ptr_t >
+SmallBuffer<T, N, ptr_t>::SmallBuffer(size_t n, uninitialized_t tag) {
+    static_assert(std::is_trivially_default_constructible<T>::value,
+        "only trivially constructible types can be left uninitialized");
+    if(n <= N) {
+        constructInline(n, tag);
+    } else {
+        mHeap = HeapBuffer(n, tag);
+        mData = mHeap.begin();
+        mSize = n;
+    }
+}
+
+template< typename T, size_t N, typename ptr_t >
+template< typename allocator_t >
+SmallBuffer<T, N, ptr_t>::SmallBuffer(size_t n, allocator_t &allocator) {
+    if(n <= N) {
+        constructInline(n);
+    } else {
+        mHeap = HeapBuffer(n, allocator);
+        mData = mHeap.begin();
+        mSize = n;
+    }
+}
+
+template< typename T, size_t N, typename ptr_t >
+SmallBuffer<T, N, ptr_t>::SmallBuffer(std::initializer_list<T> values)
+    : SmallBuffer(values.size())
+{
+    std::copy(values.begin(), values.end(), mData);
+}
+
+template< typename T, size_t N, typename ptr_t >
+SmallBuffer<T, N, ptr_t>::SmallBuffer(const SmallBuffer &other) {
+    if(other.is_inline()) {
+        std::uninitialized_copy_n(other.begin(), other.inlineSize(), inlineData());
+        mSize = other.mSize;
+    } else {
+        mHeap = HeapBuffer(other.mSize);
+        std::copy(other.begin(), other.end(), mHeap.begin());
+        mData = mHeap.begin();
+        mSize = other.mSize;
+    }
+}
+
+template< typename T, size_t N, typename ptr_t >
+SmallBuffer<T, N, ptr_t>::SmallBuffer(SmallBuffer &&other) noexcept(std::is_nothrow_move_constructible<T>::value) {
+    takeFrom(std::move(other));
+}
+
+template< typename T, size_t N, typename ptr_t >
+SmallBuffer<T, N, ptr_t> &SmallBuffer<T, N, ptr_t>::operator=(SmallBuffer other) {
+    destroy();
+    takeFrom(std::move(other));
+    return *this;
+}
+
+template< typename T, size_t N, typename ptr_t >
+SmallBuffer<T, N, ptr_t>::~SmallBuffer() {
+    destroy();
+}
+
+// leaves other empty and inline
+template< typename T, size_t N, typename ptr_t >
+void SmallBuffer<T, N, ptr_t>::takeFrom(SmallBuffer &&other) {
+    if(other.is_inline()) {
+        std::uninitialized_move_n(other.begin(), other.inlineSize(), inlineData());
+        mData = inlineData();
+        mSize = other.mSize;
+        other.destroy();
+    } else {
+        mHeap = std::move(other.mHeap);
+        mData = other.mData;
+        mSize = other.mSize;
+        other.mHeap = HeapBuffer();
+        other.mData = other.inlineData();
+        other.mSize = 0ul;
+    }
+}
+
+template< typename T, size_t N, typename ptr_t >
+void SmallBuffer<T, N, ptr_t>::destroy() {
+    if(is_inline()) {
+        // a loop over all N slots: GCC can't always bound one over mSize by N, and warns about the iterations past it
+        T *data = inlineData();
+        const size_t n = inlineSize();
+        for(size_t i = N; i > 0; --i) {
+            if(i <= n)
+                data[i - 1u].~T();
+        }
+    } else {
+        mHeap = HeapBuffer();
+        mData = inlineData();
+    }
+    mSize = 0ul;
+}
+
+template< typename T, size_t N, typename ptr_t >
+T &SmallBuffer<T, N, ptr_t>::operator[](int i) {
+    cpp_buffer_assert(static_cast<size_t>(i) < mSize);
+    return mData[i];
+}
+
+template< typename T, size_t N, typename ptr_t >
+const T &SmallBuffer<T, N, ptr_t>::operator[](int i) const {
+    cpp_buffer_assert(static_cast<size_t>(i) < mSize);
+    return mData[i];
+}
+
+template< typename T, size_t N, typename ptr_t >
+template< uint8_t s >
+Slice<T, s, T *> SmallBuffer<T, N, ptr_t>::slice(size_t begin, size_t end) {
+    return Buffer<T, 1u, T *>(mData, mSize).template slice<s>(begin, end);
+}
+
+template< typename T, size_t N, typename ptr_t >
+template< uint8_t s >
+Slice<T, s, T *> SmallBuffer<T, N, ptr_t>::slice() {
+    return slice<s>(0ul, mSize);
+}
+
+template< typename T, size_t N, typename ptr_t >
+template< uint8_t s >
+Slice<const T, s, const T *> SmallBuffer<T, N, ptr_t>::slice(size_t begin, size_t end) const {
+    return Buffer<const T, 1u, const T *>(mData, mSize).template slice<s>(begin, end);
+}
+
+template< typename T, size_t N, typename ptr_t >
+template< uint8_t s >
+Slice<const T, s, const T *> SmallBuffer<T, N, ptr_t>::slice() const {
+    return slice<s>(0ul, mSize);
+}
+
+}// namespace CPPBuffer
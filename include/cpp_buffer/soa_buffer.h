@@ -0,0 +1,262 @@
+#pragma once
+
+#include<algorithm>
+#include<cstddef>
+#include<cstdint>
+#include<iterator>
+#include<memory>
+#include<new>
+#include<tuple>
+#include<type_traits>
+#include<utility>
+
+#include "buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  A structure-of-arrays table: one column per field, all in a single allocation, each column starting on its own
+ *  cache line. Scanning one field reads only that field's memory, instead of striding over whole records:
+ *      enum { timestamp, x, y, z, flags };
+ *      SoABuffer<int64_t, float, float, float, uint32_t> points(n);
+ *      float meanX = sum(points.column<x>()) / n;        // a contiguous Buffer<float>, ready for algorithms.h
+ *
+ *  Rows are proxies: tuples of references into the columns, so records can still be read and written as a whole:
+ *      auto [t, px, py, pz, f] = points[i];
+ *      points[j] = std::make_tuple(t, px + 1.0f, py, pz, f);
+ *
+ *  Like a Buffer, copies of an SoABuffer share its columns, and so does every Buffer column<I>() hands out. The
+ *  memory goes back to the resource once the last of them is gone.
+ */
+template< typename ... fields_t >
+class SoABuffer
+{
+    static_assert(sizeof...(fields_t) > 0u, "SoABuffer needs at least one field");
+
+    public:
+    //typedefs
+    static constexpr size_t field_count = sizeof...(fields_t);
+    template< size_t I >
+    using field_t = typename std::tuple_element<I, std::tuple<fields_t...>>::type;
+
+    typedef std::tuple<fields_t &...>           Row;
+    typedef std::tuple<const fields_t &...>     ConstRow;
+
+    template< typename soa_t, typename row_t >
+    class RowIterator
+    {
+        public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef row_t                           value_type;
+        typedef std::ptrdiff_t                  difference_type;
+        typedef void                            pointer;
+        typedef row_t                           reference;
+
+        RowIterator(soa_t *soa, size_t index) : mSoA(soa), mIndex(index) {}
+
+        row_t operator*() const { return (*mSoA)[mIndex]; }
+        row_t operator[](difference_type n) const { return (*mSoA)[mIndex + n]; }
+
+        RowIterator &operator++() { ++mIndex; return *this; }
+        RowIterator &operator--() { --mIndex; return *this; }
+        RowIterator operator++(int) { RowIterator tmp(*this); ++mIndex; return tmp; }
+        RowIterator operator--(int) { RowIterator tmp(*this); --mIndex; return tmp; }
+        RowIterator &operator+=(difference_type n) { mIndex += n; return *this; }
+        RowIterator &operator-=(difference_type n) { mIndex -= n; return *this; }
+
+        friend RowIterator operator+(RowIterator it, difference_type n) { return it += n; }
+        friend RowIterator operator-(RowIterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const RowIterator &a, const RowIterator &b) {
+            return static_cast<difference_type>(a.mIndex) - static_cast<difference_type>(b.mIndex);
+        }
+
+        friend bool operator==(const RowIterator &a, const RowIterator &b) { return a.mIndex == b.mIndex; }
+        friend bool operator!=(const RowIterator &a, const RowIterator &b) { return a.mIndex != b.mIndex; }
+        friend bool operator<(const RowIterator &a, const RowIterator &b) { return a.mIndex < b.mIndex; }
+
+        private:
+        soa_t *mSoA;
+        size_t mIndex;
+    };
+
+    typedef RowIterator<SoABuffer, Row>             Iterator;
+    typedef RowIterator<const SoABuffer, ConstRow>  ConstIterator;
+
+    SoABuffer() = default;
+    explicit SoABuffer(size_t); // value-initialized, from NewDeleteResource
+    template< typename resource_t >
+    SoABuffer(size_t, resource_t &);
+
+    size_t size() const { return mSize; }
+
+    // the columns, as contiguous Buffers that share ownership of the table
+    template< size_t I >
+    Buffer<field_t<I>> column() { return std::get<I>(mColumns); }
+    template< size_t I >
+    const Buffer<field_t<I>> &column() const { return std::get<I>(mColumns); }
+
+    // rows
+    Row operator[](size_t);
+    ConstRow operator[](size_t) const;
+
+    Iterator begin() { return Iterator(this, 0u); }
+    Iterator end() { return Iterator(this, mSize); }
+    ConstIterator begin() const { return ConstIterator(this, 0u); }
+    ConstIterator end() const { return ConstIterator(this, mSize); }
+
+    private:
+    typedef std::index_sequence_for<fields_t...> Indices;
+    typedef std::tuple<Buffer<fields_t>...> Columns;
+
+    // where each column starts in a table of n rows, and how big the whole block is. Throws std::bad_array_new_length
+    // when that doesn't fit into a size_t.
+    struct Layout
+    {
+        size_t offsets[sizeof...(fields_t)];
+        size_t bytes;
+        size_t alignment;
+
+        explicit Layout(size_t n);
+    };
+
+    template< typename resource_t >
+    struct Release
+    {
+        resource_t *resource;
+        size_t rows;
+
+        void operator()(char *memory) const;
+    };
+
+    template< size_t ... I >
+    static void construct(char *memory, const Layout &, size_t n, std::index_sequence<I...>);
+    template< size_t ... I >
+    static void destroy(char *memory, const Layout &, size_t n, size_t columns, std::index_sequence<I...>);
+    template< size_t ... I >
+    void adopt(const std::shared_ptr<char> &owner, const Layout &, std::index_sequence<I...>);
+    template< size_t ... I >
+    Row row(size_t, std::index_sequence<I...>);
+    template< size_t ... I >
+    ConstRow row(size_t, std::index_sequence<I...>) const;
+
+    Columns mColumns;
+    size_t mSize = 0ul;
+};
+
+
+
+template< typename ... fields_t >
+SoABuffer<fields_t...>::Layout::Layout(size_t n) {
+    constexpr size_t sizes[] = {sizeof(fields_t)...};
+    constexpr size_t alignments[] = {alignof(fields_t)...};
+
+    size_t offset = 0u;
+    alignment = 64u;
+    for(size_t i = 0; i < sizeof...(fields_t); ++i) {
+        // each column on its own cache line, or stricter if the field type needs it
+        const size_t columnAlignment = std::max<size_t>(64u, alignments[i]);
+        alignment = std::max(alignment, columnAlignment);
+        if(offset > SIZE_MAX - (columnAlignment - 1u))
+            throw std::bad_array_new_length();
+        offset = detail::round_up(offset, columnAlignment);
+        offsets[i] = offset;
+        if(n > (SIZE_MAX - offset) / sizes[i])
+            throw std::bad_array_new_length();
+        offset += n * sizes[i];
+    }
+    bytes = std::max<size_t>(offset, 1u);
+}
+
+template< typename ... fields_t >
+template< typename resource_t >
+void SoABuffer<fields_t...>::Release<resource_t>::operator()(char *memory) const {
+    const Layout layout(rows);
+    destroy(memory, layout, rows, sizeof...(fields_t), Indices());
+    resource->deallocate(memory, layout.bytes, layout.alignment);
+    CPPBUFFER_RECORD_DEALLOCATION(layout.bytes);
+}
+
+template< typename ... fields_t >
+template< size_t ... I >
+void SoABuffer<fields_t...>::construct(char *memory, const Layout &layout, size_t n, std::index_sequence<I...>) {
+    size_t constructed = 0u;
+    try {
+        ((std::uninitialized_value_construct_n(reinterpret_cast<fields_t *>(memory + layout.offsets[I]), n),
+            ++constructed), ...);
+    } catch(...) {
+        destroy(memory, layout, n, constructed, Indices());
+        throw;
+    }
+}
+
+// destroys the first columns columns
+template< typename ... fields_t >
+template< size_t ... I >
+void SoABuffer<fields_t...>::destroy(char *memory, const Layout &layout, size_t n, size_t columns,
+    std::index_sequence<I...>)
+{
+    ((I < columns ? void(std::destroy_n(reinterpret_cast<fields_t *>(memory + layout.offsets[I]), n)) : void()),
+        ...);
+}
+
+template< typename ... fields_t >
+template< size_t ... I >
+void SoABuffer<fields_t...>::adopt(const std::shared_ptr<char> &owner, const Layout &layout,
+    std::index_sequence<I...>)
+{
+    // every column aliases the one owner of the block
+    mColumns = Columns(Buffer<fields_t>(
+        std::shared_ptr<fields_t>(owner, reinterpret_cast<fields_t *>(owner.get() + layout.offsets[I])), mSize)...);
+}
+
+template< typename ... fields_t >
+SoABuffer<fields_t...>::SoABuffer(size_t n)
+    : SoABuffer(n, NewDeleteResource::instance())
+{}
+
+template< typename ... fields_t >
+template< typename resource_t >
+SoABuffer<fields_t...>::SoABuffer(size_t n, resource_t &resource)
+    : mSize(n)
+{
+    const Layout layout(n);
+    char *memory = static_cast<char *>(resource.allocate(layout.bytes, layout.alignment));
+    CPPBUFFER_RECORD_ALLOCATION(layout.bytes);
+    try {
+        construct(memory, layout, n, Indices());
+    } catch(...) {
+        resource.deallocate(memory, layout.bytes, layout.alignment);
+        CPPBUFFER_RECORD_DEALLOCATION(layout.bytes);
+        throw;
+    }
+    // if the control block can't be allocated, shared_ptr calls Release on the way out
+    adopt(std::shared_ptr<char>(memory, Release<resource_t>{&resource, n}), layout, Indices());
+}
+
+template< typename ... fields_t >
+template< size_t ... I >
+typename SoABuffer<fields_t...>::Row SoABuffer<fields_t...>::row(size_t i, std::index_sequence<I...>) {
+    return Row(std::get<I>(mColumns).begin()[i]...);
+}
+
+template< typename ... fields_t >
+template< size_t ... I >
+typename SoABuffer<fields_t...>::ConstRow SoABuffer<fields_t...>::row(size_t i, std::index_sequence<I...>) const {
+    return ConstRow(std::get<I>(mColumns).begin()[i]...);
+}
+
+template< typename ... fields_t >
+typename SoABuffer<fields_t...>::Row SoABuffer<fields_t...>::operator[](size_t i) {
+    cpp_buffer_assert(i < mSize);
+    return row(i, Indices());
+}
+
+template< typename ... fields_t >
+typename SoABuffer<fields_t...>::ConstRow SoABuffer<fields_t...>::operator[](size_t i) const {
+    cpp_buffer_assert(i < mSize);
+    return row(i, Indices());
+}
+
+}// namespace CPPBuffer
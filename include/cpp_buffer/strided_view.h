@@ -0,0 +1,312 @@
+#pragma once
+
+#include<array>
+#include<cstddef>
+#include<cstdint>
+#include<memory>
+#include<type_traits>
+#include<utility>
+
+#include "buffer.h"
+
+
+namespace CPPBuffer
+{
+
+/**
+ *  An N-dimensional strided view over a Buffer, for images, spectrograms and other tensors stored in one allocation.
+ *  Like a Slice, it shares ownership of the Buffer's memory, so it stays valid after the Buffer goes away.
+ *
+ *  Each dimension has an extent and a stride, both in elements. The outer strides are runtime values, and the
+ *  innermost one is the compile-time innerStride, so loops along the innermost dimension get the same codegen they
+ *  would over a Slice. A dense row-major image, and the green channel of an interleaved RGB one:
+ *      Buffer<float> pixels(height * width);
+ *      StridedView<float, 2> image(pixels, {height, width});
+ *      image(y, x) = 1.0f;
+ *
+ *      Buffer<float> rgb(height * width * 3);
+ *      StridedView<float, 2, 3> green(rgb, 1, {height, width}, {3 * width, 3});
+ *
+ *  Views of views never copy: operator[] fixes the outermost index, slice() and block() narrow dimensions, tiled()
+ *  splits every dimension into tiles of the given extents, and transposed() and permuted() reorder the dimensions.
+ *  Reordering moves a runtime stride into the innermost position, so those return views with a dynamic_stride.
+ *
+ *  The view itself does not know about rows being in the same cache lines. For cache-blocked kernels, walk the view
+ *  in tiles: tiled({64, 64}) is a 4-D view where (ty, tx, y, x) is element (ty * 64 + y, tx * 64 + x).
+ *
+ *  A StridedView<const T> is a read-only view over the same Buffer<T>, and is what operator[] on a const view returns.
+ */
+template< typename T, size_t rank, size_t innerStride = 1u, typename ptr_t = std::shared_ptr<std::remove_const_t<T>> >
+class StridedView
+{
+    static_assert(rank > 0u, "StridedView needs at least one dimension");
+
+    public:
+    //typedefs
+    typedef Buffer<std::remove_const_t<T>, 1u, ptr_t>   Storage;
+    typedef std::array<size_t, rank>                    Extents;
+    typedef std::array<size_t, rank>                    Strides;
+
+    StridedView() = default;
+    // the whole buffer as a dense, row-major tensor, whose extents have to multiply up to at most its size
+    StridedView(const Storage &, const Extents &);
+    // element (i0, i1, ...) is storage[offset + i0 * strides[0] + i1 * strides[1] + ...]. The last stride has to be
+    // innerStride, unless that is the dynamic_stride.
+    StridedView(const Storage &, size_t offset, const Extents &, const Strides &);
+
+    size_t extent(size_t dimension) const { return mExtents[dimension]; }
+    size_t stride(size_t dimension) const { return dimension + 1u == rank ? innermostStride() : mStrides[dimension]; }
+    const Extents &extents() const { return mExtents; }
+    Strides strides() const;
+    size_t size() const; // the number of elements in the view
+    const Storage &storage() const { return mStorage; }
+
+    // element access, with one index per dimension
+    template< typename ... index_t >
+    T &operator()(index_t ...);
+    template< typename ... index_t >
+    const T &operator()(index_t ...) const;
+
+    // fixes the outermost index: a view one dimension down, or an element when there is only one dimension. Either is
+    // read-only when this view is const.
+    decltype(auto) operator[](size_t);
+    decltype(auto) operator[](size_t) const;
+
+    // narrows one dimension to [begin, end)
+    StridedView slice(size_t dimension, size_t begin, size_t end);
+    // the part of the view extents big, starting at origin
+    StridedView block(const Extents &origin, const Extents &extents);
+    // splits every dimension into tiles, and returns a view indexed by (tile indices..., indices within the tile...).
+    // Only whole tiles are in it: when an extent isn't a multiple of the tile size, block() gets at the remainder.
+    StridedView<T, 2u * rank, innerStride, ptr_t> tiled(const Extents &tile);
+    // the dimensions reversed, so a transposed image is indexed (x, y)
+    StridedView<T, rank, dynamic_stride, ptr_t> transposed();
+    // dimension i of the result is dimension order[i] of this view
+    StridedView<T, rank, dynamic_stride, ptr_t> permuted(const std::array<size_t, rank> &order);
+
+    // a one-dimensional view is a Slice, which is what algorithms.h works on. Inner strides that aren't a compile-time
+    // uint8_t give a Slice with a dynamic_stride. A view of const T gives a Slice of const T over the same ptr_t.
+    typedef Slice<T, (innerStride <= 255u ? innerStride : dynamic_stride), ptr_t> AsSlice;
+    AsSlice as_slice();
+
+    // calls f(element) for every element, in the order the view is indexed in
+    template< typename function_t >
+    void for_each(function_t &&f);
+    template< typename function_t >
+    void for_each(function_t &&f) const;
+
+    private:
+    size_t innermostStride() const { return innerStride != dynamic_stride ? innerStride : mStrides[rank - 1u]; }
+    template< size_t dimension, typename U, typename function_t >
+    void forEach(U *data, size_t offset, function_t &f) const;
+
+    Storage mStorage;
+    size_t mOffset = 0ul;
+    Extents mExtents = {};
+    Strides mStrides = {};
+};
+
+
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+StridedView<T, rank, innerStride, ptr_t>::StridedView(const Storage &storage, const Extents &extents)
+    : mStorage(storage)
+    , mExtents(extents)
+{
+    static_assert(innerStride == 1u || innerStride == dynamic_stride, "a dense view has a unit inner stride");
+    size_t stride = 1u;
+    for(size_t d = rank; d > 0u; --d) {
+        mStrides[d - 1u] = stride;
+        stride *= extents[d - 1u];
+    }
+    cpp_buffer_assert(stride <= storage.size());
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+StridedView<T, rank, innerStride, ptr_t>::StridedView(const Storage &storage, size_t offset, const Extents &extents,
+    const Strides &strides)
+    : mStorage(storage)
+    , mOffset(offset)
+    , mExtents(extents)
+    , mStrides(strides)
+{
+    cpp_buffer_assert(innerStride == dynamic_stride || strides[rank - 1u] == innerStride);
+    // checking the last element is enough, all strides are positive
+    if(size() > 0u) {
+        size_t last = offset;
+        for(size_t d = 0; d < rank; ++d)
+            last += (extents[d] - 1u) * strides[d];
+        cpp_buffer_assert(last < storage.size());
+    }
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+typename StridedView<T, rank, innerStride, ptr_t>::Strides StridedView<T, rank, innerStride, ptr_t>::strides() const {
+    Strides strides = mStrides;
+    strides[rank - 1u] = innermostStride();
+    return strides;
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+size_t StridedView<T, rank, innerStride, ptr_t>::size() const {
+    size_t size = 1u;
+    for(size_t extent : mExtents)
+        size *= extent;
+    return size;
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+template< typename ... index_t >
+T &StridedView<T, rank, innerStride, ptr_t>::operator()(index_t ... indices) {
+    return const_cast<T &>(static_cast<const StridedView &>(*this)(indices...));
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+template< typename ... index_t >
+const T &StridedView<T, rank, innerStride, ptr_t>::operator()(index_t ... indices) const {
+    static_assert(sizeof...(index_t) == rank, "a StridedView takes one index per dimension");
+    const size_t index[rank] = {static_cast<size_t>(indices)...};
+
+    size_t offset = mOffset;
+    for(size_t d = 0; d + 1u < rank; ++d) {
+        cpp_buffer_assert(index[d] < mExtents[d]);
+        offset += index[d] * mStrides[d];
+    }
+    cpp_buffer_assert(index[rank - 1u] < mExtents[rank - 1u]);
+    return mStorage.begin()[offset + index[rank - 1u] * innermostStride()];
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+decltype(auto) StridedView<T, rank, innerStride, ptr_t>::operator[](size_t i) {
+    cpp_buffer_assert(i < mExtents[0]);
+    if constexpr(rank == 1u) {
+        return static_cast<T &>(mStorage.begin()[mOffset + i * innermostStride()]);
+    } else {
+        std::array<size_t, rank - 1u> extents, strides;
+        for(size_t d = 1; d < rank; ++d) {
+            extents[d - 1u] = mExtents[d];
+            strides[d - 1u] = mStrides[d];
+        }
+        return StridedView<T, rank - 1u, innerStride, ptr_t>(mStorage, mOffset + i * mStrides[0], extents, strides);
+    }
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+decltype(auto) StridedView<T, rank, innerStride, ptr_t>::operator[](size_t i) const {
+    cpp_buffer_assert(i < mExtents[0]);
+    if constexpr(rank == 1u) {
+        return static_cast<const T &>(mStorage.begin()[mOffset + i * innermostStride()]);
+    } else {
+        std::array<size_t, rank - 1u> extents, strides;
+        for(size_t d = 1; d < rank; ++d) {
+            extents[d - 1u] = mExtents[d];
+            strides[d - 1u] = mStrides[d];
+        }
+        return StridedView<const T, rank - 1u, innerStride, ptr_t>(mStorage, mOffset + i * mStrides[0], extents,
+            strides);
+    }
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+StridedView<T, rank, innerStride, ptr_t> StridedView<T, rank, innerStride, ptr_t>::slice(size_t dimension,
+    size_t begin, size_t end)
+{
+    cpp_buffer_assert(dimension < rank && begin <= end && end <= mExtents[dimension]);
+    StridedView result(*this);
+    result.mOffset += begin * stride(dimension);
+    result.mExtents[dimension] = end - begin;
+    return result;
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+StridedView<T, rank, innerStride, ptr_t> StridedView<T, rank, innerStride, ptr_t>::block(const Extents &origin,
+    const Extents &extents)
+{
+    StridedView result(*this);
+    for(size_t d = 0; d < rank; ++d) {
+        cpp_buffer_assert(origin[d] <= mExtents[d] && extents[d] <= mExtents[d] - origin[d]);
+        result.mOffset += origin[d] * stride(d);
+        result.mExtents[d] = extents[d];
+    }
+    return result;
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+StridedView<T, 2u * rank, innerStride, ptr_t> StridedView<T, rank, innerStride, ptr_t>::tiled(const Extents &tile) {
+    std::array<size_t, 2u * rank> extents, strides;
+    for(size_t d = 0; d < rank; ++d) {
+        cpp_buffer_assert(tile[d] > 0u);
+        extents[d] = mExtents[d] / tile[d];
+        strides[d] = tile[d] * stride(d);
+        extents[rank + d] = tile[d];
+        strides[rank + d] = stride(d);
+    }
+    return StridedView<T, 2u * rank, innerStride, ptr_t>(mStorage, mOffset, extents, strides);
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+StridedView<T, rank, dynamic_stride, ptr_t> StridedView<T, rank, innerStride, ptr_t>::transposed() {
+    std::array<size_t, rank> order;
+    for(size_t d = 0; d < rank; ++d)
+        order[d] = rank - 1u - d;
+    return permuted(order);
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+StridedView<T, rank, dynamic_stride, ptr_t> StridedView<T, rank, innerStride, ptr_t>::permuted(
+    const std::array<size_t, rank> &order)
+{
+    Extents extents;
+    Strides strides;
+    for(size_t d = 0; d < rank; ++d) {
+        cpp_buffer_assert(order[d] < rank);
+        extents[d] = mExtents[order[d]];
+        strides[d] = stride(order[d]);
+    }
+    return StridedView<T, rank, dynamic_stride, ptr_t>(mStorage, mOffset, extents, strides);
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+typename StridedView<T, rank, innerStride, ptr_t>::AsSlice StridedView<T, rank, innerStride, ptr_t>::as_slice() {
+    static_assert(rank == 1u, "only one-dimensional views are Slices");
+    // a Slice over [begin, end) visits ceil((end - begin) / stride) elements, so end just has to be past the last one
+    const size_t s = innermostStride();
+    const size_t end = mExtents[0] > 0u ? mOffset + (mExtents[0] - 1u) * s + 1u : mOffset;
+    // a read-only view slices a read-only Buffer over the same memory
+    std::conditional_t<std::is_const<T>::value, Buffer<T, 1u, ptr_t>, Storage &> storage = mStorage;
+    if constexpr(innerStride != dynamic_stride && innerStride <= 255u)
+        return storage.template slice<static_cast<uint8_t>(innerStride)>(mOffset, end);
+    else
+        return storage.slice(mOffset, end, s);
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+template< typename function_t >
+void StridedView<T, rank, innerStride, ptr_t>::for_each(function_t &&f) {
+    if(size() > 0u)
+        forEach<0u>(static_cast<T *>(mStorage.begin()), mOffset, f);
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+template< typename function_t >
+void StridedView<T, rank, innerStride, ptr_t>::for_each(function_t &&f) const {
+    if(size() > 0u)
+        forEach<0u>(static_cast<const T *>(mStorage.begin()), mOffset, f);
+}
+
+template< typename T, size_t rank, size_t innerStride, typename ptr_t >
+template< size_t dimension, typename U, typename function_t >
+void StridedView<T, rank, innerStride, ptr_t>::forEach(U *data, size_t offset, function_t &f) const {
+    if constexpr(dimension + 1u == rank) {
+        // the innermost loop is a plain strided loop over the memory, with the stride known whenever it can be
+        U *p = data + offset;
+        const size_t s = innermostStride();
+        for(size_t i = 0; i < mExtents[dimension]; ++i)
+            f(p[i * s]);
+    } else {
+        for(size_t i = 0; i < mExtents[dimension]; ++i)
+            forEach<dimension + 1u>(data, offset + i * mStrides[dimension], f);
+    }
+}
+
+}// namespace CPPBuffer
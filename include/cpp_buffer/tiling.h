@@ -0,0 +1,209 @@
+#pragma once
+
+#include<cstddef>
+#include<cstdint>
+#include<iterator>
+#include<utility>
+
+#include "algorithms.h"
+#include "buffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include<unistd.h>
+#endif
+#if defined(__APPLE__)
+  #include<sys/sysctl.h>
+#endif
+
+
+/**
+ *  Cache-sized tiles of a Buffer or Slice, for fusing several passes over a buffer that is much larger than the cache:
+ *      for(auto tile : cache_tiles(samples, CacheLevel::l2)) {
+ *          window(tile);
+ *          magnitude(tile); // tile is still in L2
+ *      }
+ *  instead of streaming all of samples from memory once per pass. Each tile is a Slice of the view, from view.slice(),
+ *  so it shares ownership and has the view's stride. The last tile holds whatever is left over, and can be smaller.
+ *
+ *  cache_tiles() sizes the tiles from the cache sizes the system reports, taking half of the chosen level for the data
+ *  and splitting that between the number of buffers each tile is processed with. tiles() takes an explicit size.
+ */
+
+namespace CPPBuffer
+{
+
+enum class CacheLevel
+{
+    l1 = 1,
+    l2 = 2,
+    l3 = 3,
+};
+
+struct CacheSizes
+{
+    size_t l1;      // data cache, per core
+    size_t l2;
+    size_t l3;
+    size_t line;
+};
+
+namespace detail
+{
+
+inline size_t query_cache_size(int level) {
+    long bytes = 0;
+#if defined(_SC_LEVEL1_DCACHE_SIZE)
+    switch(level) {
+        case 0: bytes = sysconf(_SC_LEVEL1_DCACHE_LINESIZE); break;
+        case 1: bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE); break;
+        case 2: bytes = sysconf(_SC_LEVEL2_CACHE_SIZE); break;
+        case 3: bytes = sysconf(_SC_LEVEL3_CACHE_SIZE); break;
+    }
+#elif defined(__APPLE__)
+    static const char *const names[] = {"hw.cachelinesize", "hw.l1dcachesize", "hw.l2cachesize", "hw.l3cachesize"};
+    int64_t value = 0;
+    size_t length = sizeof(value);
+    if(sysctlbyname(names[level], &value, &length, nullptr, 0) == 0)
+        bytes = static_cast<long>(value);
+#else
+    (void)level;
+#endif
+    return bytes > 0 ? static_cast<size_t>(bytes) : 0u;
+}
+
+}// namespace detail
+
+/** The cache sizes of this machine, as far as the system tells. Levels it doesn't report get typical sizes. */
+inline const CacheSizes &cache_sizes() {
+    static const CacheSizes sizes = []() {
+        CacheSizes s;
+        s.line = detail::query_cache_size(0);
+        s.l1 = detail::query_cache_size(1);
+        s.l2 = detail::query_cache_size(2);
+        s.l3 = detail::query_cache_size(3);
+        if(s.line == 0u)
+            s.line = 64u;
+        if(s.l1 == 0u)
+            s.l1 = 32u * 1024u;
+        if(s.l2 == 0u)
+            s.l2 = 256u * 1024u;
+        if(s.l3 == 0u)
+            s.l3 = s.l2; // no L3 reported: don't plan for more than L2
+        return s;
+    }();
+    return sizes;
+}
+
+inline size_t cache_size(CacheLevel level) {
+    const CacheSizes &sizes = cache_sizes();
+    switch(level) {
+        case CacheLevel::l1: return sizes.l1;
+        case CacheLevel::l2: return sizes.l2;
+        case CacheLevel::l3: return sizes.l3;
+    }
+    return sizes.l2;
+}
+
+
+/**
+ *  The tiles of a view, as a range. Tiles are made on the fly, and can be visited in any order.
+ */
+template< typename view_t >
+class Tiles
+{
+    public:
+    //typedefs
+    typedef decltype(std::declval<view_t &>().slice(0u, 0u)) Tile;
+
+    class Iterator
+    {
+        public:
+        typedef std::input_iterator_tag iterator_category;
+        typedef Tile                    value_type;
+        typedef std::ptrdiff_t          difference_type;
+        typedef const Tile *            pointer;
+        typedef Tile                    reference;
+
+        Iterator(Tiles *tiles, size_t index) : mTiles(tiles), mIndex(index) {}
+
+        Tile operator*() const { return (*mTiles)[mIndex]; }
+        Iterator &operator++() { ++mIndex; return *this; }
+        Iterator operator++(int) { Iterator tmp(*this); ++mIndex; return tmp; }
+
+        friend bool operator==(const Iterator &a, const Iterator &b) { return a.mIndex == b.mIndex; }
+        friend bool operator!=(const Iterator &a, const Iterator &b) { return a.mIndex != b.mIndex; }
+
+        private:
+        Tiles *mTiles;
+        size_t mIndex;
+    };
+
+    Tiles(const view_t &view, size_t tileSize);
+
+    size_t size() const; // the number of tiles
+    size_t tile_size() const { return mTileSize; } // the number of elements in every tile but the last
+
+    Tile operator[](size_t);
+
+    Iterator begin() { return Iterator(this, 0u); }
+    Iterator end() { return Iterator(this, size()); }
+
+    private:
+    view_t mView;
+    size_t mTileSize;
+};
+
+
+/** Tiles of tileSize elements each */
+template< typename view_t >
+Tiles<view_t> tiles(const view_t &view, size_t tileSize) {
+    return Tiles<view_t>(view, tileSize);
+}
+
+/**
+ *  The number of elements of a view with the given element size and stride that fit into half of a cache level,
+ *  shared between streams buffers. Rounded down to whole cache lines when there are at least a few of them.
+ */
+inline size_t cache_tile_size(size_t elementBytes, size_t stride, CacheLevel level, size_t streams = 1u) {
+    const size_t budget = cache_size(level) / 2u / (streams > 0u ? streams : 1u);
+    // a Slice with stride s brings in s elements of memory for every element it visits
+    const size_t footprint = elementBytes * stride;
+    size_t elements = footprint > 0u ? budget / footprint : 0u;
+
+    const size_t lineElements = cache_sizes().line / elementBytes;
+    if(lineElements > 0u && elements >= 4u * lineElements)
+        elements -= elements % lineElements;
+    return elements > 0u ? elements : 1u;
+}
+
+/** Tiles sized to fit a cache level, for processing together with streams - 1 other buffers of the same layout */
+template< typename view_t >
+Tiles<view_t> cache_tiles(const view_t &view, CacheLevel level = CacheLevel::l2, size_t streams = 1u) {
+    return Tiles<view_t>(view,
+        cache_tile_size(sizeof(detail::element_t<view_t>), detail::stride_at(view), level, streams));
+}
+
+
+
+template< typename view_t >
+Tiles<view_t>::Tiles(const view_t &view, size_t tileSize)
+    : mView(view)
+    , mTileSize(tileSize)
+{
+    cpp_buffer_assert(tileSize > 0u);
+}
+
+template< typename view_t >
+size_t Tiles<view_t>::size() const {
+    return (mView.size() + mTileSize - 1u) / mTileSize;
+}
+
+template< typename view_t >
+typename Tiles<view_t>::Tile Tiles<view_t>::operator[](size_t i) {
+    const size_t begin = i * mTileSize;
+    cpp_buffer_assert(begin < mView.size());
+    const size_t end = mView.size() - begin > mTileSize ? begin + mTileSize : mView.size();
+    return mView.slice(begin, end);
+}
+
+}// namespace CPPBuffer
@@ -0,0 +1,114 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/algorithms.h>
+
+#include <numeric>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(Algorithms) {};
+
+TEST(Algorithms, fill)
+{
+    Buffer<float> buffer(1001);
+    fill(buffer, 2.0f);
+    CHECK_TRUE(std::accumulate(buffer.begin(), buffer.end(), 0.0f) == 2002.0f);
+
+    auto odds = buffer.slice<2>(1, buffer.size());
+    fill(odds, 0.0f);
+    CHECK_TRUE(buffer[0] == 2.0f && buffer[1] == 0.0f && buffer[1000] == 2.0f);
+}
+
+TEST(Algorithms, copy)
+{
+    Buffer<int> src(300);
+    std::iota(src.begin(), src.end(), 0);
+
+    Buffer<int> dst(300);
+    copy(src, dst);
+    CHECK_TRUE(std::equal(src.begin(), src.end(), dst.begin()));
+
+    // de-interleave the even elements into a contiguous buffer, and interleave them back into the odd ones
+    Buffer<int> evens(150);
+    copy(src.slice<2>(), evens);
+    CHECK_TRUE(evens[0] == 0 && evens[1] == 2 && evens[149] == 298);
+
+    auto odds = dst.slice<2>(1, dst.size());
+    copy(evens, odds);
+    CHECK_TRUE(dst[1] == 0 && dst[3] == 2 && dst[299] == 298);
+}
+
+TEST(Algorithms, axpy)
+{
+    Buffer<double> x(100);
+    Buffer<double> y(100);
+    std::iota(x.begin(), x.end(), 0.0);
+    fill(y, 1.0);
+
+    axpy(2.0, x, y);
+    CHECK_TRUE(y[0] == 1.0 && y[10] == 21.0 && y[99] == 199.0);
+
+    auto strided = x.slice<3>(0, 30);
+    auto target = y.slice(0, 10);
+    axpy(-1.0, strided, target);
+    CHECK_TRUE(y[1] == 0.0 && y[9] == 19.0 - 27.0);
+}
+
+TEST(Algorithms, dot)
+{
+    Buffer<float> x(1000);
+    Buffer<float> y(1000);
+    fill(x, 0.5f);
+    fill(y, 4.0f);
+    DOUBLES_EQUAL(2000.0, dot(x, y), 1e-3);
+
+    Buffer<uint8_t> bytes(1000);
+    fill(bytes, uint8_t(200));
+    CHECK_TRUE(dot(bytes, bytes) == 1000 * 200 * 200);
+}
+
+TEST(Algorithms, sum)
+{
+    Buffer<int> buffer(1000);
+    std::iota(buffer.begin(), buffer.end(), 1);
+    CHECK_TRUE(sum(buffer) == 500500);
+    CHECK_TRUE(sum(buffer.slice<2>()) == 250000);
+    CHECK_TRUE(sum(buffer.slice<4>(3, 7)) == 4);
+    CHECK_TRUE(sum(buffer.slice(0, 0)) == 0);
+
+    Buffer<uint8_t> bytes(1000);
+    fill(bytes, uint8_t(255));
+    CHECK_TRUE(sum(bytes) == 255000);
+
+    Buffer<float> stereo(2 * 513);
+    for(size_t i = 0; i < stereo.size(); ++i)
+        stereo[static_cast<int>(i)] = (i % 2) ? -1.0f : 0.25f;
+    auto left = stereo.slice<2>();
+    auto right = stereo.slice<2>(1, stereo.size());
+    DOUBLES_EQUAL(513 * 0.25, sum(left), 1e-4);
+    DOUBLES_EQUAL(-513.0, sum(right), 1e-4);
+}
+
+TEST(Algorithms, minmax)
+{
+    Buffer<float> buffer(777);
+    for(size_t i = 0; i < buffer.size(); ++i)
+        buffer[static_cast<int>(i)] = static_cast<float>((i * 37) % 101) - 50.0f;
+    CHECK_TRUE(min(buffer) == -50.0f);
+    CHECK_TRUE(max(buffer) == 50.0f);
+
+    buffer[776] = 1000.0f;
+    CHECK_TRUE(max(buffer) == 1000.0f);
+    CHECK_TRUE(max(buffer.slice<2>(1, buffer.size())) < 1000.0f);
+    CHECK_TRUE(min(buffer.slice(776, 777)) == 1000.0f);
+}
+
+TEST(Algorithms, mismatchedSizesThrow)
+{
+    Buffer<float> a(100), b(99), empty;
+    CHECK_THROWS(OutOfRangeError, copy(a, b));
+    CHECK_THROWS(OutOfRangeError, axpy(2.0f, a, b));
+    CHECK_THROWS(OutOfRangeError, dot(a, b.slice<2>()));
+    CHECK_THROWS(OutOfRangeError, min(empty));
+    CHECK_THROWS(OutOfRangeError, max(a.slice(50, 50)));
+    CHECK_TRUE(b[98] == 0.0f); // nothing was written
+}
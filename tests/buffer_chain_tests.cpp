@@ -0,0 +1,143 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/buffer_chain.h>
+
+#include <numeric>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace CPPBuffer;
+
+namespace {
+
+Buffer<uint8_t> counting(size_t n, uint8_t first) {
+    Buffer<uint8_t> buffer(n);
+    std::iota(buffer.begin(), buffer.end(), first);
+    return buffer;
+}
+
+std::vector<uint8_t> flatten(const BufferChain<> &chain) {
+    return std::vector<uint8_t>(chain.begin(), chain.end());
+}
+
+}
+
+TEST_GROUP(BufferChain) {};
+
+TEST(BufferChain, appendAndIterate)
+{
+    BufferChain<> chain;
+    chain.append(counting(3, 0));
+    chain.append(Buffer<uint8_t>());
+    chain.append(counting(10, 3).slice(0, 4));
+    chain.prepend(counting(2, 100));
+
+    CHECK_TRUE(chain.segment_count() == 3);
+    CHECK_TRUE(chain.size() == 9);
+    CHECK_TRUE((flatten(chain) == std::vector<uint8_t>{100, 101, 0, 1, 2, 3, 4, 5, 6}));
+    CHECK_TRUE(chain[0] == 100 && chain[2] == 0 && chain[8] == 6);
+
+    chain[8] = 42;
+    CHECK_TRUE(chain.segment(2)[3] == 42);
+}
+
+TEST(BufferChain, outOfRangeThrows)
+{
+    BufferChain<> chain;
+    chain.append(counting(3, 0));
+    chain.append(counting(3, 3));
+    const BufferChain<> &constant = chain;
+
+    CHECK_THROWS(OutOfRangeError, chain[6]);
+    CHECK_THROWS(OutOfRangeError, constant[6]);
+    CHECK_THROWS(OutOfRangeError, chain.trim_front(7));
+    CHECK_THROWS(OutOfRangeError, chain.trim_back(7));
+    CHECK_THROWS(OutOfRangeError, chain.split(7));
+    CHECK_TRUE(chain.size() == 6 && chain[5] == 5); // untouched
+}
+
+TEST(BufferChain, sharesMemory)
+{
+    Buffer<uint8_t> payload = counting(8, 0);
+    BufferChain<> chain;
+    chain.append(payload);
+    CHECK_TRUE(chain.segment(0).begin() == payload.begin());
+}
+
+TEST(BufferChain, trim)
+{
+    BufferChain<> chain;
+    chain.append(counting(4, 0));
+    chain.append(counting(4, 4));
+    chain.append(counting(4, 8));
+
+    chain.trim_front(5);
+    CHECK_TRUE(chain.size() == 7 && chain.segment_count() == 2);
+    CHECK_TRUE(chain[0] == 5);
+
+    chain.trim_back(4);
+    CHECK_TRUE((flatten(chain) == std::vector<uint8_t>{5, 6, 7}));
+    CHECK_TRUE(chain.segment_count() == 1);
+
+    chain.trim_front(3);
+    CHECK_TRUE(chain.empty() && chain.segment_count() == 0);
+}
+
+TEST(BufferChain, split)
+{
+    BufferChain<> chain;
+    chain.append(counting(4, 0));
+    chain.append(counting(4, 4));
+
+    auto tail = chain.split(6);
+    CHECK_TRUE((flatten(chain) == std::vector<uint8_t>{0, 1, 2, 3, 4, 5}));
+    CHECK_TRUE((flatten(tail) == std::vector<uint8_t>{6, 7}));
+
+    auto boundary = chain.split(4);
+    CHECK_TRUE(chain.segment_count() == 1 && boundary.segment_count() == 1);
+    CHECK_TRUE(boundary[0] == 4);
+
+    auto nothing = chain.split(chain.size());
+    CHECK_TRUE(nothing.empty());
+}
+
+TEST(BufferChain, spillsToHeap)
+{
+    BufferChain<uint8_t, std::shared_ptr<uint8_t>, 2u> chain;
+    for(uint8_t i = 0; i < 10; ++i)
+        chain.append(counting(1, i));
+    CHECK_TRUE(chain.segment_count() == 10);
+    CHECK_TRUE(chain[9] == 9);
+
+    chain.trim_front(9);
+    CHECK_TRUE(chain.segment_count() == 1 && chain[0] == 9);
+    chain.append(counting(1, 10));
+    chain.append(counting(1, 11));
+    CHECK_TRUE(chain[2] == 11);
+}
+
+TEST(BufferChain, iovec)
+{
+    BufferChain<> chain;
+    chain.append(counting(3, 0));
+    chain.append(counting(5, 3));
+    chain.append(counting(1, 8));
+
+    struct iovec iov[BufferChain<>::inline_segments];
+    CHECK_TRUE(chain.to_iovec(iov, BufferChain<>::inline_segments) == 3);
+    CHECK_TRUE(iov[0].iov_len == 3 && iov[1].iov_len == 5 && iov[2].iov_len == 1);
+    CHECK_TRUE(static_cast<uint8_t *>(iov[1].iov_base)[0] == 3);
+
+    CHECK_TRUE(chain.to_iovec(iov, 2) == 2);
+
+    // gather them back together through a pipe
+    int fds[2];
+    CHECK_TRUE(pipe(fds) == 0);
+    CHECK_TRUE(writev(fds[1], iov, static_cast<int>(chain.to_iovec(iov, 4))) == 9);
+    uint8_t received[9];
+    CHECK_TRUE(read(fds[0], received, sizeof(received)) == 9);
+    close(fds[0]);
+    close(fds[1]);
+    for(uint8_t i = 0; i < 9; ++i)
+        CHECK_TRUE(received[i] == i);
+}
@@ -0,0 +1,157 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/buffer_pool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(BufferPool) {};
+
+TEST(BufferPool, recyclesBlocks)
+{
+    BufferPool pool;
+    const float *first = nullptr;
+    {
+        Buffer<float> buffer(100, pool);
+        first = buffer.begin();
+        CHECK_TRUE(std::all_of(buffer.begin(), buffer.end(), [](float f) { return f == 0.0f; }));
+        CHECK_TRUE(pool.outstanding() == 1);
+    }
+    CHECK_TRUE(pool.outstanding() == 0);
+
+    Buffer<float> again(100, pool, uninitialized);
+    CHECK_TRUE(again.begin() == first);
+}
+
+TEST(BufferPool, copiesShareTheBlock)
+{
+    BufferPool pool;
+    Buffer<int> copy;
+    {
+        Buffer<int> buffer(10, pool);
+        buffer[3] = 42;
+        copy = buffer;
+    }
+    CHECK_TRUE(pool.outstanding() == 1);
+    CHECK_TRUE(copy[3] == 42);
+    copy = Buffer<int>();
+    CHECK_TRUE(pool.outstanding() == 0);
+}
+
+TEST(BufferPool, reserveAvoidsGrowing)
+{
+    BufferPool pool;
+    pool.reserve<uint8_t>(1500, 64);
+    const size_t slabs = pool.slabs().size();
+
+    std::vector<Buffer<uint8_t>> packets;
+    for(int i = 0; i < 64; ++i)
+        packets.emplace_back(1500, pool, uninitialized);
+    CHECK_TRUE(pool.slabs().size() == slabs);
+}
+
+TEST(BufferPool, oversizedGoesUpstream)
+{
+    BufferPool pool(4096);
+    {
+        Buffer<double> big(10000, pool);
+        CHECK_TRUE(big.size() == 10000);
+        CHECK_TRUE(pool.outstanding() == 1);
+        CHECK_TRUE(pool.slabs().empty());
+    }
+    CHECK_TRUE(pool.outstanding() == 0);
+}
+
+TEST(BufferPool, releasedFromOtherThreads)
+{
+    BufferPool pool;
+    std::vector<Buffer<int>> buffers;
+    for(int i = 0; i < 100; ++i)
+        buffers.emplace_back(16, pool);
+
+    std::thread consumer([&buffers]() { buffers.clear(); });
+    consumer.join();
+    CHECK_TRUE(pool.outstanding() == 0);
+
+    // the blocks released remotely get adopted again
+    const size_t slabs = pool.slabs().size();
+    for(int i = 0; i < 100; ++i)
+        buffers.emplace_back(16, pool);
+    CHECK_TRUE(pool.slabs().size() == slabs);
+}
+
+TEST(BufferPool, onlyTheOwnerAllocates)
+{
+    BufferPool pool;
+    Buffer<int> owned(16, pool);
+    bool failed = false;
+    size_t seen = 0u;
+    std::thread other([&]() {
+        seen = pool.outstanding();
+        try {
+            Buffer<int> stolen(16, pool);
+        } catch(const OutOfRangeError &) {
+            failed = true;
+        }
+    });
+    other.join();
+    CHECK_TRUE(failed);
+    CHECK_TRUE(seen == 1u);
+    CHECK_TRUE(pool.outstanding() == 1u);
+}
+
+TEST(BufferPool, aligned)
+{
+    BufferPool pool;
+    Buffer<float> small(3, pool, cache_line_aligned);
+    Buffer<float> other(3, pool, cache_line_aligned);
+    CHECK_TRUE(small.alignment() >= 64 && other.alignment() >= 64);
+
+    Buffer<uint8_t> page(100, pool, page_aligned);
+    CHECK_TRUE(page.alignment() >= 4096);
+}
+
+TEST(BufferPool, reset)
+{
+    BufferPool pool;
+    { Buffer<char> buffer(100, pool); }
+    CHECK_FALSE(pool.slabs().empty());
+    pool.reset();
+    CHECK_TRUE(pool.slabs().empty());
+}
+
+TEST(BufferPool, resetChecksForLiveBuffers)
+{
+    BufferPool pool;
+    Buffer<char> alive(100, pool);
+    CHECK_THROWS(OutOfRangeError, pool.reset());
+    alive = Buffer<char>();
+    pool.reset();
+    CHECK_TRUE(pool.slabs().empty());
+}
+
+// AddressSanitizer reports allocations this big instead of throwing
+#if !defined(__SANITIZE_ADDRESS__)
+TEST(BufferPool, failedAllocationsArentCounted)
+{
+    BufferPool pool(4096);
+    // not a constant, or the compiler warns about the size that upstream is about to refuse
+    const size_t huge = SIZE_MAX / 4u + pool.outstanding();
+    CHECK_THROWS(std::bad_alloc, Buffer<char>(huge, pool, uninitialized));
+    CHECK_TRUE(pool.outstanding() == 0);
+    pool.reset();
+}
+#endif
+
+TEST(BufferPool, standardAllocator)
+{
+    std::allocator<int> allocator;
+    Buffer<int> buffer(8, allocator);
+    CHECK_TRUE(buffer.size() == 8);
+    CHECK_TRUE(std::all_of(buffer.begin(), buffer.end(), [](int i) { return i == 0; }));
+}
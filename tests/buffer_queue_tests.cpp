@@ -0,0 +1,84 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/buffer_queue.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(BufferQueue) {};
+
+TEST(BufferQueue, fifo)
+{
+    BufferQueue<Buffer<int>> queue(3);
+    CHECK_TRUE(queue.capacity() == 4);
+
+    for(int i = 0; i < 4; ++i) {
+        Buffer<int> buffer(1);
+        buffer[0] = i;
+        CHECK_TRUE(queue.try_push(std::move(buffer)));
+    }
+    CHECK_FALSE(queue.try_push(Buffer<int>(1)));
+    CHECK_TRUE(queue.size() == 4);
+
+    Buffer<int> out;
+    for(int i = 0; i < 4; ++i)
+        CHECK_TRUE(queue.try_pop(out) && out[0] == i);
+    CHECK_FALSE(queue.try_pop(out));
+}
+
+TEST(BufferQueue, movesOwnership)
+{
+    BufferQueue<Buffer<int>> queue(4);
+    Buffer<int> buffer(8);
+    auto memory = buffer.begin();
+    CHECK_TRUE(queue.try_push(std::move(buffer)));
+    CHECK_TRUE(buffer.begin() == nullptr);
+
+    Buffer<int> out;
+    CHECK_TRUE(queue.try_pop(out));
+    CHECK_TRUE(out.begin() == memory && out.size() == 8);
+}
+
+TEST(BufferQueue, threads)
+{
+    BufferQueue<Buffer<uint32_t>> queue(64);
+    const uint32_t perProducer = 20000;
+    const int producers = 3;
+    const int consumers = 3;
+
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint32_t> received{0};
+    std::vector<std::thread> threads;
+
+    for(int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, p]() {
+            for(uint32_t i = 0; i < perProducer; ++i) {
+                Buffer<uint32_t> buffer(1);
+                buffer[0] = p * perProducer + i;
+                while(!queue.try_push(std::move(buffer)))
+                    std::this_thread::yield();
+            }
+        });
+    }
+    for(int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&]() {
+            Buffer<uint32_t> buffer;
+            while(received.load() < producers * perProducer) {
+                if(queue.try_pop(buffer)) {
+                    total += buffer[0];
+                    ++received;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for(auto &thread : threads)
+        thread.join();
+
+    const uint64_t n = uint64_t(producers) * perProducer;
+    CHECK_TRUE(received.load() == n);
+    CHECK_TRUE(total.load() == n * (n - 1) / 2);
+}
@@ -0,0 +1,149 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/algorithms.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/small_buffer.h>
+
+#include <numeric>
+
+using namespace CPPBuffer;
+
+namespace {
+
+float mean(BufferView<const float> samples) {
+    return std::accumulate(samples.begin(), samples.end(), 0.0f) / samples.size();
+}
+
+double total(SliceView<const double, dynamic_stride> values) {
+    double result = 0.0;
+    for(double value : values)
+        result += value;
+    return result;
+}
+
+void scale(SliceView<float, 2u> values, float gain) {
+    for(float &value : values)
+        value *= gain;
+}
+
+}
+
+TEST_GROUP(BufferView) {};
+
+TEST(BufferView, buffersAndSlicesConvert)
+{
+    Buffer<float> buffer(10);
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+
+    // none of these touch the reference count
+    DOUBLES_EQUAL(4.5, mean(buffer), 0.0);
+    DOUBLES_EQUAL(1.0, mean(buffer.slice(0, 3)), 0.0);
+    const Buffer<float> &constant = buffer;
+    DOUBLES_EQUAL(4.5, mean(constant), 0.0);
+    CHECK_TRUE(buffer.use_count() == 1);
+
+    scale(buffer.slice<2>(1, 10), -1.0f);
+    DOUBLES_EQUAL(-1.0, buffer[1], 0.0);
+    DOUBLES_EQUAL(2.0, buffer[2], 0.0);
+    DOUBLES_EQUAL(-9.0, buffer[9], 0.0);
+
+    StaticBuffer<float, 4> fixed = {1.0f, 2.0f, 3.0f, 6.0f};
+    DOUBLES_EQUAL(3.0, mean(fixed), 0.0);
+
+    BufferView<float> view = buffer;
+    CHECK_TRUE(view.begin() == buffer.begin() && view.size() == buffer.size());
+    BufferView<const float> constView = view;
+    CHECK_TRUE(constView.begin() == buffer.begin());
+}
+
+TEST(BufferView, anyStrideConvertsToDynamic)
+{
+    Buffer<double> matrix(12);
+    std::iota(matrix.begin(), matrix.end(), 0.0);
+
+    DOUBLES_EQUAL(66.0, total(matrix), 0.0);
+    DOUBLES_EQUAL(0.0 + 3 + 6 + 9, total(matrix.slice<3>()), 0.0);
+    DOUBLES_EQUAL(1.0 + 5 + 9, total(matrix.slice(1, 12, 4)), 0.0);
+
+    SliceView<const double, dynamic_stride> column = matrix.slice(2, 12, 4);
+    CHECK_TRUE(column.size() == 3u && column.stride() == 4u);
+    DOUBLES_EQUAL(10.0, column[2], 0.0);
+    DOUBLES_EQUAL(1.0 + 5 + 9, total(SliceView<double, 4u>(matrix.begin() + 1, 3)), 0.0);
+}
+
+TEST(BufferView, viewsAreCheckedAndSlice)
+{
+    Buffer<int> buffer(20);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    BufferView<int> view = buffer;
+
+    CHECK_THROWS(OutOfRangeError, view[20]);
+    CHECK_THROWS(OutOfRangeError, view.slice(5, 21));
+    CHECK_THROWS(OutOfRangeError, view.checked(10, 30));
+
+    SliceView<int, 2u> evens = view.slice<2>();
+    CHECK_TRUE(evens.size() == 10u && evens[9] == 18);
+    SliceView<int, 6u> sixes = evens.slice<3>(1, 10);
+    CHECK_TRUE(sixes.size() == 3u && sixes[0] == 2 && sixes[2] == 14);
+    CHECK_THROWS(OutOfRangeError, sixes[3]);
+
+    SliceView<int, dynamic_stride> tens = view.slice(3, 20, 10);
+    CHECK_TRUE(tens.size() == 2u && tens[1] == 13);
+    CHECK_TRUE(tens.slice<1>(1, 2)[0] == 13);
+    auto tensWindow = tens.checked(1, 2);
+    CHECK_TRUE(tensWindow.size() == 1u && tensWindow.stride() == 10u && tensWindow[0] == 13);
+    CHECK_TRUE(tens.checked().size() == 2u && *tens.checked().begin() == 3);
+    CHECK_THROWS(OutOfRangeError, tens.checked(1, 3));
+
+    auto window = evens.checked(2, 5);
+    CHECK_TRUE(window.size() == 3u && window[0] == 4 && window[2] == 8);
+
+    // views are shallow: a const view still writes to the elements
+    const BufferView<int> constant = buffer;
+    constant[0] = -1;
+    CHECK_TRUE(buffer[0] == -1);
+}
+
+TEST(BufferView, algorithmsTakeViews)
+{
+    Buffer<float> a(64), b(64);
+    std::iota(a.begin(), a.end(), 0.0f);
+    fill(BufferView<float>(b), 2.0f);
+
+    BufferView<const float> x = a;
+    SliceView<const float, dynamic_stride> odd = a.slice(1, 64, 2);
+    DOUBLES_EQUAL(2016.0, sum(x), 0.0);
+    DOUBLES_EQUAL(1024.0, sum(odd), 0.0);
+    DOUBLES_EQUAL(4032.0, dot(x, BufferView<const float>(b)), 0.0);
+}
+
+#if CPPBUFFER_HAS_SPAN
+TEST(BufferView, spansConvertBothWays)
+{
+    Buffer<int> buffer(8);
+    std::iota(buffer.begin(), buffer.end(), 1);
+
+    std::span<int> span = as_span(buffer);
+    CHECK_TRUE(span.data() == buffer.begin() && span.size() == 8u);
+    std::span<const int> tail = as_span(BufferView<const int>(buffer).slice(4, 8));
+    CHECK_TRUE(tail.size() == 4u && tail[0] == 5);
+
+    BufferView<const int> view = span.subspan(2, 3);
+    CHECK_TRUE(view.size() == 3u && view[0] == 3);
+    CHECK_THROWS(OutOfRangeError, view[3]);
+}
+#endif
+
+#if CPPBUFFER_HAS_MDSPAN
+TEST(BufferView, mdspansOfAnyStride)
+{
+    Buffer<float> buffer(12);
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+
+    auto matrix = as_mdspan(buffer, 3u, 4u);
+    DOUBLES_EQUAL(6.0, (matrix[1, 2]), 0.0);
+
+    auto column = as_mdspan(buffer.slice(1, 12, 4));
+    CHECK_TRUE(column.extent(0) == 3u && column.stride(0) == 4u);
+    DOUBLES_EQUAL(9.0, column[2], 0.0);
+}
+#endif
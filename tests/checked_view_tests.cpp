@@ -0,0 +1,105 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/buffer.h>
+
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <numeric>
+#include <thread>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(BoundsChecks) {};
+
+TEST(BoundsChecks, outOfRangeThrows)
+{
+    Buffer<int> buffer(10);
+    const Buffer<int> &constBuffer = buffer;
+    CHECK_THROWS(OutOfRangeError, buffer[10]);
+    CHECK_THROWS(OutOfRangeError, buffer[-1]);
+    CHECK_THROWS(OutOfRangeError, constBuffer[10]);
+    CHECK_THROWS(OutOfRangeError, buffer.slice(4, 11));
+    CHECK_THROWS(OutOfRangeError, buffer.slice(5, 4));
+
+    auto odd = buffer.slice<2>(1, 10);
+    CHECK_THROWS(OutOfRangeError, odd[5]);
+    CHECK_THROWS(OutOfRangeError, odd.slice(0, 6));
+}
+
+TEST(BoundsChecks, reportsWhereItFailed)
+{
+    Buffer<int> buffer(4);
+    try {
+        buffer[4] = 1;
+        CHECK_TRUE(false);
+    } catch(const OutOfRangeError &error) {
+        CHECK_TRUE(std::strstr(error.file(), "buffer.h") != nullptr);
+        CHECK_TRUE(error.line() > 0);
+        CHECK_TRUE(std::strstr(error.what(), error.condition()) != nullptr);
+    }
+}
+
+TEST(BoundsChecks, messagesAreFormattedWhenThrown)
+{
+    Buffer<int> buffer(4);
+    std::exception_ptr failure;
+    try {
+        buffer[4] = 1;
+    } catch(...) {
+        failure = std::current_exception();
+    }
+    CHECK_TRUE(failure != nullptr);
+
+    // what() only reads the message, so threads can look at the same exception at once
+    std::atomic<int> matched{0};
+    auto check = [&failure, &matched]() {
+        try {
+            std::rethrow_exception(failure);
+        } catch(const OutOfRangeError &error) {
+            if(std::strstr(error.what(), "buffer assert condition failed") != nullptr)
+                ++matched;
+        }
+    };
+    std::thread other(check);
+    check();
+    other.join();
+    CHECK_TRUE(matched == 2);
+}
+
+TEST_GROUP(CheckedView) {};
+
+TEST(CheckedView, bufferWindow)
+{
+    Buffer<int> buffer(10);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    CheckedView<int> window = buffer.checked(2, 7);
+    CHECK_TRUE(window.size() == 5u);
+    CHECK_TRUE(window[0] == 2 && window[4] == 6);
+    window[1] = -1;
+    CHECK_TRUE(buffer[3] == -1);
+    CHECK_TRUE(std::accumulate(window.begin(), window.end(), 0) == 2 - 1 + 4 + 5 + 6);
+
+    const Buffer<int> &constBuffer = buffer;
+    CheckedView<const int> all = constBuffer.checked();
+    CHECK_TRUE(all.size() == 10u && all[9] == 9);
+
+    CHECK_THROWS(OutOfRangeError, buffer.checked(8, 11));
+    CHECK_THROWS(OutOfRangeError, buffer.checked(3, 2));
+    CHECK_TRUE(buffer.checked(10, 10).size() == 0u);
+}
+
+TEST(CheckedView, sliceWindow)
+{
+    Buffer<int> buffer(20);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    auto odd = buffer.slice<2>(1, 20); // 1, 3, ..., 19
+
+    CheckedView<int, 2u> window = odd.checked(3, 6);
+    CHECK_TRUE(window.size() == 3u);
+    CHECK_TRUE(window[0] == 7 && window[2] == 11);
+    CHECK_TRUE(std::accumulate(window.begin(), window.end(), 0) == 7 + 9 + 11);
+
+    CHECK_TRUE(odd.checked().size() == odd.size());
+    CHECK_THROWS(OutOfRangeError, odd.checked(0, 11));
+}
@@ -0,0 +1,93 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/algorithms.h>
+#include <cpp_buffer/cow_buffer.h>
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <type_traits>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(CowBuffer) {};
+
+TEST(CowBuffer, copiesShareUntilWritten)
+{
+    CowBuffer<int> original(8);
+    std::iota(original.begin(), original.end(), 0);
+    CHECK_FALSE(original.is_shared());
+
+    CowBuffer<int> copy = original;
+    const CowBuffer<int> &reader = copy;
+    CHECK_TRUE(original.is_shared() && copy.is_shared());
+    CHECK_TRUE(reader.begin() == static_cast<const CowBuffer<int> &>(original).begin());
+    CHECK_TRUE(reader[3] == 3 && sum(reader) == 28);
+    CHECK_TRUE(copy.is_shared()); // reading didn't clone
+
+    copy[3] = -1;
+    CHECK_FALSE(copy.is_shared());
+    CHECK_FALSE(original.is_shared());
+    CHECK_TRUE(copy[3] == -1 && original[3] == 3);
+    CHECK_TRUE(copy[7] == 7);
+}
+
+TEST(CowBuffer, onlyOwnerWritesInPlace)
+{
+    CowBuffer<int> buffer(4);
+    const int *before = static_cast<const CowBuffer<int> &>(buffer).begin();
+    buffer[0] = 1;
+    fill(buffer, 2);
+    CHECK_TRUE(static_cast<const CowBuffer<int> &>(buffer).begin() == before);
+
+    {
+        CowBuffer<int> copy = buffer;
+    }
+    buffer[1] = 3; // the copy is gone, so nothing to clone
+    CHECK_TRUE(static_cast<const CowBuffer<int> &>(buffer).begin() == before);
+}
+
+TEST(CowBuffer, adoptedBufferIsNotWritten)
+{
+    Buffer<int> plain(4);
+    std::iota(plain.begin(), plain.end(), 10);
+
+    CowBuffer<int> cow(plain);
+    CHECK_TRUE(cow.is_shared());
+    cow.checked()[0] = 0;
+    CHECK_TRUE(plain[0] == 10 && cow[0] == 0);
+    CHECK_TRUE(cow.checked(1, 4)[2] == 13);
+    CHECK_TRUE(plain.use_count() == 1);
+}
+
+TEST(CowBuffer, clonesNonTrivialTypes)
+{
+    CowBuffer<std::string> names(2);
+    names[0] = "left";
+    names[1] = "right";
+
+    CowBuffer<std::string> copy = names;
+    copy[1] = "centre";
+    CHECK_TRUE(names[1] == "right" && copy[1] == "centre" && copy[0] == "left");
+    CHECK_THROWS(OutOfRangeError, copy[2]);
+}
+
+TEST(CowBuffer, clonesByCopyConstructing)
+{
+    struct Label
+    {
+        explicit Label(int id) : id(id) {}
+        int id;
+    };
+    static_assert(!std::is_default_constructible<Label>::value, "clones must not need a default constructor");
+
+    Buffer<Label> labels(std::shared_ptr<Label>(new Label[2]{Label(1), Label(2)}, std::default_delete<Label[]>()), 2);
+    CowBuffer<Label> cow(labels);
+    cow[1].id = 3;
+    CHECK_TRUE(labels[1].id == 2 && cow[0].id == 1 && cow[1].id == 3);
+
+    CowBuffer<std::string, local_shared_ptr<std::string>> local(2);
+    local[0] = "kept";
+    CowBuffer<std::string, local_shared_ptr<std::string>> copy = local;
+    copy[1] = "changed";
+    CHECK_TRUE(local[1].empty() && copy[0] == "kept" && copy[1] == "changed");
+}
@@ -0,0 +1,135 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/algorithms.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/strided_view.h>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(DynamicSlice) {};
+
+TEST(DynamicSlice, stridesFromABuffer)
+{
+    Buffer<int> buffer(1000);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    Slice<int, dynamic_stride> column = buffer.slice(7, buffer.size(), 300); // 7, 307, 607, 907
+    CHECK_TRUE(column.stride() == 300u);
+    CHECK_TRUE(column.size() == 4u);
+    CHECK_TRUE(column[0] == 7 && column[3] == 907);
+    CHECK_TRUE(std::accumulate(column.begin(), column.end(), 0) == 7 + 307 + 607 + 907);
+    CHECK_TRUE(column.end() - column.begin() == 4);
+
+    column[1] = -1;
+    CHECK_TRUE(buffer[307] == -1);
+
+    CHECK_TRUE(buffer.slice(0, 0, 5).size() == 0u);
+    CHECK_THROWS(OutOfRangeError, column[4]);
+    CHECK_THROWS(OutOfRangeError, buffer.slice(0, 10, 0));
+    CHECK_THROWS(OutOfRangeError, buffer.slice(0, 1001, 2));
+}
+
+TEST(DynamicSlice, slicesCompound)
+{
+    Buffer<int> buffer(100);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    auto every3rd = buffer.slice<3>(1, 100); // 1, 4, 7, ...
+    Slice<int, dynamic_stride> wide = every3rd.slice(2, every3rd.size(), 10); // 7, 37, 67, 97
+    CHECK_TRUE(wide.stride() == 30u);
+    CHECK_TRUE(wide.size() == 4u);
+    CHECK_TRUE(wide[0] == 7 && wide[3] == 97);
+
+    auto again = wide.slice<2>(); // 7, 67
+    CHECK_TRUE(again.stride() == 60u && again.size() == 2u && again[1] == 67);
+    auto tail = wide.slice(1, 4, 2); // 37, 97
+    CHECK_TRUE(tail.size() == 2u && tail[0] == 37 && tail[1] == 97);
+    CHECK_THROWS(OutOfRangeError, wide.slice(0, 5));
+}
+
+TEST(DynamicSlice, checkedWindows)
+{
+    Buffer<int> buffer(1000);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    Slice<int, dynamic_stride> column = buffer.slice(7, buffer.size(), 300); // 7, 307, 607, 907
+
+    CheckedView<int, dynamic_stride> middle = column.checked(1, 3);
+    CHECK_TRUE(middle.size() == 2u && middle.stride() == 300u);
+    CHECK_TRUE(middle[0] == 307 && middle[1] == 607);
+    middle[1] = -1;
+    CHECK_TRUE(buffer[607] == -1);
+    CHECK_THROWS(OutOfRangeError, column.checked(2, 5));
+    CHECK_THROWS(OutOfRangeError, column.checked(3, 2));
+
+    const Slice<int, dynamic_stride> &constant = column;
+    CheckedView<const int, dynamic_stride> all = constant.checked();
+    CHECK_TRUE(all.size() == 4u && all[3] == 907);
+    CHECK_TRUE(std::accumulate(all.begin(), all.end(), 0) == 7 + 307 - 1 + 907);
+    CHECK_TRUE(constant.checked(4, 4).size() == 0u);
+    CHECK_THROWS(OutOfRangeError, constant.checked(0, 5));
+    CHECK_TRUE(column.checked().end() - column.checked().begin() == 4);
+}
+
+TEST(DynamicSlice, convertsFromAStaticSlice)
+{
+    Buffer<int> buffer(10);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    Slice<int, dynamic_stride> odd = buffer.slice<2>(1, 10);
+    CHECK_TRUE(odd.stride() == 2u && odd.size() == 5u);
+    CHECK_TRUE(odd[4] == 9);
+
+    const Slice<int, dynamic_stride> &constOdd = odd;
+    Slice<int, dynamic_stride>::ConstIterator it = constOdd.begin();
+    CHECK_TRUE(*(it + 2) == 5);
+}
+
+TEST(DynamicSlice, algorithmsTakeEveryStride)
+{
+    Buffer<float> buffer(4096);
+    std::iota(buffer.begin(), buffer.end(), 0.0f);
+
+    // small runtime strides run through the compile-time kernels, the wide ones through the prefetching one
+    for(size_t stride : {1u, 2u, 3u, 4u, 5u, 16u, 100u}) {
+        Slice<float, dynamic_stride> view = buffer.slice(0, buffer.size(), stride);
+        auto compileTime = std::accumulate(view.begin(), view.end(), 0.0);
+        DOUBLES_EQUAL(compileTime, sum(view), 1e-3);
+        DOUBLES_EQUAL(0.0, min(view), 0.0);
+        DOUBLES_EQUAL(float((view.size() - 1u) * stride), max(view), 0.0);
+    }
+
+    Buffer<float> other(4096);
+    fill(other, 0.0f);
+    auto wide = other.slice(0, other.size(), 64);
+    fill(wide, 2.0f);
+    DOUBLES_EQUAL(2.0 * wide.size(), sum(other), 0.0);
+
+    auto x = buffer.slice(0, buffer.size(), 64);
+    copy(x, wide);
+    CHECK_TRUE(std::equal(x.begin(), x.end(), wide.begin()));
+    axpy(1.0f, x, wide);
+    DOUBLES_EQUAL(2.0 * sum(x), sum(wide), 1e-3);
+    DOUBLES_EQUAL(2.0 * dot(x, x), dot(x, wide), 1.0);
+
+    // mixed with a compile-time stride
+    auto contiguous = other.slice(0, x.size());
+    copy(x, contiguous);
+    DOUBLES_EQUAL(dot(x, x), dot(contiguous, x), 1.0);
+}
+
+TEST(DynamicSlice, fromAStridedView)
+{
+    Buffer<int> buffer(12);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    StridedView<int, 2> matrix(buffer, {3, 4});
+    Slice<int, dynamic_stride> column = matrix.transposed()[1].as_slice(); // 1, 5, 9
+    CHECK_TRUE(column.stride() == 4u);
+    CHECK_TRUE(column.size() == 3u && column[0] == 1 && column[2] == 9);
+
+    StridedView<int, 1, 300> wide;
+    Slice<int, dynamic_stride> wideSlice = wide.as_slice();
+    CHECK_TRUE(wideSlice.size() == 0u);
+}
@@ -0,0 +1,86 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/expressions.h>
+
+#include <numeric>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(Expressions) {};
+
+TEST(Expressions, mixIntoABuffer)
+{
+    Buffer<float> a(64), b(64), out(64);
+    std::iota(a.begin(), a.end(), 0.0f);
+    std::iota(b.begin(), b.end(), 100.0f);
+    const float gain = 0.25f;
+
+    const float *memory = out.begin();
+    out = a * gain + b * (1.0f - gain);
+    CHECK_TRUE(out.begin() == memory); // evaluated into the elements, not rebound
+    for(size_t i = 0; i < out.size(); ++i)
+        DOUBLES_EQUAL(a[i] * gain + b[i] * (1.0f - gain), out[i], 1e-4);
+}
+
+TEST(Expressions, everyOperator)
+{
+    Buffer<int> a(8), b(8), out(8);
+    std::iota(a.begin(), a.end(), 1);
+    std::iota(b.begin(), b.end(), 10);
+
+    out = (a + b) * 2 - b / a;
+    for(int i = 0; i < 8; ++i)
+        CHECK_TRUE(out[i] == (a[i] + b[i]) * 2 - b[i] / a[i]);
+
+    out = -a + 1;
+    CHECK_TRUE(out[0] == 0 && out[7] == -7);
+    out = 100 - a;
+    CHECK_TRUE(out[0] == 99);
+    out = out * 2 + a; // reads the destination at the index it writes
+    CHECK_TRUE(out[0] == 199 && out[7] == 2 * 92 + 8);
+}
+
+TEST(Expressions, scalarsTakeTheElementType)
+{
+    Buffer<float> a(4);
+    std::iota(a.begin(), a.end(), 1.0f);
+    auto scaled = a * 0.5; // a double, computed in float
+    CHECK_TRUE((std::is_same<decltype(scaled)::value_type, float>::value));
+
+    Buffer<float> result = evaluate(scaled);
+    CHECK_TRUE(result.size() == 4u);
+    DOUBLES_EQUAL(2.0, result[3], 0.0);
+}
+
+TEST(Expressions, slicesOnEitherSide)
+{
+    Buffer<float> interleaved(16), mono(8);
+    std::iota(interleaved.begin(), interleaved.end(), 0.0f);
+
+    auto left = interleaved.slice<2>();
+    auto right = interleaved.slice<2>(1, interleaved.size());
+    mono = (left + right) * 0.5f;
+    DOUBLES_EQUAL(0.5, mono[0], 0.0);
+    DOUBLES_EQUAL(14.5, mono[7], 0.0);
+
+    // into a Slice, and with a runtime stride
+    auto wideRight = interleaved.slice(1, interleaved.size(), 2);
+    left = mono * 2.0f - wideRight;
+    DOUBLES_EQUAL(0.0, interleaved[0], 0.0);
+    DOUBLES_EQUAL(29.0 - 15.0, interleaved[14], 0.0);
+    DOUBLES_EQUAL(15.0, interleaved[15], 0.0); // the other channel is untouched
+}
+
+TEST(Expressions, mismatchedSizesThrow)
+{
+    Buffer<float> a(8), b(8), shorter(4), out(8);
+    std::iota(a.begin(), a.end(), 1.0f);
+
+    CHECK_THROWS(OutOfRangeError, out = a + shorter);
+    CHECK_THROWS(OutOfRangeError, shorter = a * 2.0f);
+    auto evens = a.slice<2>();
+    CHECK_THROWS(OutOfRangeError, out = evens - b);
+
+    // nothing was written by the failed assignments
+    DOUBLES_EQUAL(0.0, out[0], 0.0);
+    DOUBLES_EQUAL(0.0, shorter[3], 0.0);
+}
@@ -0,0 +1,97 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/instrumentation.h>
+#include <cpp_buffer/local_shared_ptr.h>
+
+#include <cstring>
+#include <thread>
+
+using namespace CPPBuffer;
+
+namespace {
+
+const instrumentation::SiteStatistics *find_site(const instrumentation::Statistics &snapshot, const char *name) {
+    for(const auto &site : snapshot.sites) {
+        if(std::strcmp(site.name, name) == 0)
+            return &site;
+    }
+    return nullptr;
+}
+
+Buffer<float> decode(size_t n) {
+    CPPBUFFER_ALLOCATION_SITE("instrumentation_tests.decode");
+    return Buffer<float>(n, uninitialized);
+}
+
+}
+
+TEST_GROUP(Instrumentation) {};
+
+TEST(Instrumentation, countsAllocationsAndLiveBytes)
+{
+    const instrumentation::Statistics before = instrumentation::statistics();
+    {
+        Buffer<int> buffer(100);
+        Buffer<int> copy = buffer; // sharing isn't allocating
+        Buffer<int, 1u, local_shared_ptr<int>> local(10);
+
+        const instrumentation::Statistics during = instrumentation::statistics();
+        CHECK_TRUE(during.allocations == before.allocations + 2u);
+        CHECK_TRUE(during.deallocations == before.deallocations);
+        CHECK_TRUE(during.liveAllocations() == before.liveAllocations() + 2);
+        CHECK_TRUE(during.liveBytes() >= before.liveBytes() + int64_t(110 * sizeof(int)));
+    }
+    const instrumentation::Statistics after = instrumentation::statistics();
+    CHECK_TRUE(after.allocations == before.allocations + 2u);
+    CHECK_TRUE(after.deallocations == before.deallocations + 2u);
+    CHECK_TRUE(after.liveBytes() == before.liveBytes());
+}
+
+TEST(Instrumentation, sitesAttributeAllocations)
+{
+    const instrumentation::Statistics before = instrumentation::statistics();
+    Buffer<float> small = decode(10);
+    Buffer<float> large = decode(1000);
+    Buffer<char> elsewhere(50);
+
+    const instrumentation::Statistics after = instrumentation::statistics();
+    const instrumentation::SiteStatistics *site = find_site(after, "instrumentation_tests.decode");
+    CHECK_TRUE(site != nullptr);
+    const instrumentation::SiteStatistics *earlier = find_site(before, "instrumentation_tests.decode");
+    const uint64_t earlierAllocations = earlier ? earlier->allocations : 0u;
+    CHECK_TRUE(site->allocations == earlierAllocations + 2u);
+    CHECK_TRUE(site->largest >= 1000 * sizeof(float));
+
+    // the allocation outside of decode went back to being unattributed
+    const instrumentation::SiteStatistics *unattributed = find_site(after, "(unattributed)");
+    CHECK_TRUE(unattributed != nullptr);
+    CHECK_TRUE(unattributed->allocations >= 1u);
+    CHECK_TRUE(after.sites.front().name == unattributed->name);
+}
+
+TEST(Instrumentation, exitedThreadsStayCounted)
+{
+    const instrumentation::Statistics before = instrumentation::statistics();
+    Buffer<double> handedOver;
+    std::thread worker([&handedOver]() {
+        Buffer<double> scratch(64);
+        handedOver = Buffer<double>(32);
+    });
+    worker.join();
+
+    const instrumentation::Statistics after = instrumentation::statistics();
+    CHECK_TRUE(after.allocations == before.allocations + 2u);
+    CHECK_TRUE(after.deallocations == before.deallocations + 1u);
+
+    handedOver = Buffer<double>(); // freed on another thread than the one that allocated it
+    CHECK_TRUE(instrumentation::statistics().liveBytes() == before.liveBytes());
+}
+
+TEST(Instrumentation, countsFailedChecks)
+{
+    Buffer<int> buffer(4);
+    const uint64_t failures = instrumentation::statistics().assertFailures;
+    CHECK_THROWS(OutOfRangeError, buffer[4]);
+    CHECK_THROWS(OutOfRangeError, buffer.slice(0, 5));
+    CHECK_TRUE(instrumentation::statistics().assertFailures == failures + 2u);
+}
@@ -0,0 +1,174 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/io_ring.h>
+
+#include <cstdlib>
+#include <string>
+
+using namespace CPPBuffer;
+
+namespace {
+
+// a temporary file holding the bytes 0..size-1 (mod 256), removed again on destruction
+struct TemporaryFile
+{
+    explicit TemporaryFile(size_t size) {
+        char name[] = "/tmp/cpp_buffer_io_ring_XXXXXX";
+        fd = mkstemp(name);
+        path = name;
+        for(size_t i = 0; i < size; ++i) {
+            const uint8_t byte = static_cast<uint8_t>(i);
+            CHECK_TRUE(::write(fd, &byte, 1u) == 1);
+        }
+    }
+    ~TemporaryFile() {
+        close(fd);
+        unlink(path.c_str());
+    }
+
+    int fd;
+    std::string path;
+};
+
+}
+
+TEST_GROUP(IoRing) {};
+
+TEST(IoRing, readIntoBuffers)
+{
+    TemporaryFile file(3000);
+    IoRing ring(8u);
+
+    CHECK_TRUE(ring.read(file.fd, Buffer<uint8_t>(1024), 0u, 1u));
+    CHECK_TRUE(ring.read(file.fd, Buffer<uint8_t>(1024), 2048u, 2u));
+    CHECK_TRUE(ring.in_flight() == 2u);
+
+    IoRing::Completion done[4];
+    size_t n = ring.wait(done, 4u, 2u);
+    CHECK_TRUE(n == 2u);
+    CHECK_TRUE(ring.in_flight() == 0u);
+
+    for(size_t i = 0; i < n; ++i) {
+        CHECK_TRUE(done[i].ok());
+        CHECK_FALSE(done[i].fixed);
+        const size_t offset = done[i].tag == 1u ? 0u : 2048u;
+        // the second read runs into the end of the file, and hands back only what it got
+        CHECK_TRUE(done[i].data.size() == (done[i].tag == 1u ? 1024u : 952u));
+        CHECK_TRUE(done[i].data.size() == size_t(done[i].result));
+        for(size_t j = 0; j < done[i].data.size(); ++j)
+            CHECK_TRUE(done[i].data[j] == static_cast<uint8_t>(offset + j));
+    }
+}
+
+TEST(IoRing, fixedBuffersFromPool)
+{
+    TemporaryFile file(4096);
+    BufferPool pool;
+    pool.reserve<uint8_t>(512u, 4u);
+
+    IoRing ring(8u);
+    ring.register_buffers(pool);
+
+    Buffer<uint8_t> buffer(512u, pool, uninitialized);
+    CHECK_TRUE(ring.read(file.fd, buffer.slice(0u, 256u), 256u, 7u));
+
+    IoRing::Completion done;
+    CHECK_TRUE(ring.wait(&done, 1u) == 1u);
+    CHECK_TRUE(done.ok());
+    CHECK_TRUE(done.fixed);
+    CHECK_TRUE(done.tag == 7u);
+    CHECK_TRUE(done.data.begin() == buffer.begin());
+    CHECK_TRUE(done.data.size() == 256u);
+    CHECK_TRUE(buffer[0] == 0u && buffer[255] == 255u);
+
+    // memory from outside the pool takes the regular path
+    CHECK_TRUE(ring.read(file.fd, Buffer<uint8_t>(64u), 0u));
+    CHECK_TRUE(ring.wait(&done, 1u) == 1u);
+    CHECK_TRUE(done.ok());
+    CHECK_FALSE(done.fixed);
+}
+
+TEST(IoRing, writeThenRead)
+{
+    TemporaryFile file(0u);
+    BufferPool pool;
+    pool.reserve<uint8_t>(128u, 2u);
+
+    IoRing ring(4u);
+    ring.register_buffers(pool);
+
+    Buffer<uint8_t> out(128u, pool);
+    for(size_t i = 0; i < out.size(); ++i)
+        out[i] = static_cast<uint8_t>(255u - i);
+    CHECK_TRUE(ring.write(file.fd, out, 0u));
+
+    IoRing::Completion done;
+    CHECK_TRUE(ring.wait(&done, 1u) == 1u);
+    CHECK_TRUE(done.ok());
+    CHECK_TRUE(done.fixed);
+    CHECK_TRUE(done.data.size() == 128u);
+
+    Buffer<uint8_t> in(128u);
+    CHECK_TRUE(ring.read(file.fd, in, 0u));
+    CHECK_TRUE(ring.wait(&done, 1u) == 1u);
+    CHECK_TRUE(done.result == 128);
+    for(size_t i = 0; i < in.size(); ++i)
+        CHECK_TRUE(in[i] == out[i]);
+}
+
+TEST(IoRing, fullRingRefuses)
+{
+    TemporaryFile file(64u);
+    IoRing ring(2u);
+
+    size_t queued = 0u;
+    while(ring.read(file.fd, Buffer<uint8_t>(8u), 0u))
+        ++queued;
+    CHECK_TRUE(queued >= 2u);
+
+    IoRing::Completion done[8];
+    size_t reaped = 0u;
+    while(ring.in_flight() > 0u)
+        reaped += ring.wait(done + reaped, 8u - reaped);
+    CHECK_TRUE(reaped == queued);
+    CHECK_TRUE(ring.read(file.fd, Buffer<uint8_t>(8u), 0u));
+}
+
+TEST(IoRing, failuresReportErrno)
+{
+    IoRing ring(2u);
+    CHECK_TRUE(ring.read(-1, Buffer<uint8_t>(8u), 0u));
+
+    IoRing::Completion done;
+    CHECK_TRUE(ring.wait(&done, 1u) == 1u);
+    CHECK_FALSE(done.ok());
+    CHECK_TRUE(done.result == -EBADF);
+    CHECK_TRUE(done.data.size() == 0u);
+}
+
+TEST(IoRing, oversizedOperationsThrow)
+{
+    // never touched: the size is refused before anything is queued
+    uint8_t byte = 0u;
+    Buffer<uint8_t> huge(std::shared_ptr<uint8_t>(&byte, [](uint8_t *) {}), (size_t(1) << 32) + 1u);
+
+    IoRing ring(2u);
+    CHECK_THROWS(std::invalid_argument, ring.read(-1, huge, 0u));
+    CHECK_THROWS(std::invalid_argument, ring.write(-1, huge, 0u));
+    CHECK_TRUE(ring.in_flight() == 0u);
+    CHECK_TRUE(huge.use_count() == 1);
+}
+
+TEST(IoRing, destructionDrainsQueuedOperations)
+{
+    TemporaryFile file(64u);
+    Buffer<uint8_t> target(16u);
+    {
+        IoRing ring(4u);
+        CHECK_TRUE(ring.read(file.fd, target, 0u));
+        ring.submit();
+        CHECK_TRUE(ring.read(file.fd, target, 16u)); // never submitted
+        CHECK_TRUE(target.use_count() == 3);
+    }
+    CHECK_TRUE(target.use_count() == 1);
+    CHECK_TRUE(target[15] == 31);
+}
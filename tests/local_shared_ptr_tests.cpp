@@ -0,0 +1,101 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/buffer.h>
+#include <cpp_buffer/buffer_pool.h>
+#include <cpp_buffer/local_shared_ptr.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <new>
+#include <numeric>
+
+using namespace CPPBuffer;
+
+namespace {
+
+struct Tracked
+{
+    Tracked() { ++alive; }
+    ~Tracked() { --alive; }
+    static int alive;
+};
+int Tracked::alive = 0;
+
+}
+
+static_assert(sizeof(Buffer<float, 1u, intrusive_array_ptr<float>>) == sizeof(Buffer<float, 1u, float *>),
+    "an intrusive Buffer is a pointer plus a size");
+
+TEST_GROUP(LocalSharedPtr) {};
+
+TEST(LocalSharedPtr, counts)
+{
+    Buffer<int, 1u, local_shared_ptr<int>> buffer(10);
+    CHECK_TRUE(std::all_of(buffer.begin(), buffer.end(), [](int i) { return i == 0; }));
+
+    auto copy = buffer;
+    auto slice = buffer.slice<2>();
+    std::iota(copy.begin(), copy.end(), 0);
+    CHECK_TRUE(buffer[9] == 9 && slice[1] == 2);
+}
+
+TEST(LocalSharedPtr, aliasing)
+{
+    auto owner = PointerAllocation<local_shared_ptr<int>>::make(4, alignof(int), NewDeleteResource::instance());
+    local_shared_ptr<int> second(owner, owner.get() + 1);
+    CHECK_TRUE(owner.use_count() == 2);
+    owner.reset();
+    CHECK_TRUE(second.use_count() == 1);
+    CHECK_TRUE(*second == 0);
+}
+
+TEST(LocalSharedPtr, destroysOnce)
+{
+    {
+        Buffer<Tracked, 1u, local_shared_ptr<Tracked>> a(3);
+        Buffer<Tracked, 1u, intrusive_array_ptr<Tracked>> b(4);
+        CHECK_TRUE(Tracked::alive == 7);
+        auto a2 = a;
+        auto b2 = b;
+        a = Buffer<Tracked, 1u, local_shared_ptr<Tracked>>();
+        CHECK_TRUE(Tracked::alive == 7);
+    }
+    CHECK_TRUE(Tracked::alive == 0);
+}
+
+TEST(LocalSharedPtr, intrusive)
+{
+    Buffer<double, 1u, intrusive_array_ptr<double>> buffer(16, cache_line_aligned);
+    CHECK_TRUE(buffer.alignment() >= 64);
+
+    intrusive_array_ptr<double> p = PointerAllocation<intrusive_array_ptr<double>>::make(
+        2, alignof(double), NewDeleteResource::instance());
+    CHECK_TRUE(p.use_count() == 1);
+    {
+        auto q = p;
+        CHECK_TRUE(p.use_count() == 2);
+    }
+    CHECK_TRUE(p.use_count() == 1);
+}
+
+TEST(LocalSharedPtr, tooManyElementsThrow)
+{
+    typedef Buffer<uint64_t, 1u, local_shared_ptr<uint64_t>> Local;
+    typedef Buffer<uint64_t, 1u, intrusive_array_ptr<uint64_t>> Intrusive;
+    CHECK_THROWS(std::bad_array_new_length, Local(SIZE_MAX / 8u + 2u));
+    CHECK_THROWS(std::bad_array_new_length, Intrusive(SIZE_MAX / 8u, uninitialized));
+
+    BufferPool pool;
+    CHECK_THROWS(std::bad_array_new_length, Intrusive(SIZE_MAX / 8u - 1u, pool));
+    CHECK_TRUE(pool.outstanding() == 0);
+}
+
+TEST(LocalSharedPtr, fromPool)
+{
+    BufferPool pool;
+    {
+        Buffer<float, 1u, intrusive_array_ptr<float>> buffer(100, pool, uninitialized);
+        auto copy = buffer;
+        CHECK_TRUE(pool.outstanding() == 1);
+    }
+    CHECK_TRUE(pool.outstanding() == 0);
+}
@@ -2,6 +2,12 @@
 #include <CppUTest/TestHarness.h>
 #include <cpp_buffer/buffer.h>
 
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <numeric>
+
 using namespace CPPBuffer;
 
 TEST_GROUP(BufferConstructors) {};
@@ -22,6 +28,232 @@ TEST(BufferConstructors, copies)
     CHECK_TRUE(size_of(buffer) == sizeof(int[10]));
 }
 
+namespace {
+
+// counts the allocations made through it, and checks they come back with the same size and alignment
+struct CountingResource
+{
+    void *allocate(size_t bytes, size_t alignment) {
+        ++allocations;
+        lastBytes = bytes;
+        lastAlignment = alignment;
+        return NewDeleteResource::instance().allocate(bytes, alignment);
+    }
+
+    void deallocate(void *p, size_t bytes, size_t alignment) {
+        ++deallocations;
+        CHECK_TRUE(bytes == lastBytes && alignment == lastAlignment);
+        NewDeleteResource::instance().deallocate(p, bytes, alignment);
+    }
+
+    int allocations = 0;
+    int deallocations = 0;
+    size_t lastBytes = 0;
+    size_t lastAlignment = 0;
+};
+
+struct Counted
+{
+    Counted() { ++alive; }
+    ~Counted() { --alive; }
+    static int alive;
+};
+int Counted::alive = 0;
+
+}
+
+TEST(BufferConstructors, valueInitialized)
+{
+    Buffer<int> buffer(64);
+    CHECK_TRUE(std::all_of(buffer.begin(), buffer.end(), [](int i) { return i == 0; }));
+}
+
+TEST(BufferConstructors, uninitialized)
+{
+    Buffer<float> buffer(16, uninitialized);
+    CHECK_TRUE(buffer.size() == 16);
+    std::fill(buffer.begin(), buffer.end(), 1.0f);
+    CHECK_TRUE(std::accumulate(buffer.begin(), buffer.end(), 0.0f) == 16.0f);
+}
+
+TEST(BufferConstructors, singleAllocation)
+{
+    CountingResource resource;
+    {
+        auto memory = make_shared_array<double>(100, alignof(double), resource);
+        Buffer<double> buffer(memory, 100);
+        CHECK_TRUE(resource.allocations == 1);
+        CHECK_TRUE(resource.lastBytes >= 100 * sizeof(double));
+        CHECK_TRUE(reinterpret_cast<uintptr_t>(buffer.begin()) % alignof(double) == 0);
+
+        auto copy = buffer;
+        CHECK_TRUE(resource.allocations == 1);
+    }
+    CHECK_TRUE(resource.deallocations == 1);
+}
+
+TEST(BufferConstructors, tooManyElementsThrow)
+{
+    // sizes whose bytes don't fit into a size_t throw, like new T[n], instead of wrapping around to a small block
+    CHECK_THROWS(std::bad_array_new_length, Buffer<uint64_t>(SIZE_MAX / 8u + 2u));
+    CHECK_THROWS(std::bad_array_new_length, Buffer<uint64_t>(SIZE_MAX / 8u, uninitialized));
+    CHECK_THROWS(std::bad_array_new_length, Buffer<float>(SIZE_MAX / 4u - 1u, page_aligned));
+
+    CountingResource resource;
+    CHECK_THROWS(std::bad_array_new_length, make_shared_array<double>(SIZE_MAX / 8u, alignof(double), resource));
+    CHECK_TRUE(resource.allocations == 0);
+    std::allocator<double> standard;
+    CHECK_THROWS(std::bad_array_new_length, make_allocated_array<double>(SIZE_MAX / 4u, standard));
+}
+
+TEST(BufferConstructors, destroysElements)
+{
+    {
+        Buffer<Counted> buffer(5);
+        CHECK_TRUE(Counted::alive == 5);
+        auto copy = buffer;
+        CHECK_TRUE(Counted::alive == 5);
+    }
+    CHECK_TRUE(Counted::alive == 0);
+}
+
+TEST(BufferConstructors, aligned)
+{
+    Buffer<float> lines(100, cache_line_aligned);
+    CHECK_TRUE(lines.alignment() >= 64);
+    CHECK_TRUE(lines.aligned_begin<64>() == lines.begin());
+    // the alignment is checked before the compiler gets to assume it
+    Buffer<float, 1u, float *> offset(lines.begin() + 1, 10);
+    CHECK_THROWS(OutOfRangeError, offset.aligned_begin<64>());
+    const auto &constOffset = offset;
+    CHECK_THROWS(OutOfRangeError, constOffset.aligned_begin<16>());
+    CHECK_TRUE(std::all_of(lines.begin(), lines.end(), [](float f) { return f == 0.0f; }));
+
+    Buffer<char> page(10, page_aligned, uninitialized);
+    CHECK_TRUE(page.alignment() >= 4096);
+
+    CountingResource resource;
+    {
+        Buffer<double> buffer(3, resource, std::align_val_t(256));
+        CHECK_TRUE(buffer.alignment() >= 256);
+        CHECK_TRUE(resource.lastAlignment == 256);
+    }
+    CHECK_TRUE(resource.deallocations == 1);
+
+    CHECK_TRUE(Buffer<int>().alignment() == 0);
+}
+
+TEST(BufferConstructors, barePointer)
+{
+    int memory[4] = {1, 2, 3, 4};
+    Buffer<int, 1u, int *> buffer(memory, 4);
+    CHECK_TRUE(buffer.size() == 4);
+    CHECK_TRUE(buffer.begin() == memory);
+    CHECK_TRUE(std::accumulate(buffer.begin(), buffer.end(), 0) == 10);
+
+    auto copy = buffer;
+    copy[0] = 5;
+    CHECK_TRUE(memory[0] == 5);
+
+    auto odds = buffer.slice<2>(1, 4);
+    CHECK_TRUE(odds.size() == 2 && odds[0] == 2 && odds[1] == 4);
+}
+
+TEST_GROUP(Slice) {};
+
+TEST(Slice, unitStride)
+{
+    Buffer<int> buffer(10);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    auto slice = buffer.slice(2, 4);
+    CHECK_TRUE(slice.size() == 2);
+    CHECK_TRUE(slice[0] == 2);
+    CHECK_TRUE(slice[1] == 3);
+    CHECK_TRUE(slice.begin() == &buffer[2]);
+    CHECK_TRUE(std::accumulate(slice.begin(), slice.end(), 0) == 5);
+}
+
+TEST(Slice, strides)
+{
+    Buffer<int> buffer(10);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    auto evens = buffer.slice<2>();
+    CHECK_TRUE(evens.size() == 5);
+    CHECK_TRUE(std::accumulate(evens.begin(), evens.end(), 0) == 0 + 2 + 4 + 6 + 8);
+
+    auto odds = buffer.slice<2>(1, buffer.size());
+    CHECK_TRUE(odds.size() == 5);
+    CHECK_TRUE(odds[4] == 9);
+
+    auto thirds = buffer.slice<3>(2, 10);
+    CHECK_TRUE(thirds.size() == 3);
+    CHECK_TRUE(thirds[0] == 2 && thirds[1] == 5 && thirds[2] == 8);
+    CHECK_TRUE(thirds.end() - thirds.begin() == 3);
+    CHECK_TRUE(size_of(thirds) == 3 * sizeof(int));
+}
+
+TEST(Slice, writesThrough)
+{
+    Buffer<int> buffer(6);
+    std::fill(buffer.begin(), buffer.end(), 0);
+
+    auto odds = buffer.slice<2>(1, 6);
+    std::fill(odds.begin(), odds.end(), 7);
+    CHECK_TRUE(buffer[0] == 0 && buffer[1] == 7 && buffer[4] == 0 && buffer[5] == 7);
+}
+
+TEST(Slice, randomAccess)
+{
+    Buffer<int> buffer(8);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    auto slice = buffer.slice<2>();
+    std::reverse(slice.begin(), slice.end());
+    CHECK_TRUE(buffer[0] == 6 && buffer[2] == 4 && buffer[4] == 2 && buffer[6] == 0);
+    CHECK_TRUE(buffer[1] == 1);
+
+    std::sort(slice.begin(), slice.end());
+    CHECK_TRUE(std::is_sorted(slice.begin(), slice.end()));
+    CHECK_TRUE(*(slice.begin() + 3) == 6);
+    CHECK_TRUE(slice.begin()[2] == 4);
+}
+
+TEST(Slice, sliceOfSlice)
+{
+    Buffer<int> buffer(20);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    auto evens = buffer.slice<2>();
+    auto everyFourth = evens.slice<2>(1, evens.size());
+    CHECK_TRUE(everyFourth.size() == 5);
+    CHECK_TRUE(everyFourth[0] == 2 && everyFourth[1] == 6 && everyFourth[4] == 18);
+
+    auto inner = evens.slice(2, 4);
+    CHECK_TRUE(inner.size() == 2);
+    CHECK_TRUE(inner[0] == 4 && inner[1] == 6);
+}
+
+TEST(Slice, sharesOwnership)
+{
+    Slice<int, 2u> slice;
+    {
+        Buffer<int> buffer(4);
+        std::iota(buffer.begin(), buffer.end(), 1);
+        slice = buffer.slice<2>();
+    }
+    CHECK_TRUE(slice[0] == 1 && slice[1] == 3);
+}
+
+TEST(Slice, emptyInterval)
+{
+    Buffer<int> buffer(4);
+    auto slice = buffer.slice<3>(2, 2);
+    CHECK_TRUE(slice.size() == 0);
+    CHECK_TRUE(slice.begin() == slice.end());
+}
+
 int main(int argc, char** argv)
 {
     return CommandLineTestRunner::RunAllTests(argc, argv);
@@ -0,0 +1,81 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/mapped_buffer.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <numeric>
+#include <string>
+#include <system_error>
+
+using namespace CPPBuffer;
+
+namespace {
+
+// a temporary file holding the int16_t values 0..count-1, removed again on destruction
+struct TemporaryFile
+{
+    explicit TemporaryFile(int count) {
+        char name[] = "/tmp/cpp_buffer_mapped_XXXXXX";
+        fd = mkstemp(name);
+        path = name;
+        for(int16_t i = 0; i < count; ++i)
+            CHECK_TRUE(write(fd, &i, sizeof(i)) == sizeof(i));
+    }
+    ~TemporaryFile() {
+        close(fd);
+        unlink(path.c_str());
+    }
+
+    int fd;
+    std::string path;
+};
+
+}
+
+TEST_GROUP(MappedBuffer) {};
+
+TEST(MappedBuffer, readOnly)
+{
+    TemporaryFile file(5000);
+    Buffer<const int16_t> samples = MappedBuffer::open<const int16_t>(file.path.c_str());
+    CHECK_TRUE(samples.size() == 5000);
+    CHECK_TRUE(samples[0] == 0 && samples[4999] == 4999);
+    CHECK_TRUE(std::accumulate(samples.begin(), samples.end(), 0) == 4999 * 5000 / 2);
+    CHECK_TRUE(samples.alignment() >= MappedBuffer::page_size());
+
+    CHECK_TRUE(MappedBuffer::advise(samples, Advice::sequential));
+    CHECK_TRUE(MappedBuffer::advise(samples, Advice::will_need));
+}
+
+TEST(MappedBuffer, copyOnWrite)
+{
+    TemporaryFile file(100);
+    {
+        Buffer<int16_t> samples = MappedBuffer::open<int16_t>(file.path.c_str());
+        samples[10] = -1;
+        CHECK_TRUE(samples[10] == -1);
+    }
+    Buffer<const int16_t> again = MappedBuffer::open<const int16_t>(file.path.c_str());
+    CHECK_TRUE(again[10] == 10);
+}
+
+TEST(MappedBuffer, offsets)
+{
+    TemporaryFile file(5000);
+    // starts in the middle of the first page, and only maps a few elements
+    Buffer<const int16_t> window = MappedBuffer::open<const int16_t>(file.fd, 2 * 1500, 20);
+    CHECK_TRUE(window.size() == 20);
+    CHECK_TRUE(window[0] == 1500 && window[19] == 1519);
+
+    auto everyOther = window.slice<2>();
+    CHECK_TRUE(everyOther[1] == 1502);
+    CHECK_TRUE(MappedBuffer::advise(everyOther, Advice::random));
+
+    // past the end of the file is just empty
+    CHECK_TRUE(MappedBuffer::open<const int16_t>(file.fd, 100000).size() == 0);
+}
+
+TEST(MappedBuffer, missingFile)
+{
+    CHECK_THROWS(std::system_error, MappedBuffer::open<const char>("/nonexistent/cpp_buffer"));
+}
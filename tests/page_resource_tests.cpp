@@ -0,0 +1,89 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/page_resource.h>
+
+#include <algorithm>
+#include <new>
+#include <numeric>
+
+using namespace CPPBuffer;
+
+namespace {
+
+// the lowest node this process may allocate from
+int first_node() {
+    const unsigned long nodes = numa_nodes();
+    int node = 0;
+    while(!(nodes & (1ul << node)))
+        ++node;
+    return node;
+}
+
+}
+
+TEST_GROUP(PageResource) {};
+
+TEST(PageResource, standardPages)
+{
+    PageResource resource(PageSize::standard);
+    Buffer<int> buffer(10000, resource);
+    CHECK_TRUE(buffer.size() == 10000u);
+    CHECK_TRUE(*std::max_element(buffer.begin(), buffer.end()) == 0);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    CHECK_TRUE(buffer[9999] == 9999);
+
+    Buffer<int> copy = buffer;
+    buffer = Buffer<int>();
+    CHECK_TRUE(copy[1234] == 1234); // the mapping lives as long as the last copy
+}
+
+TEST(PageResource, transparentHugePagesAreAligned)
+{
+    PageResource resource(PageSize::transparent_huge);
+    void *memory = resource.allocate(size_t(8u) << 20, 64u);
+    CHECK_TRUE(reinterpret_cast<uintptr_t>(memory) % (size_t(2u) << 20) == 0u);
+    static_cast<char *>(memory)[(size_t(8u) << 20) - 1u] = 1;
+    resource.deallocate(memory, size_t(8u) << 20, 64u);
+
+    Buffer<float> samples(1u << 20, resource, uninitialized);
+    samples[0] = 1.0f;
+    samples[(1u << 20) - 1u] = 2.0f;
+}
+
+TEST(PageResource, explicitHugePagesNeedAReservation)
+{
+    // only works where /proc/sys/vm/nr_hugepages reserves some, and has to fail cleanly everywhere else
+    PageResource resource(PageSize::huge_2m);
+    try {
+        Buffer<char> buffer(100u, resource);
+        CHECK_TRUE(buffer.alignment() >= 16u);
+        buffer[99] = 'x';
+    } catch(const std::bad_alloc &) {
+    }
+}
+
+TEST(PageResource, bindsToANode)
+{
+    const int node = first_node();
+    PageResource resource(PageSize::standard, NumaPolicy::bind, 1ul << node);
+    Buffer<int> buffer(100000, resource);
+    CHECK_TRUE(numa_node_of(buffer) == node);
+    CHECK_TRUE(numa_node_of(buffer.slice(90000, 100000)) == node);
+
+    PageResource interleaved(PageSize::standard, NumaPolicy::interleave);
+    CHECK_TRUE(interleaved.nodes() == numa_nodes());
+    Buffer<int> spread(100000, interleaved);
+    CHECK_TRUE(numa_node_of(spread) >= 0);
+}
+
+TEST(PageResource, firstTouchInParallel)
+{
+    PageResource resource(PageSize::standard);
+    Buffer<double> buffer(1u << 18, resource, uninitialized);
+    const double *last = &buffer[(1 << 18) - 1];
+    CHECK_TRUE(numa_node_of(last) == -1); // nothing has written that page yet
+
+    ThreadPool pool(2);
+    parallel_first_touch(pool, buffer, 4096);
+    CHECK_TRUE(numa_node_of(last) >= 0);
+    CHECK_TRUE(sum(buffer) == 0.0);
+}
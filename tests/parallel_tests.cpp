@@ -0,0 +1,122 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/parallel.h>
+
+#include <atomic>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(Parallel) {};
+
+TEST(Parallel, forCoversEveryElementOnce)
+{
+    ThreadPool pool(3);
+    Buffer<int> buffer(100000, cache_line_aligned);
+    parallel_for(pool, buffer, 1000, [](Slice<int> chunk) {
+        for(int &value : chunk)
+            value += 1;
+    });
+    CHECK_TRUE(std::all_of(buffer.begin(), buffer.end(), [](int value) { return value == 1; }));
+}
+
+TEST(Parallel, chunkEdgesOnCacheLines)
+{
+    ThreadPool pool(2);
+    Buffer<float> buffer(10000);
+    // start a few elements into a line, so the first chunk has to absorb the misalignment
+    auto view = buffer.slice(3, buffer.size());
+
+    std::mutex mutex;
+    std::vector<std::pair<const float *, size_t>> chunks;
+    parallel_for(pool, view, 100, [&](Slice<float> chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.emplace_back(chunk.begin(), chunk.size());
+    });
+
+    std::sort(chunks.begin(), chunks.end());
+    CHECK_TRUE(chunks.front().first == view.begin());
+    size_t total = 0u;
+    for(size_t i = 0; i < chunks.size(); ++i) {
+        total += chunks[i].second;
+        if(i > 0u) {
+            CHECK_TRUE(reinterpret_cast<uintptr_t>(chunks[i].first) % 64u == 0u);
+            CHECK_TRUE(chunks[i].first == chunks[i - 1u].first + chunks[i - 1u].second);
+        }
+        if(i + 1u < chunks.size())
+            CHECK_TRUE(chunks[i].second >= 100u);
+    }
+    CHECK_TRUE(total == view.size());
+}
+
+TEST(Parallel, stridedSlices)
+{
+    ThreadPool pool(2);
+    Buffer<int> buffer(9000);
+    auto third = buffer.slice<3>(1, buffer.size());
+    parallel_for(pool, third, 64, [](Slice<int, 3u> chunk) {
+        for(int &value : chunk)
+            value = 7;
+    });
+    for(size_t i = 0; i < buffer.size(); ++i)
+        CHECK_TRUE(buffer[int(i)] == (i % 3u == 1u ? 7 : 0));
+}
+
+TEST(Parallel, reduceIsDeterministic)
+{
+    ThreadPool pool(3);
+    Buffer<double> buffer(50000);
+    std::iota(buffer.begin(), buffer.end(), 0.0);
+
+    auto reduce = [&]() {
+        return parallel_reduce(pool, buffer, 512, 0.0,
+            [](Slice<double> chunk) { return sum(chunk); },
+            [](double a, double b) { return a + b; });
+    };
+    const double expected = 49999.0 * 50000.0 / 2.0;
+    const double first = reduce();
+    DOUBLES_EQUAL(expected, first, 1e-3);
+    for(int i = 0; i < 5; ++i)
+        CHECK_TRUE(reduce() == first);
+}
+
+TEST(Parallel, sharedPoolAndNesting)
+{
+    Buffer<int> outer(64);
+    std::atomic<int> calls{0};
+    parallel_for(outer, 8, [&](Slice<int> chunk) {
+        Buffer<int> inner(1000);
+        const int total = parallel_reduce(inner, 100, 0, [](Slice<int> c) { return int(c.size()); },
+            [](int a, int b) { return a + b; });
+        for(int &value : chunk)
+            value = total;
+        ++calls;
+    });
+    CHECK_TRUE(calls.load() == int(detail::partition(outer, 8).count()));
+    CHECK_TRUE(std::all_of(outer.begin(), outer.end(), [](int value) { return value == 1000; }));
+}
+
+TEST(Parallel, exceptionsPropagate)
+{
+    ThreadPool pool(2);
+    Buffer<int> buffer(1000);
+    std::atomic<int> chunks{0};
+    CHECK_THROWS(std::runtime_error, parallel_for(pool, buffer, 16, [&](Slice<int> chunk) {
+        ++chunks;
+        if(chunk.begin() == buffer.begin())
+            throw std::runtime_error("first chunk");
+    }));
+    CHECK_TRUE(chunks.load() == int(detail::partition(buffer, 16).count()));
+}
+
+TEST(Parallel, empty)
+{
+    ThreadPool pool(1);
+    Buffer<int> buffer;
+    int calls = 0;
+    parallel_for(pool, buffer, 16, [&](Slice<int>) { ++calls; });
+    CHECK_TRUE(calls == 0);
+    CHECK_TRUE(parallel_reduce(pool, buffer, 16, 5, [](Slice<int>) { return 1; }, [](int a, int b) { return a + b; }) == 5);
+}
@@ -0,0 +1,167 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/pipeline.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+
+using namespace CPPBuffer;
+
+namespace {
+
+const size_t block_count = 200u;
+const size_t block_size = 256u;
+
+// read -> decode -> filter -> write, where the filter drops every tenth block and the writer checks the order
+struct Chain
+{
+    size_t read = 0u;
+    size_t written = 0u;
+    bool inOrder = true;
+    double total = 0.0;
+
+    void build(Pipeline &pipeline) {
+        auto raw = pipeline.source<uint8_t>([this](Blocks<uint8_t> &blocks) -> std::optional<Buffer<uint8_t>> {
+            if(read == block_count)
+                return std::nullopt;
+            Buffer<uint8_t> block = blocks.allocate(block_size, uninitialized);
+            std::fill(block.begin(), block.end(), static_cast<uint8_t>(read++ % 256u));
+            return block;
+        });
+        auto samples = pipeline.stage<float>(raw, [](Buffer<uint8_t> block, Blocks<float> &blocks) {
+            Buffer<float> decoded = blocks.allocate(block.size() + 1u, uninitialized);
+            std::copy(block.begin(), block.end(), decoded.begin());
+            decoded[static_cast<int>(block.size())] = 0.0f;
+            return std::optional<Buffer<float>>(decoded);
+        });
+        auto filtered = pipeline.stage<float>(samples, [](Buffer<float> block, Blocks<float> &) {
+            if(static_cast<size_t>(block[0]) % 10u == 9u)
+                return std::optional<Buffer<float>>();
+            for(float &value : block)
+                value *= 2.0f;
+            return std::optional<Buffer<float>>(std::move(block)); // in place
+        }, 3u);
+        pipeline.sink(filtered, [this](Buffer<float> block) {
+            const size_t expected = written + written / 9u;
+            inOrder = inOrder && static_cast<size_t>(block[0]) == 2u * (expected % 256u);
+            total += std::accumulate(block.begin(), block.end(), 0.0);
+            ++written;
+        });
+    }
+
+    void check() const {
+        CHECK_TRUE(read == block_count);
+        CHECK_TRUE(written == block_count - block_count / 10u);
+        CHECK_TRUE(inOrder);
+        double expected = 0.0;
+        for(size_t i = 0; i < block_count; ++i)
+            expected += i % 10u == 9u ? 0.0 : 2.0 * (i % 256u) * block_size;
+        DOUBLES_EQUAL(expected, total, 0.0);
+    }
+};
+
+}
+
+TEST_GROUP(Pipeline) {};
+
+TEST(Pipeline, threadPerStage)
+{
+    Pipeline pipeline;
+    Chain chain;
+    chain.build(pipeline);
+    CHECK_TRUE(pipeline.stages() == 4u);
+    pipeline.run();
+    chain.check();
+}
+
+TEST(Pipeline, sharedExecutor)
+{
+    ThreadPool pool(1);
+    Pipeline pipeline;
+    Chain chain;
+    chain.build(pipeline);
+    pipeline.run(pool); // four stages on two tasks
+    chain.check();
+
+    ThreadPool alone(0);
+    Pipeline single;
+    Chain serial;
+    serial.build(single);
+    single.run(alone); // everything on the calling thread
+    serial.check();
+}
+
+TEST(Pipeline, backpressureAndRecycling)
+{
+    std::atomic<size_t> produced{0u}, consumed{0u};
+    size_t mostInFlight = 0u, mostOutstanding = 0u;
+
+    Pipeline pipeline;
+    auto blocks = pipeline.source<int>([&](Blocks<int> &pool) -> std::optional<Buffer<int>> {
+        if(produced == 50u)
+            return std::nullopt;
+        mostInFlight = std::max(mostInFlight, produced - consumed);
+        mostOutstanding = std::max(mostOutstanding, pool.outstanding());
+        ++produced;
+        return pool.allocate(1000u);
+    }, 2u);
+    pipeline.sink(blocks, [&](Buffer<int>) {
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        ++consumed;
+    });
+    pipeline.run();
+
+    CHECK_TRUE(consumed == 50u);
+    // two waiting in the ring and one in the sink, however far ahead the source would like to be
+    CHECK_TRUE(mostInFlight <= 3u);
+    CHECK_TRUE(mostOutstanding <= 3u);
+}
+
+TEST(Pipeline, errorsStopThePipeline)
+{
+    Pipeline pipeline;
+    auto endless = pipeline.source<int>([](Blocks<int> &blocks) -> std::optional<Buffer<int>> {
+        return blocks.allocate(4u);
+    });
+    size_t seen = 0u;
+    pipeline.sink(endless, [&seen](Buffer<int>) {
+        if(++seen == 10u)
+            throw std::runtime_error("write failed");
+    });
+    CHECK_THROWS(std::runtime_error, pipeline.run());
+    CHECK_TRUE(seen == 10u);
+}
+
+TEST(Pipeline, everyOutputNeedsOneInput)
+{
+    auto source = [](Blocks<int> &) { return std::optional<Buffer<int>>(); };
+
+    Pipeline dangling;
+    dangling.source<int>(source);
+    CHECK_THROWS(std::invalid_argument, dangling.run());
+
+    Pipeline twice;
+    auto port = twice.source<int>(source);
+    twice.sink(port, [](Buffer<int>) {});
+    CHECK_THROWS(std::invalid_argument, twice.sink(port, [](Buffer<int>) {}));
+    CHECK_THROWS(std::invalid_argument, twice.source<int>(source, 0u));
+}
+
+TEST(Pipeline, runsOnce)
+{
+    Pipeline pipeline;
+    Chain chain;
+    chain.build(pipeline);
+    pipeline.run();
+    chain.check();
+
+    ThreadPool pool(1);
+    CHECK_THROWS(std::logic_error, pipeline.run());
+    CHECK_THROWS(std::logic_error, pipeline.run(pool));
+    chain.check();
+}
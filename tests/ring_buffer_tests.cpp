@@ -0,0 +1,136 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/ring_buffer.h>
+
+#include <numeric>
+#include <thread>
+#include <vector>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(RingBuffer) {};
+
+TEST(RingBuffer, capacity)
+{
+    RingBuffer<int> ring(100);
+    CHECK_TRUE(ring.capacity() == 128);
+    CHECK_TRUE(ring.empty());
+
+    RingBuffer<int> exact(Buffer<int>(16));
+    CHECK_TRUE(exact.capacity() == 16);
+}
+
+TEST(RingBuffer, pushPop)
+{
+    RingBuffer<int> ring(4);
+    CHECK_TRUE(ring.try_push(1));
+    CHECK_TRUE(ring.try_push(2));
+    CHECK_TRUE(ring.try_push(3));
+    CHECK_TRUE(ring.try_push(4));
+    CHECK_FALSE(ring.try_push(5));
+    CHECK_TRUE(ring.size() == 4);
+
+    int value = 0;
+    CHECK_TRUE(ring.try_pop(value) && value == 1);
+    CHECK_TRUE(ring.try_push(5));
+    for(int expected = 2; expected <= 5; ++expected)
+        CHECK_TRUE(ring.try_pop(value) && value == expected);
+    CHECK_FALSE(ring.try_pop(value));
+}
+
+TEST(RingBuffer, batches)
+{
+    RingBuffer<int> ring(8);
+    int in[10];
+    std::iota(in, in + 10, 0);
+
+    CHECK_TRUE(ring.push(in, 6) == 6);
+    int out[10] = {};
+    CHECK_TRUE(ring.pop(out, 4) == 4);
+    CHECK_TRUE(out[0] == 0 && out[3] == 3);
+
+    // 4 and 5 are still in the ring, so only 6 of these fit, and they wrap around the end
+    CHECK_TRUE(ring.push(in, 8) == 6);
+    Buffer<int> drained(10);
+    CHECK_TRUE(ring.pop(drained) == 8);
+    CHECK_TRUE(drained[0] == 4 && drained[1] == 5);
+    for(int i = 2; i < 8; ++i)
+        CHECK_TRUE(drained[i] == i - 2);
+}
+
+TEST(RingBuffer, regionsWrapAround)
+{
+    RingBuffer<int> ring(8);
+    int in[6] = {0, 1, 2, 3, 4, 5};
+    ring.push(in, 6);
+    int out[6];
+    ring.pop(out, 6);
+
+    // the write position is now 6, so the free space is 2 elements at the end and 6 at the front
+    auto regions = ring.write_regions();
+    CHECK_TRUE(regions.first.size() == 2);
+    CHECK_TRUE(regions.second.size() == 6);
+    std::iota(regions.first.begin(), regions.first.end(), 10);
+    std::iota(regions.second.begin(), regions.second.begin() + 3, 12);
+    ring.commit_write(5);
+    CHECK_TRUE(ring.size() == 5);
+
+    auto readable = ring.read_regions();
+    CHECK_TRUE(readable.first.size() == 2 && readable.second.size() == 3);
+    CHECK_TRUE(readable.first[0] == 10 && readable.second[2] == 14);
+    ring.commit_read(readable.size());
+    CHECK_TRUE(ring.empty());
+}
+
+TEST(RingBuffer, overrunsThrow)
+{
+    RingBuffer<int> ring(8);
+    int in[3] = {0, 1, 2};
+    ring.push(in, 3);
+    CHECK_THROWS(OutOfRangeError, ring.commit_write(6));
+    CHECK_THROWS(OutOfRangeError, ring.commit_read(4));
+    CHECK_TRUE(ring.size() == 3);
+
+    CHECK_THROWS(OutOfRangeError, RingBuffer<int>(Buffer<int>(6)));
+    CHECK_THROWS(OutOfRangeError, RingBuffer<int>(Buffer<int>()));
+}
+
+TEST(RingBuffer, viewPush)
+{
+    RingBuffer<int> ring(16);
+    Buffer<int> source(10);
+    std::iota(source.begin(), source.end(), 0);
+    CHECK_TRUE(ring.push(source.slice<2>()) == 5);
+
+    int value = 0;
+    CHECK_TRUE(ring.try_pop(value) && value == 0);
+    CHECK_TRUE(ring.try_pop(value) && value == 2);
+}
+
+TEST(RingBuffer, threads)
+{
+    RingBuffer<unsigned> ring(1024);
+    const unsigned count = 200000;
+
+    std::thread producer([&ring]() {
+        unsigned next = 0;
+        unsigned batch[37];
+        while(next < count) {
+            unsigned n = 0;
+            for(; n < 37 && next + n < count; ++n)
+                batch[n] = next + n;
+            next += static_cast<unsigned>(ring.push(batch, n));
+        }
+    });
+
+    unsigned expected = 0;
+    bool ordered = true;
+    unsigned out[64];
+    while(expected < count) {
+        size_t n = ring.pop(out, 64);
+        for(size_t i = 0; i < n; ++i)
+            ordered = ordered && out[i] == expected++;
+    }
+    producer.join();
+    CHECK_TRUE(ordered);
+    CHECK_TRUE(ring.empty());
+}
@@ -0,0 +1,151 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/local_shared_ptr.h>
+#include <cpp_buffer/serialization.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+
+using namespace CPPBuffer;
+
+namespace {
+
+struct Point
+{
+    float x, y;
+};
+
+}
+
+TEST_GROUP(Serialization) {};
+
+TEST(Serialization, roundTripAliasesTheBytes)
+{
+    Buffer<float> samples(100);
+    std::iota(samples.begin(), samples.end(), 0.5f);
+
+    Buffer<uint8_t> frame = serialize(samples, 64u);
+    CHECK_TRUE(frame.size() == frame_size(samples, 64u));
+    CHECK_TRUE(frame.size() % 64u == 0u);
+
+    const FrameInfo info = read_frame(frame.begin(), frame.size());
+    CHECK_TRUE(info.type == ElementType::f32 && info.elementBytes == 4u);
+    CHECK_TRUE(info.count == 100u && info.native());
+    CHECK_TRUE(info.payloadOffset == 64u && info.frameBytes == frame.size());
+
+    Buffer<float> received = deserialize<float>(frame);
+    CHECK_TRUE(received.size() == 100u);
+    CHECK_TRUE(reinterpret_cast<uint8_t *>(received.begin()) == frame.begin() + info.payloadOffset);
+    CHECK_TRUE(std::equal(samples.begin(), samples.end(), received.begin()));
+    CHECK_TRUE(frame.use_count() == 2 && received.use_count() == 2); // one control block for the bytes and the floats
+
+    frame = Buffer<uint8_t>();
+    DOUBLES_EQUAL(99.5, received[99], 0.0); // the elements keep the bytes alive
+}
+
+TEST(Serialization, stridedAndMisalignedFramesAreCopied)
+{
+    Buffer<double> interleaved(20);
+    std::iota(interleaved.begin(), interleaved.end(), 0.0);
+    auto right = interleaved.slice<2>(1, interleaved.size());
+
+    // a frame one byte into a message, so the payload can't be aligned in place
+    const size_t bytes = frame_size(right);
+    Buffer<uint8_t> message(bytes + 1u);
+    CHECK_TRUE(serialize(right, message.begin() + 1u, bytes) == bytes);
+
+    Buffer<double> received = deserialize<double>(message, 1u);
+    CHECK_TRUE(received.size() == 10u);
+    CHECK_TRUE(reinterpret_cast<uint8_t *>(received.begin()) != message.begin() + 17u);
+    for(size_t i = 0; i < received.size(); ++i)
+        DOUBLES_EQUAL(2.0 * i + 1.0, received[i], 0.0);
+
+    // frames in Slices of a bigger byte buffer work the same
+    Buffer<uint8_t> aligned = serialize(right);
+    Buffer<double> fromSlice = deserialize<double>(aligned.slice(0, aligned.size()));
+    DOUBLES_EQUAL(19.0, fromSlice[9], 0.0);
+    CHECK_TRUE(fromSlice.use_count() == aligned.use_count());
+}
+
+TEST(Serialization, otherPointersKeepTheirBytesAlive)
+{
+    Buffer<float> samples(8);
+    std::iota(samples.begin(), samples.end(), 0.5f);
+    Buffer<uint8_t> frame = serialize(samples);
+    Buffer<uint8_t, 1u, local_shared_ptr<uint8_t>> local(frame.size(), std::align_val_t(64));
+    std::copy(frame.begin(), frame.end(), local.begin());
+
+    Buffer<float> received = deserialize<float>(local);
+    const size_t payloadOffset = read_frame(local.begin(), local.size()).payloadOffset;
+    CHECK_TRUE(reinterpret_cast<uint8_t *>(received.begin()) == local.begin() + payloadOffset);
+    CHECK_TRUE(local.use_count() == 2 && received.use_count() == 1);
+
+    local = Buffer<uint8_t, 1u, local_shared_ptr<uint8_t>>();
+    DOUBLES_EQUAL(7.5, received[7], 0.0);
+}
+
+TEST(Serialization, framesFromTheOtherByteOrderAreSwapped)
+{
+    Buffer<uint32_t> values(3);
+    values[0] = 0x01020304u;
+    values[1] = 0xa0b0c0d0u;
+    values[2] = 7u;
+    Buffer<uint8_t> frame = serialize(values);
+
+    // rewrite the frame as the other byte order would have sent it
+    frame[7] = static_cast<uint8_t>(frame[7] ^ 0x80u);
+    std::reverse(frame.begin() + 8, frame.begin() + 16);
+    for(size_t i = 16; i < 28; i += 4)
+        std::reverse(frame.begin() + i, frame.begin() + i + 4);
+
+    CHECK_FALSE(read_frame(frame.begin(), frame.size()).native());
+    Buffer<uint32_t> received = deserialize<uint32_t>(frame);
+    CHECK_TRUE(received.size() == 3u);
+    CHECK_TRUE(received[0] == 0x01020304u && received[1] == 0xa0b0c0d0u && received[2] == 7u);
+    CHECK_TRUE(reinterpret_cast<uint8_t *>(received.begin()) != frame.begin() + 16);
+}
+
+TEST(Serialization, opaqueElementsAndBackToBackFrames)
+{
+    Buffer<Point> points(2);
+    points[1].x = 3.0f;
+    points[1].y = -1.0f;
+    Buffer<int16_t> labels(5);
+    std::iota(labels.begin(), labels.end(), int16_t(-2));
+
+    const size_t first = frame_size(points, 16u);
+    Buffer<uint8_t> stream(first + frame_size(labels, 16u), std::align_val_t(16u));
+    serialize(points, stream.begin(), stream.size(), 16u);
+    serialize(labels, stream.begin() + first, stream.size() - first, 16u);
+
+    const FrameInfo info = read_frame(stream.begin(), stream.size());
+    CHECK_TRUE(info.type == ElementType::opaque && info.elementBytes == sizeof(Point));
+    CHECK_TRUE(info.frameBytes == first);
+
+    Buffer<Point> receivedPoints = deserialize<Point>(stream);
+    Buffer<int16_t> receivedLabels = deserialize<int16_t>(stream, info.frameBytes);
+    DOUBLES_EQUAL(-1.0, receivedPoints[1].y, 0.0);
+    CHECK_TRUE(receivedLabels.size() == 5u && receivedLabels[0] == -2 && receivedLabels[4] == 2);
+    CHECK_TRUE(reinterpret_cast<uint8_t *>(receivedLabels.begin()) == stream.begin() + first + 16u);
+}
+
+TEST(Serialization, malformedFramesThrow)
+{
+    Buffer<int32_t> values(10);
+    Buffer<uint8_t> frame = serialize(values);
+
+    CHECK_THROWS(FrameError, deserialize<float>(frame));      // another type
+    CHECK_THROWS(FrameError, deserialize<uint32_t>(frame));   // another signedness
+    CHECK_THROWS(FrameError, read_frame(frame.begin(), 8u));
+    CHECK_THROWS(FrameError, read_frame(frame.begin(), frame.size() - 8u)); // truncated payload
+
+    Buffer<uint8_t> corrupt = serialize(values);
+    corrupt[0] = 'X';
+    CHECK_THROWS(FrameError, deserialize<int32_t>(corrupt));
+    corrupt = serialize(values);
+    corrupt[12] = 0xffu; // a count bigger than the bytes
+    CHECK_THROWS(FrameError, deserialize<int32_t>(corrupt));
+
+    CHECK_TRUE(deserialize<int32_t>(frame).size() == 10u);
+}
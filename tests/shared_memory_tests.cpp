@@ -0,0 +1,189 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/shared_memory.h>
+
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(SharedMemory) {};
+
+TEST(SharedMemory, mappingsShareElements)
+{
+    SharedMemory memory = SharedMemory::create(1000 * sizeof(int));
+    CHECK_TRUE(memory.size() == 1000 * sizeof(int));
+
+    Buffer<int> writer = memory.map<int>();
+    Buffer<const int> reader = memory.map<const int>();
+    CHECK_TRUE(writer.size() == 1000u && reader.size() == 1000u);
+    CHECK_TRUE(reader[999] == 0); // zeroed to start with
+    CHECK_TRUE(writer.begin() != reader.begin());
+
+    std::iota(writer.begin(), writer.end(), 0);
+    CHECK_TRUE(reader[999] == 999);
+    auto tail = writer.slice(900, 1000);
+    tail[0] = -1;
+    CHECK_TRUE(reader[900] == -1);
+
+    // the mappings outlive the descriptor
+    memory = SharedMemory::create(16u);
+    CHECK_TRUE(reader[10] == 10);
+}
+
+TEST(SharedMemory, descriptorsPassOverSockets)
+{
+    int sockets[2];
+    CHECK_TRUE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+
+    SharedMemory memory = SharedMemory::create(64 * sizeof(double));
+    Buffer<double> sent = memory.map<double>();
+    sent[5] = 2.5;
+    send_fd(sockets[0], memory.fd());
+
+    SharedMemory received(receive_fd(sockets[1]));
+    CHECK_TRUE(received.fd() != memory.fd());
+    CHECK_TRUE(received.size() == memory.size());
+    Buffer<double> mapped = received.map<double>(8 * sizeof(double), 4u);
+    CHECK_TRUE(mapped.size() == 4u);
+    mapped[0] = -1.0;
+    DOUBLES_EQUAL(-1.0, sent[8], 0.0);
+    DOUBLES_EQUAL(2.5, received.map<const double>()[5], 0.0);
+
+    close(sockets[0]);
+    CHECK_THROWS(std::system_error, receive_fd(sockets[1])); // the other end hung up without sending
+    close(sockets[1]);
+}
+
+TEST(SharedMemory, namedObjects)
+{
+    const std::string name = "/cpp_buffer_tests." + std::to_string(getpid());
+    SharedMemory created = SharedMemory::create(name.c_str(), 4096u);
+    created.map<char>()[100] = 'x';
+    CHECK_THROWS(std::system_error, SharedMemory::create(name.c_str(), 4096u)); // already there
+
+    SharedMemory opened = SharedMemory::open(name.c_str());
+    CHECK_TRUE(opened.size() == 4096u);
+    CHECK_TRUE(opened.map<const char>()[100] == 'x');
+
+    SharedMemory::unlink(name.c_str());
+    CHECK_THROWS(std::system_error, SharedMemory::open(name.c_str()));
+    CHECK_TRUE(opened.map<const char>()[100] == 'x'); // the object lasts while it's open
+}
+
+TEST(SharedMemory, ringWithinAProcess)
+{
+    SharedRing<int> producer(100);
+    CHECK_TRUE(producer.capacity() == 128u && producer.empty());
+    SharedRing<int> consumer(SharedMemory(dup(producer.memory().fd())));
+    CHECK_TRUE(consumer.capacity() == 128u);
+
+    int values[200];
+    std::iota(values, values + 200, 0);
+    CHECK_TRUE(producer.push(values, 200) == 128u);
+    CHECK_FALSE(producer.try_push(-1));
+    CHECK_TRUE(consumer.size() == 128u);
+
+    int out[100];
+    CHECK_TRUE(consumer.pop(out, 100) == 100u && out[99] == 99);
+    CHECK_TRUE(producer.push(values + 128, 72) == 72u); // wraps around
+
+    auto regions = consumer.read_regions();
+    CHECK_TRUE(regions.size() == 100u);
+    CHECK_TRUE(regions.first.size() == 28u && regions.first[0] == 100);
+    CHECK_TRUE(regions.second[71] == 199);
+    consumer.commit_read(regions.size());
+    CHECK_TRUE(producer.empty());
+
+    CHECK_THROWS(std::invalid_argument, SharedRing<double>(SharedMemory(dup(producer.memory().fd()))));
+    CHECK_THROWS(std::invalid_argument, SharedRing<int>(SharedMemory::create(4096u)));
+}
+
+TEST(SharedMemory, corruptPositionsThrow)
+{
+    SharedRing<int> producer(16);
+    SharedRing<int> consumer(SharedMemory(dup(producer.memory().fd())));
+    int values[4] = {1, 2, 3, 4};
+    CHECK_TRUE(producer.push(values, 4) == 4u);
+    CHECK_THROWS(OutOfRangeError, producer.commit_write(13));
+    CHECK_THROWS(OutOfRangeError, consumer.commit_read(5));
+
+    // what a broken peer could leave behind: the head and the tail, on cache lines 1 and 2 of the header
+    Buffer<uint64_t> header = producer.memory().map<uint64_t>(0u, 24u);
+    header[8] = 1000u;
+    CHECK_TRUE(consumer.size() == 16u);
+    int out[4];
+    CHECK_THROWS(std::runtime_error, consumer.read_regions());
+    CHECK_THROWS(std::runtime_error, consumer.pop(out, 4));
+
+    header[8] = 4u;
+    header[16] = 1000u; // a tail past the head
+    CHECK_THROWS(std::runtime_error, producer.write_regions());
+    CHECK_THROWS(std::runtime_error, producer.push(values, 4));
+}
+
+TEST(SharedMemory, ringBetweenProcesses)
+{
+    int sockets[2];
+    CHECK_TRUE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+    const int count = 100000;
+
+    const pid_t child = fork();
+    CHECK_TRUE(child >= 0);
+    if(child == 0) {
+        // the producer, which attaches to the ring it is sent
+        close(sockets[0]);
+        int status = 1;
+        try {
+            SharedRing<int> ring(SharedMemory(receive_fd(sockets[1])));
+            for(int i = 0; i < count;) {
+                auto regions = ring.write_regions(count - i);
+                for(int &value : regions.first)
+                    value = i++;
+                for(int &value : regions.second)
+                    value = i++;
+                ring.commit_write(regions.size());
+            }
+            status = 0;
+        } catch(...) {
+        }
+        _exit(status);
+    }
+
+    close(sockets[1]);
+    SharedRing<int> ring(256);
+    send_fd(sockets[0], ring.memory().fd());
+    close(sockets[0]);
+
+    long long total = 0;
+    int expected = 0;
+    bool inOrder = true;
+    int status = -1;
+    bool exited = false;
+    while(expected < count) {
+        int value;
+        if(!ring.try_pop(value)) {
+            // don't wait forever on a producer that died
+            if(exited && ring.empty())
+                break;
+            exited = exited || waitpid(child, &status, WNOHANG) == child;
+            std::this_thread::yield();
+            continue;
+        }
+        inOrder = inOrder && value == expected;
+        total += value;
+        ++expected;
+    }
+    if(!exited)
+        CHECK_TRUE(waitpid(child, &status, 0) == child);
+    CHECK_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    CHECK_TRUE(inOrder);
+    CHECK_TRUE(total == static_cast<long long>(count) * (count - 1) / 2);
+    CHECK_TRUE(ring.empty());
+}
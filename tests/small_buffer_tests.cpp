@@ -0,0 +1,196 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/buffer_pool.h>
+#include <cpp_buffer/small_buffer.h>
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+
+using namespace CPPBuffer;
+
+namespace {
+
+struct Tracked
+{
+    Tracked() { ++alive; }
+    Tracked(const Tracked &) { ++alive; }
+    Tracked(Tracked &&) { ++alive; }
+    Tracked &operator=(const Tracked &) = default;
+    ~Tracked() { --alive; }
+    static int alive;
+};
+int Tracked::alive = 0;
+
+// the squares of 0 to N-1, computed by the compiler
+template< size_t N >
+constexpr StaticBuffer<int, N> squares() {
+    StaticBuffer<int, N> table;
+    for(size_t i = 0; i < N; ++i)
+        table[static_cast<int>(i)] = static_cast<int>(i * i);
+    return table;
+}
+
+template< typename view_t >
+constexpr int constexpr_sum(const view_t &view) {
+    int total = 0;
+    for(int value : view)
+        total += value;
+    return total;
+}
+
+constexpr StaticBuffer<int, 16> table = squares<16>();
+constexpr StaticBuffer<float, 4> taps = {0.25f, 0.5f, 0.25f};
+
+}
+
+TEST_GROUP(StaticBuffer) {};
+
+TEST(StaticBuffer, inlineElements)
+{
+    StaticBuffer<float, 16> taps = {0.25f, 0.5f, 0.25f};
+    CHECK_TRUE(taps.size() == 3u);
+    CHECK_TRUE(taps.capacity() == 16u);
+    DOUBLES_EQUAL(1.0, std::accumulate(taps.begin(), taps.end(), 0.0f), 1e-6);
+
+    // the elements live inside the object
+    const char *object = reinterpret_cast<const char *>(&taps);
+    const char *first = reinterpret_cast<const char *>(taps.begin());
+    CHECK_TRUE(first >= object && first < object + sizeof(taps));
+
+    StaticBuffer<int, 8> zeros(5);
+    CHECK_TRUE(zeros.size() == 5u);
+    CHECK_TRUE(std::all_of(zeros.begin(), zeros.end(), [](int i) { return i == 0; }));
+}
+
+TEST(StaticBuffer, copiesAreIndependent)
+{
+    StaticBuffer<int, 4> a;
+    std::iota(a.begin(), a.end(), 0);
+    StaticBuffer<int, 4> b = a;
+    b[0] = 10;
+    CHECK_TRUE(a[0] == 0 && b[0] == 10 && b[3] == 3);
+}
+
+TEST(StaticBuffer, slices)
+{
+    StaticBuffer<int, 10> buffer;
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    Slice<int, 2u, int *> odd = buffer.slice<2>(1, 10);
+    CHECK_TRUE(odd.size() == 5u);
+    CHECK_TRUE(odd[0] == 1 && odd[4] == 9);
+    odd[1] = -3;
+    CHECK_TRUE(buffer[3] == -3);
+
+    auto middle = buffer.slice(2, 5);
+    CHECK_TRUE(middle.size() == 3u && middle[0] == 2);
+}
+
+TEST(StaticBuffer, compileTimeTables)
+{
+    static_assert(table.size() == 16u && table[3] == 9, "indexing");
+    static_assert(constexpr_sum(table) == 1240, "iteration");
+    static_assert(constexpr_sum(table.slice<2>(1, 16)) == 680, "strided slices");
+    static_assert(constexpr_sum(table.slice<2>().slice<2>()) == 224, "slices of slices");
+    static_assert(table.slice(4, 8)[0] == 16 && table.slice(4, 8).size() == 4u, "unit slices");
+    static_assert(taps.size() == 3u && taps[1] == 0.5f, "initializer lists");
+
+    // non-owning Buffers and runtime strides work the same way
+    constexpr Buffer<const int, 1u, const int *> view(table.begin(), 4u);
+    static_assert(view[3] == 9 && view.end() - view.begin() == 4, "bare pointer Buffers");
+    static_assert(Buffer<const int, 1u, const int *>(table.begin(), table.size()).slice(0, 16, 5)[3] == 225,
+        "dynamic-stride slices");
+
+    // the same checks at runtime
+    Slice<const int, 2u, const int *> odd = table.slice<2>(1, 16);
+    CHECK_TRUE(odd.size() == 8u && odd[7] == 225);
+    CHECK_THROWS(OutOfRangeError, table[16]);
+    CHECK_THROWS(OutOfRangeError, table.slice(0, 17));
+}
+
+TEST_GROUP(SmallBuffer) {};
+
+TEST(SmallBuffer, staysInline)
+{
+    SmallBuffer<uint8_t, 64> header(40);
+    CHECK_TRUE(header.is_inline());
+    CHECK_TRUE(header.size() == 40u);
+    CHECK_TRUE(std::all_of(header.begin(), header.end(), [](uint8_t b) { return b == 0u; }));
+
+    const char *object = reinterpret_cast<const char *>(&header);
+    const char *first = reinterpret_cast<const char *>(header.begin());
+    CHECK_TRUE(first >= object && first < object + sizeof(header));
+}
+
+TEST(SmallBuffer, spillsToHeap)
+{
+    BufferPool pool;
+    SmallBuffer<int, 4> big(100, pool);
+    CHECK_FALSE(big.is_inline());
+    CHECK_TRUE(big.size() == 100u);
+    CHECK_TRUE(pool.outstanding() == 1u);
+    std::iota(big.begin(), big.end(), 0);
+    CHECK_TRUE(big[99] == 99);
+
+    auto every4th = big.slice<4>();
+    CHECK_TRUE(every4th.size() == 25u && every4th[24] == 96);
+
+    big = SmallBuffer<int, 4>(2);
+    CHECK_TRUE(big.is_inline());
+    CHECK_TRUE(pool.outstanding() == 0u);
+}
+
+TEST(SmallBuffer, constSlices)
+{
+    SmallBuffer<int, 4> small = {1, 2, 3};
+    const SmallBuffer<int, 4> &constSmall = small;
+    Slice<const int, 2u, const int *> ends = constSmall.slice<2>();
+    CHECK_TRUE(ends.size() == 2u && ends[1] == 3);
+    CHECK_TRUE(constSmall.slice(1, 3)[0] == 2);
+    CHECK_THROWS(OutOfRangeError, constSmall.slice(0, 4));
+
+    const SmallBuffer<int, 4> big(10);
+    CHECK_TRUE(big.slice<3>(1, 10).size() == 3u);
+}
+
+TEST(SmallBuffer, copyAndMove)
+{
+    for(size_t n : {3u, 30u}) {
+        SmallBuffer<std::string, 4> a(n);
+        for(size_t i = 0; i < n; ++i)
+            a[int(i)] = std::to_string(i);
+
+        SmallBuffer<std::string, 4> b = a;
+        b[0] = "changed";
+        CHECK_TRUE(a[0] == "0");
+        CHECK_TRUE(b.begin() != a.begin());
+
+        SmallBuffer<std::string, 4> c = std::move(a);
+        CHECK_TRUE(c.size() == n && c[int(n) - 1] == std::to_string(n - 1));
+        CHECK_TRUE(a.size() == 0u);
+
+        a = c;
+        CHECK_TRUE(a.size() == n && a[1] == "1");
+    }
+}
+
+TEST(SmallBuffer, constructsOnlyWhatIsUsed)
+{
+    {
+        SmallBuffer<Tracked, 8> a(3);
+        CHECK_TRUE(Tracked::alive == 3);
+        SmallBuffer<Tracked, 8> b = a;
+        SmallBuffer<Tracked, 8> c(20);
+        CHECK_TRUE(Tracked::alive == 26);
+        b = std::move(c);
+        CHECK_TRUE(Tracked::alive == 23);
+    }
+    CHECK_TRUE(Tracked::alive == 0);
+}
+
+TEST(SmallBuffer, initializerList)
+{
+    SmallBuffer<double, 2> values = {1.0, 2.0, 3.0};
+    CHECK_FALSE(values.is_inline());
+    DOUBLES_EQUAL(6.0, std::accumulate(values.begin(), values.end(), 0.0), 1e-12);
+}
@@ -0,0 +1,121 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/algorithms.h>
+#include <cpp_buffer/buffer_pool.h>
+#include <cpp_buffer/soa_buffer.h>
+
+#include <cstdint>
+#include <new>
+#include <string>
+
+using namespace CPPBuffer;
+
+namespace {
+
+enum { timestamp, x, y, flags };
+typedef SoABuffer<int64_t, float, double, uint8_t> Points;
+
+struct Tracked
+{
+    Tracked() { ++alive; }
+    ~Tracked() { --alive; }
+    static int alive;
+};
+int Tracked::alive = 0;
+
+}
+
+TEST_GROUP(SoABuffer) {};
+
+TEST(SoABuffer, columns)
+{
+    Points points(100);
+    CHECK_TRUE(points.size() == 100u);
+
+    Buffer<float> xs = points.column<x>();
+    Buffer<uint8_t> fs = points.column<flags>();
+    CHECK_TRUE(xs.size() == 100u && fs.size() == 100u);
+    CHECK_TRUE(std::all_of(xs.begin(), xs.end(), [](float f) { return f == 0.0f; }));
+
+    // every column on its own cache line, in one block
+    CHECK_TRUE(xs.alignment() >= 64u);
+    CHECK_TRUE(fs.alignment() >= 64u);
+    CHECK_TRUE(points.column<y>().alignment() >= 64u);
+    CHECK_TRUE(points.column<timestamp>().begin() + 100 <= reinterpret_cast<int64_t *>(xs.begin()));
+
+    fill(xs, 2.0f);
+    DOUBLES_EQUAL(200.0, sum(points.column<x>()), 1e-6);
+}
+
+TEST(SoABuffer, rows)
+{
+    Points points(10);
+    for(size_t i = 0; i < points.size(); ++i)
+        points[i] = std::make_tuple(int64_t(i), float(i) / 2, double(i) * 2, uint8_t(i % 2));
+
+    auto [t, px, py, f] = points[4];
+    CHECK_TRUE(t == 4 && px == 2.0f && py == 8.0 && f == 0u);
+    px = -1.0f;
+    CHECK_TRUE(points.column<x>()[4] == -1.0f);
+
+    std::get<flags>(points[9]) = 7u;
+    CHECK_TRUE(points.column<flags>()[9] == 7u);
+
+    int64_t total = 0;
+    for(auto row : points)
+        total += std::get<timestamp>(row);
+    CHECK_TRUE(total == 45);
+
+    const Points &constPoints = points;
+    CHECK_TRUE(std::get<y>(constPoints[3]) == 6.0);
+    CHECK_TRUE(constPoints.end() - constPoints.begin() == 10);
+    CHECK_THROWS(OutOfRangeError, points[10]);
+}
+
+TEST(SoABuffer, sharedOwnership)
+{
+    Buffer<double> ys;
+    {
+        Points points(5);
+        ys = points.column<y>();
+        ys[2] = 3.5;
+        Points copy = points;
+        CHECK_TRUE(std::get<y>(copy[2]) == 3.5);
+    }
+    CHECK_TRUE(ys[2] == 3.5 && ys.size() == 5u);
+}
+
+TEST(SoABuffer, fromAResource)
+{
+    BufferPool pool;
+    {
+        SoABuffer<float, Tracked, std::string> table(8, pool);
+        CHECK_TRUE(pool.outstanding() == 1u);
+        CHECK_TRUE(Tracked::alive == 8);
+        std::get<2>(table[7]) = "last";
+        CHECK_TRUE(table.column<2>()[7] == "last");
+    }
+    CHECK_TRUE(Tracked::alive == 0);
+    CHECK_TRUE(pool.outstanding() == 0u);
+}
+
+TEST(SoABuffer, tooManyRowsThrow)
+{
+    // every column fits, but not all of them together
+    CHECK_THROWS(std::bad_array_new_length, Points(SIZE_MAX / 16u));
+    CHECK_THROWS(std::bad_array_new_length, Points(SIZE_MAX / 8u + 2u));
+
+    BufferPool pool;
+    // not a constant, or the compiler warns about constructing the rows that Layout is about to refuse
+    const size_t rows = SIZE_MAX / 4u + pool.outstanding();
+    CHECK_THROWS(std::bad_array_new_length, (SoABuffer<float, Tracked>(rows, pool)));
+    CHECK_TRUE(pool.outstanding() == 0u);
+    CHECK_TRUE(Tracked::alive == 0);
+}
+
+TEST(SoABuffer, empty)
+{
+    Points none;
+    CHECK_TRUE(none.size() == 0u && none.begin() == none.end());
+    Points zero(0);
+    CHECK_TRUE(zero.size() == 0u && zero.column<x>().size() == 0u);
+}
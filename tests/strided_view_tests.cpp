@@ -0,0 +1,170 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/algorithms.h>
+#include <cpp_buffer/strided_view.h>
+
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+using namespace CPPBuffer;
+
+namespace {
+
+// a height x width image where pixel (y, x) holds 100 * y + x
+Buffer<int> image(size_t height, size_t width) {
+    Buffer<int> pixels(height * width);
+    for(size_t y = 0; y < height; ++y)
+        for(size_t x = 0; x < width; ++x)
+            pixels[int(y * width + x)] = int(100 * y + x);
+    return pixels;
+}
+
+}
+
+TEST_GROUP(StridedView) {};
+
+TEST(StridedView, denseRowMajor)
+{
+    Buffer<int> pixels = image(4, 6);
+    StridedView<int, 2> view(pixels, {4, 6});
+    CHECK_TRUE(view.size() == 24u);
+    CHECK_TRUE(view.stride(0) == 6u && view.stride(1) == 1u);
+    CHECK_TRUE(view(0, 0) == 0 && view(3, 5) == 305 && view(2, 1) == 201);
+
+    view(1, 2) = -1;
+    CHECK_TRUE(pixels[8] == -1);
+
+    CHECK_THROWS(OutOfRangeError, view(4, 0));
+    CHECK_THROWS(OutOfRangeError, view(0, 6));
+    CHECK_THROWS(OutOfRangeError, (StridedView<int, 2>(pixels, {5, 5})));
+}
+
+TEST(StridedView, rowsAndChannels)
+{
+    // interleaved RGB, 2 x 3 pixels
+    Buffer<int> rgb(2 * 3 * 3);
+    std::iota(rgb.begin(), rgb.end(), 0);
+    StridedView<int, 2, 3> green(rgb, 1, {2, 3}, {9, 3});
+    CHECK_TRUE(green(0, 0) == 1 && green(0, 2) == 7 && green(1, 1) == 13);
+
+    auto row = green[1];
+    CHECK_TRUE(row.size() == 3u);
+    CHECK_TRUE(row[0] == 10 && row[2] == 16);
+
+    Slice<int, 3u> slice = row.as_slice();
+    CHECK_TRUE(slice.size() == 3u && slice[1] == 13);
+    CHECK_TRUE(sum(slice) == 10 + 13 + 16);
+
+    // a channel as a third dimension
+    StridedView<int, 3> channels(rgb, {2, 3, 3});
+    CHECK_TRUE(channels(1, 1, 1) == green(1, 1));
+    CHECK_TRUE(channels[1][2][0] == 15);
+}
+
+TEST(StridedView, constViewsAreReadOnly)
+{
+    Buffer<int> pixels = image(3, 4);
+    const StridedView<int, 2> view(pixels, {3, 4});
+
+    auto row = view[2];
+    static_assert(std::is_same<decltype(row), StridedView<const int, 1>>::value, "a const view hands out const rows");
+    static_assert(std::is_same<decltype(row[0]), const int &>::value, "and const elements");
+    CHECK_TRUE(row.size() == 4u && row[3] == 203);
+    CHECK_THROWS(OutOfRangeError, view[3]);
+
+    // a read-only view over a Buffer that can still be written through
+    StridedView<const int, 3> cube(pixels, {3, 2, 2});
+    pixels[5] = -1;
+    CHECK_TRUE(cube(1, 0, 1) == -1 && cube[2][1][1] == 203);
+    int total = 0;
+    cube.for_each([&total](const int &value) { total += value; });
+    CHECK_TRUE(total == std::accumulate(pixels.begin(), pixels.end(), 0));
+
+    // rows of a const view are Slices of const elements, and a const view visits its elements read-only
+    Slice<const int, 1u, std::shared_ptr<int>> lastRow = view[2].as_slice();
+    CHECK_TRUE(lastRow.size() == 4u && lastRow[0] == 200 && sum(lastRow) == 200 + 201 + 202 + 203);
+    const auto columns = StridedView<int, 2>(pixels, {3, 4}).transposed();
+    Slice<const int, dynamic_stride, std::shared_ptr<int>> column = columns[1].as_slice();
+    CHECK_TRUE(column.size() == 3u && column.stride() == 4u && column[2] == 201);
+    int visited = 0;
+    view.for_each([&visited, &pixels](const int &value) { visited += value == pixels[visited] ? 1 : 0; });
+    CHECK_TRUE(visited == 12);
+}
+
+TEST(StridedView, sharesOwnership)
+{
+    StridedView<int, 2> view;
+    {
+        Buffer<int> pixels = image(2, 2);
+        view = StridedView<int, 2>(pixels, {2, 2});
+    }
+    CHECK_TRUE(view(1, 1) == 101);
+}
+
+TEST(StridedView, sliceAndBlock)
+{
+    Buffer<int> pixels = image(5, 5);
+    StridedView<int, 2> view(pixels, {5, 5});
+
+    auto columns = view.slice(1, 1, 4);
+    CHECK_TRUE(columns.extent(0) == 5u && columns.extent(1) == 3u);
+    CHECK_TRUE(columns(0, 0) == 1 && columns(4, 2) == 403);
+
+    auto block = view.block({2, 1}, {2, 3});
+    CHECK_TRUE(block.size() == 6u);
+    CHECK_TRUE(block(0, 0) == 201 && block(1, 2) == 303);
+    CHECK_THROWS(OutOfRangeError, view.block({4, 0}, {2, 1}));
+}
+
+TEST(StridedView, transposed)
+{
+    Buffer<int> pixels = image(2, 3);
+    StridedView<int, 2> view(pixels, {2, 3});
+    StridedView<int, 2, dynamic_stride> t = view.transposed();
+    CHECK_TRUE(t.extent(0) == 3u && t.extent(1) == 2u);
+    CHECK_TRUE(t.stride(0) == 1u && t.stride(1) == 3u);
+    for(size_t y = 0; y < 2; ++y)
+        for(size_t x = 0; x < 3; ++x)
+            CHECK_TRUE(t(x, y) == view(y, x));
+
+    auto column = t[2];
+    CHECK_TRUE(column[0] == 2 && column[1] == 102);
+
+    StridedView<int, 3> cube(Buffer<int>(24), {2, 3, 4});
+    auto permuted = cube.permuted({2, 0, 1});
+    CHECK_TRUE(permuted.extent(0) == 4u && permuted.extent(1) == 2u && permuted.extent(2) == 3u);
+    permuted(3, 1, 2) = 7;
+    CHECK_TRUE(cube(1, 2, 3) == 7);
+}
+
+TEST(StridedView, tiled)
+{
+    Buffer<int> pixels = image(6, 8);
+    StridedView<int, 2> view(pixels, {6, 8});
+    auto tiles = view.tiled({3, 4});
+    CHECK_TRUE(tiles.extent(0) == 2u && tiles.extent(1) == 2u && tiles.extent(2) == 3u && tiles.extent(3) == 4u);
+    CHECK_TRUE(tiles(1, 1, 2, 3) == view(5, 7));
+    CHECK_TRUE(tiles(0, 1, 1, 0) == view(1, 4));
+
+    auto tile = tiles[1][0];
+    CHECK_TRUE(tile.extent(0) == 3u && tile(0, 0) == 300);
+
+    // only whole tiles
+    auto partial = view.tiled({4, 3});
+    CHECK_TRUE(partial.extent(0) == 1u && partial.extent(1) == 2u);
+}
+
+TEST(StridedView, forEachVisitsInOrder)
+{
+    Buffer<int> pixels = image(3, 4);
+    StridedView<int, 2> view(pixels, {3, 4});
+
+    std::vector<int> visited;
+    view.transposed().for_each([&](int value) { visited.push_back(value); });
+    CHECK_TRUE(visited.size() == 12u);
+    CHECK_TRUE(visited[0] == 0 && visited[1] == 100 && visited[2] == 200 && visited[3] == 1);
+
+    view.block({1, 1}, {2, 2}).for_each([](int &value) { value = 0; });
+    CHECK_TRUE(std::accumulate(pixels.begin(), pixels.end(), 0) == 1 + 2 + 3 + 100 + 103 + 200 + 203);
+}
@@ -0,0 +1,74 @@
+#include <CppUTest/TestHarness.h>
+#include <cpp_buffer/tiling.h>
+
+#include <numeric>
+
+using namespace CPPBuffer;
+
+TEST_GROUP(Tiling) {};
+
+TEST(Tiling, coversTheBuffer)
+{
+    Buffer<int> buffer(10);
+    std::iota(buffer.begin(), buffer.end(), 0);
+
+    auto t = tiles(buffer, 4);
+    CHECK_TRUE(t.size() == 3u);
+    CHECK_TRUE(t.tile_size() == 4u);
+    CHECK_TRUE(t[0].size() == 4u && t[1].size() == 4u && t[2].size() == 2u);
+    CHECK_TRUE(t[1][0] == 4 && t[2][1] == 9);
+
+    size_t count = 0u, total = 0u;
+    for(auto tile : t) {
+        ++count;
+        total += tile.size();
+        for(int &value : tile)
+            value *= 2;
+    }
+    CHECK_TRUE(count == 3u && total == 10u);
+    CHECK_TRUE(buffer[9] == 18);
+}
+
+TEST(Tiling, stridedSlices)
+{
+    Buffer<int> buffer(20);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    auto odd = buffer.slice<2>(1, 20);
+
+    auto t = tiles(odd, 3);
+    CHECK_TRUE(t.size() == 4u);
+    Slice<int, 2u> last = t[3];
+    CHECK_TRUE(last.size() == 1u && last[0] == 19);
+    CHECK_TRUE(t[1][0] == 7);
+}
+
+TEST(Tiling, emptyView)
+{
+    Buffer<int> buffer;
+    auto t = tiles(buffer, 16);
+    CHECK_TRUE(t.size() == 0u);
+    CHECK_TRUE(t.begin() == t.end());
+}
+
+TEST(Tiling, cacheSized)
+{
+    const CacheSizes &sizes = cache_sizes();
+    CHECK_TRUE(sizes.l1 > 0u && sizes.l1 <= sizes.l2 && sizes.l2 <= sizes.l3);
+    CHECK_TRUE(sizes.line > 0u);
+
+    const size_t floats = cache_tile_size(sizeof(float), 1u, CacheLevel::l2);
+    CHECK_TRUE(floats * sizeof(float) <= sizes.l2 / 2u);
+    CHECK_TRUE(floats % (sizes.line / sizeof(float)) == 0u);
+    // strided and shared tiles get proportionally fewer elements
+    CHECK_TRUE(cache_tile_size(sizeof(float), 2u, CacheLevel::l2) <= floats / 2u);
+    CHECK_TRUE(cache_tile_size(sizeof(float), 1u, CacheLevel::l2, 3u) <= floats / 3u);
+
+    Buffer<float> big(3 * floats + 5);
+    auto t = cache_tiles(big, CacheLevel::l2);
+    CHECK_TRUE(t.tile_size() == floats);
+    CHECK_TRUE(t.size() == 4u);
+    CHECK_TRUE(t[3].size() == 5u);
+
+    auto strided = cache_tiles(big.slice<4>(), CacheLevel::l1);
+    CHECK_TRUE(strided.tile_size() == cache_tile_size(sizeof(float), 4u, CacheLevel::l1));
+}